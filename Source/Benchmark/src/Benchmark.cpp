@@ -0,0 +1,138 @@
+#include "Benchmark.h"
+
+#include "util/Array.h"
+
+#include <atomic>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+
+/* Counts allocations made with new, such as component storages */
+static std::atomic<Quartz::USize> sNewCount(0);
+
+void* operator new(std::size_t size)
+{
+	sNewCount.fetch_add(1, std::memory_order_relaxed);
+
+	if (void* pMemory = malloc(size > 0 ? size : 1))
+	{
+		return pMemory;
+	}
+
+	throw std::bad_alloc();
+}
+
+void operator delete(void* pMemory) noexcept
+{
+	free(pMemory);
+}
+
+void operator delete(void* pMemory, std::size_t) noexcept
+{
+	free(pMemory);
+}
+
+namespace Quartz
+{
+	volatile UInt64 gBenchmarkSink = 0;
+
+	struct BenchmarkRecord
+	{
+		const char*	suite;
+		const char*	name;
+		const char*	variant;
+		USize		count;
+		Double64	nsPerOp;
+		USize		allocations;
+	};
+
+	static Array<BenchmarkRecord> sRecords;
+
+	USize BenchmarkAllocations()
+	{
+		return gHeapAllocationCount.load(std::memory_order_relaxed) + sNewCount.load(std::memory_order_relaxed);
+	}
+
+	void ReportBenchmark(const char* suite, const char* name, const char* variant,
+		USize count, Double64 nsPerOp, USize allocations)
+	{
+		sRecords.PushBack({ suite, name, variant, count, nsPerOp, allocations });
+	}
+
+	static Bool8 WriteBenchmarkJson(const char* path)
+	{
+		FILE* pFile = fopen(path, "w");
+
+		if (pFile == nullptr)
+		{
+			return false;
+		}
+
+		fprintf(pFile, "{\n  \"benchmarks\": [\n");
+
+		for (USize i = 0; i < sRecords.Size(); i++)
+		{
+			const BenchmarkRecord& record = sRecords[i];
+
+			fprintf(pFile, "    { \"suite\": \"%s\", \"name\": \"%s\", \"variant\": \"%s\", \"count\": %llu, "
+				"\"ns_per_op\": %.3f, \"allocations\": %llu }%s\n",
+				record.suite, record.name, record.variant, (unsigned long long)record.count,
+				record.nsPerOp, (unsigned long long)record.allocations, i + 1 < sRecords.Size() ? "," : "");
+		}
+
+		fprintf(pFile, "  ]\n}\n");
+		fclose(pFile);
+
+		return true;
+	}
+}
+
+/*
+	Usage: Benchmark [--json <file>] [--max <count>] [--suite table|entity]
+*/
+int main(int argc, char* argv[])
+{
+	using namespace Quartz;
+
+	const char* pJsonPath = nullptr;
+	const char* pSuite = nullptr;
+	USize maxCount = 10000000;
+
+	for (int i = 1; i + 1 < argc; i += 2)
+	{
+		if (strcmp(argv[i], "--json") == 0)
+		{
+			pJsonPath = argv[i + 1];
+		}
+		else if (strcmp(argv[i], "--max") == 0)
+		{
+			maxCount = static_cast<USize>(strtoull(argv[i + 1], nullptr, 10));
+		}
+		else if (strcmp(argv[i], "--suite") == 0)
+		{
+			pSuite = argv[i + 1];
+		}
+	}
+
+	printf("-------------------------------------------------------\n");
+	printf("|                QUARTZ ENGINE BENCHMARKS             |\n");
+	printf("-------------------------------------------------------\n\n");
+
+	if (pSuite == nullptr || strcmp(pSuite, "table") == 0)
+	{
+		RunTableBenchmarks(maxCount);
+	}
+
+	if (pSuite == nullptr || strcmp(pSuite, "entity") == 0)
+	{
+		RunEntityBenchmarks(maxCount);
+	}
+
+	if (pJsonPath != nullptr && !WriteBenchmarkJson(pJsonPath))
+	{
+		printf("Failed to write %s\n", pJsonPath);
+		return 1;
+	}
+
+	return 0;
+}
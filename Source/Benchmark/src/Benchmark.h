@@ -0,0 +1,53 @@
+#pragma once
+
+#include "Common.h"
+
+#include <chrono>
+#include <cstdio>
+
+namespace Quartz
+{
+	class BenchmarkTimer
+	{
+	private:
+		std::chrono::high_resolution_clock::time_point mStart;
+
+	public:
+		BenchmarkTimer()
+			: mStart(std::chrono::high_resolution_clock::now()) { }
+
+		void Reset()
+		{
+			mStart = std::chrono::high_resolution_clock::now();
+		}
+
+		Double64 ElapsedNanoseconds() const
+		{
+			return static_cast<Double64>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+				std::chrono::high_resolution_clock::now() - mStart).count());
+		}
+	};
+
+	/* SplitMix64, deterministic key generation for all benchmarks */
+	FORCE_INLINE UInt64 BenchmarkRandom(UInt64& state)
+	{
+		UInt64 z = (state += 0x9E3779B97F4A7C15ull);
+		z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+		z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+		return z ^ (z >> 31);
+	}
+
+	/* Keeps the optimizer from discarding benchmark results */
+	extern volatile UInt64 gBenchmarkSink;
+
+	/* Heap allocations so far, through Core allocators and operator new */
+	USize BenchmarkAllocations();
+
+	/* Records a result for the JSON report, name and variant must be string literals */
+	void ReportBenchmark(const char* suite, const char* name, const char* variant,
+		USize count, Double64 nsPerOp, USize allocations);
+
+	/* Runs every benchmark with at most maxCount entries or entities */
+	void RunTableBenchmarks(USize maxCount);
+	void RunEntityBenchmarks(USize maxCount);
+}
@@ -0,0 +1,306 @@
+#include "Benchmark.h"
+
+#include "util/Array.h"
+#include "util/Storage.h"
+#include "entity/World.h"
+
+namespace Quartz
+{
+	/* The benchmarks do not run jobs, the job system only sizes command buffers */
+	static JobSystem sJobSystem;
+
+	JobSystem& GetJobSystem()
+	{
+		return sJobSystem;
+	}
+
+	struct BenchPosition { Float32 x, y, z; };
+	struct BenchVelocity { Float32 x, y, z; };
+	struct BenchRotation { Float32 x, y, z, w; };
+	struct BenchScale { Float32 x, y, z; };
+	struct BenchMarker { UInt32 x; };
+
+	/* Iteration passes over count entities add up to at least this many visits */
+	constexpr USize ITERATION_VISITS = 10000000;
+	constexpr USize VIEW_ITERATIONS = 100000;
+
+	static const char* GetModeName(EntityStorageMode mode)
+	{
+		return mode == ENTITY_STORAGE_SPARSE ? "sparse" : "archetype";
+	}
+
+	/* Times func, printing and reporting ns per op and the allocations it made */
+	template<typename Func>
+	void MeasureEntity(const char* name, const char* variant, USize count, USize ops, Func&& func)
+	{
+		const USize allocations = BenchmarkAllocations();
+		BenchmarkTimer timer;
+
+		func();
+
+		const Double64 nsPerOp = timer.ElapsedNanoseconds() / ops;
+		const USize madeAllocations = BenchmarkAllocations() - allocations;
+
+		printf("%-18s %-10s %10llu %12.2f %12llu\n", name, variant, (unsigned long long)count,
+			nsPerOp, (unsigned long long)madeAllocations);
+
+		ReportBenchmark("entity", name, variant, count, nsPerOp, madeAllocations);
+	}
+
+	/* Random permutation of the entities, defeats the prefetcher for lookups */
+	static Array<Entity> ShuffleEntities(const Array<Entity>& entities, UInt64 seed)
+	{
+		Array<Entity> shuffled(entities);
+
+		for (USize i = shuffled.Size(); i > 1; i--)
+		{
+			Swap(shuffled[i - 1], shuffled[BenchmarkRandom(seed) % i]);
+		}
+
+		return shuffled;
+	}
+
+	template<typename... Component>
+	void BenchmarkIteration(EntityWorld& world, const char* name, USize count)
+	{
+		const USize passes = count < ITERATION_VISITS ? ITERATION_VISITS / count : 1;
+
+		MeasureEntity(name, GetModeName(world.GetStorageMode()), count, count * passes, [&]()
+		{
+			UInt64 sink = 0;
+
+			for (USize pass = 0; pass < passes; pass++)
+			{
+				world.CreateView<Component...>().ForEach([&sink](Entity entity, Component&... components)
+				{
+					((components.x += 1.0f), ...);
+					sink += entity.index;
+				});
+			}
+
+			gBenchmarkSink += sink;
+		});
+	}
+
+	static void BenchmarkLifetime(EntityStorageMode mode, USize count)
+	{
+		const char* variant = GetModeName(mode);
+		Array<Entity> entities;
+		entities.Reserve(count);
+
+		{
+			EntityWorld world(mode);
+
+			MeasureEntity("create", variant, count, count, [&]()
+			{
+				for (USize i = 0; i < count; i++)
+				{
+					entities.PushBack(world.CreateEntity(BenchPosition{}, BenchVelocity{}));
+				}
+			});
+
+			MeasureEntity("destroy", variant, count, count, [&]()
+			{
+				for (Entity entity : entities)
+				{
+					world.DestroyEntity(entity);
+				}
+			});
+		}
+
+		{
+			EntityWorld world(mode);
+
+			MeasureEntity("create_batch", variant, count, count, [&]()
+			{
+				Array<Entity> created = world.CreateEntities(count, BenchPosition{}, BenchVelocity{});
+				gBenchmarkSink += created.Size();
+			});
+		}
+	}
+
+	static void BenchmarkAccess(EntityStorageMode mode, USize count)
+	{
+		const char* variant = GetModeName(mode);
+
+		EntityWorld world(mode);
+		Array<Entity> entities = world.CreateEntities(count, BenchPosition{}, BenchVelocity{}, BenchRotation{}, BenchScale{});
+
+		BenchmarkIteration<BenchPosition>(world, "iterate_1", count);
+		BenchmarkIteration<BenchPosition, BenchVelocity>(world, "iterate_2", count);
+		BenchmarkIteration<BenchPosition, BenchVelocity, BenchRotation>(world, "iterate_3", count);
+		BenchmarkIteration<BenchPosition, BenchVelocity, BenchRotation, BenchScale>(world, "iterate_4", count);
+
+		const USize passes = count < ITERATION_VISITS ? ITERATION_VISITS / count : 1;
+		EntityQuery<BenchPosition, BenchVelocity>& query = world.Query<BenchPosition, BenchVelocity>();
+
+		MeasureEntity("iterate_query_2", variant, count, count * passes, [&]()
+		{
+			for (USize pass = 0; pass < passes; pass++)
+			{
+				query.ForEach([](Entity, BenchPosition& position, BenchVelocity& velocity)
+				{
+					position.x += velocity.x;
+				});
+			}
+		});
+
+		const Array<Entity> shuffled = ShuffleEntities(entities, count);
+
+		MeasureEntity("get_random", variant, count, count, [&]()
+		{
+			Float32 sum = 0.0f;
+
+			for (Entity entity : shuffled)
+			{
+				sum += world.GetComponent<BenchPosition>(entity).x;
+			}
+
+			gBenchmarkSink += static_cast<UInt64>(sum);
+		});
+
+		MeasureEntity("add_remove", variant, count, count * 2, [&]()
+		{
+			for (Entity entity : entities)
+			{
+				world.AddComponent(entity, BenchMarker{ entity.index });
+			}
+
+			for (Entity entity : entities)
+			{
+				world.RemoveComponent<BenchMarker>(entity);
+			}
+		});
+
+		MeasureEntity("view_create", variant, count, VIEW_ITERATIONS, [&]()
+		{
+			USize spans = 0;
+
+			for (USize i = 0; i < VIEW_ITERATIONS; i++)
+			{
+				spans += world.CreateView<BenchPosition, BenchVelocity, BenchRotation>().GetSpans().Size();
+			}
+
+			gBenchmarkSink += spans;
+		});
+
+		if (mode == ENTITY_STORAGE_SPARSE)
+		{
+			// Last, the group reorders the storages it owns
+			EntityGroup<BenchPosition, BenchVelocity>& group = world.Group<BenchPosition, BenchVelocity>();
+
+			MeasureEntity("iterate_group_2", variant, count, count * passes, [&]()
+			{
+				for (USize pass = 0; pass < passes; pass++)
+				{
+					group.ForEach([](Entity, BenchPosition& position, BenchVelocity& velocity)
+					{
+						position.x += velocity.x;
+					});
+				}
+			});
+		}
+	}
+
+	/* SparseSet and Storage on their own, with shuffled handles */
+	static void BenchmarkContainers(USize count)
+	{
+		Array<UInt32> handles;
+		handles.Reserve(count);
+
+		for (USize i = 0; i < count; i++)
+		{
+			handles.PushBack(static_cast<UInt32>(i));
+		}
+
+		UInt64 seed = count;
+
+		for (USize i = handles.Size(); i > 1; i--)
+		{
+			Swap(handles[i - 1], handles[BenchmarkRandom(seed) % i]);
+		}
+
+		{
+			SparseSet<UInt32, UInt32> set;
+
+			MeasureEntity("sparse_insert", "raw", count, count, [&]()
+			{
+				for (UInt32 handle : handles)
+				{
+					set.Insert(handle);
+				}
+			});
+
+			MeasureEntity("sparse_contains", "raw", count, count, [&]()
+			{
+				USize found = 0;
+
+				for (UInt32 handle : handles)
+				{
+					found += set.Contains(handle);
+				}
+
+				gBenchmarkSink += found;
+			});
+
+			MeasureEntity("sparse_remove", "raw", count, count, [&]()
+			{
+				for (UInt32 handle : handles)
+				{
+					set.Remove(handle);
+				}
+			});
+		}
+
+		{
+			Storage<BenchPosition> storage;
+
+			MeasureEntity("storage_insert", "raw", count, count, [&]()
+			{
+				for (UInt32 handle : handles)
+				{
+					storage.Insert(handle, BenchPosition{ static_cast<Float32>(handle), 0.0f, 0.0f });
+				}
+			});
+
+			MeasureEntity("storage_get", "raw", count, count, [&]()
+			{
+				Float32 sum = 0.0f;
+
+				for (UInt32 handle : handles)
+				{
+					sum += storage.Get(handle).x;
+				}
+
+				gBenchmarkSink += static_cast<UInt64>(sum);
+			});
+		}
+	}
+
+	void RunEntityBenchmarks(USize maxCount)
+	{
+		const USize counts[] = { 10000, 100000, 1000000, 10000000 };
+		const EntityStorageMode modes[] = { ENTITY_STORAGE_SPARSE, ENTITY_STORAGE_ARCHETYPE };
+
+		printf("Entity benchmark (ns/op, allocations per run)\n");
+		printf("%-18s %-10s %10s %12s %12s\n", "Benchmark", "Storage", "Entities", "ns/op", "Allocs");
+
+		for (USize count : counts)
+		{
+			if (count > maxCount)
+			{
+				break;
+			}
+
+			for (EntityStorageMode mode : modes)
+			{
+				BenchmarkLifetime(mode, count);
+				BenchmarkAccess(mode, count);
+			}
+
+			BenchmarkContainers(count);
+		}
+
+		printf("\n");
+	}
+}
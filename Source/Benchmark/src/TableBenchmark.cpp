@@ -0,0 +1,127 @@
+#include "Benchmark.h"
+
+#include "util/Array.h"
+#include "util/Map.h"
+#include "LegacyTable.h"
+
+namespace Quartz
+{
+	using BenchPair = MapPair<UInt64, UInt64>;
+
+	struct TableBenchmarkResult
+	{
+		Double64 insertNs;
+		Double64 lookupHitNs;
+		Double64 lookupMissNs;
+		Double64 eraseNs;
+		USize insertAllocations;
+	};
+
+	template<typename TableType>
+	TableBenchmarkResult BenchmarkTable(const Array<UInt64>& keys, const Array<UInt64>& missingKeys)
+	{
+		TableBenchmarkResult result = {};
+		const USize count = keys.Size();
+
+		TableType table;
+		BenchmarkTimer timer;
+		UInt64 sink = 0;
+
+		/* Insert */
+
+		const USize allocations = BenchmarkAllocations();
+		timer.Reset();
+
+		for (USize i = 0; i < count; i++)
+		{
+			table.Insert(Hash<UInt64>(keys[i]), BenchPair(keys[i], i));
+		}
+
+		result.insertNs = timer.ElapsedNanoseconds() / count;
+		result.insertAllocations = BenchmarkAllocations() - allocations;
+
+		/* Lookup (hit) */
+
+		timer.Reset();
+
+		for (USize i = 0; i < count; i++)
+		{
+			BenchPair* pPair = table.Find(Hash<UInt64>(keys[i]), BenchPair(keys[i]));
+			sink += pPair->value;
+		}
+
+		result.lookupHitNs = timer.ElapsedNanoseconds() / count;
+
+		/* Lookup (miss) */
+
+		timer.Reset();
+
+		for (USize i = 0; i < count; i++)
+		{
+			sink += table.Find(Hash<UInt64>(missingKeys[i]), BenchPair(missingKeys[i])) != nullptr;
+		}
+
+		result.lookupMissNs = timer.ElapsedNanoseconds() / count;
+
+		/* Erase */
+
+		timer.Reset();
+
+		for (USize i = 0; i < count; i++)
+		{
+			table.Remove(Hash<UInt64>(keys[i]), BenchPair(keys[i]));
+		}
+
+		result.eraseNs = timer.ElapsedNanoseconds() / count;
+
+		gBenchmarkSink += sink;
+
+		return result;
+	}
+
+	void PrintTableResult(const char* name, USize count, const TableBenchmarkResult& result)
+	{
+		printf("%-8s %10llu %12.2f %12.2f %12.2f %12.2f\n", name, (unsigned long long)count,
+			result.insertNs, result.lookupHitNs, result.lookupMissNs, result.eraseNs);
+
+		ReportBenchmark("table", "insert", name, count, result.insertNs, result.insertAllocations);
+		ReportBenchmark("table", "lookup_hit", name, count, result.lookupHitNs, 0);
+		ReportBenchmark("table", "lookup_miss", name, count, result.lookupMissNs, 0);
+		ReportBenchmark("table", "erase", name, count, result.eraseNs, 0);
+	}
+
+	void RunTableBenchmarks(USize maxCount)
+	{
+		const USize counts[] = { 1000, 10000, 100000, 1000000, 10000000 };
+
+		printf("Table benchmark (ns/op, UInt64 -> UInt64)\n");
+		printf("%-8s %10s %12s %12s %12s %12s\n", "Table", "Entries", "Insert", "Hit", "Miss", "Erase");
+
+		for (USize count : counts)
+		{
+			if (count > maxCount)
+			{
+				break;
+			}
+
+			Array<UInt64> keys;
+			Array<UInt64> missingKeys;
+			keys.Reserve(count);
+			missingKeys.Reserve(count);
+
+			UInt64 state = count;
+
+			for (USize i = 0; i < count; i++)
+			{
+				// Low bit splits the key space so hits and misses never collide
+				keys.PushBack(BenchmarkRandom(state) | 1);
+				missingKeys.PushBack(BenchmarkRandom(state) & ~1ull);
+			}
+
+			PrintTableResult("Legacy", count, BenchmarkTable<Legacy::Table<BenchPair>>(keys, missingKeys));
+			PrintTableResult("Group", count, BenchmarkTable<Table<BenchPair>>(keys, missingKeys));
+		}
+
+		printf("\n");
+	}
+}
@@ -1,5 +1,7 @@
 #pragma once
 
+#ifdef _MSC_VER
+
 #define INLINE _inline
 
 #ifdef QUARTZ_DEBUG
@@ -8,18 +10,38 @@
 #define FORCE_INLINE __forceinline
 #endif // QUARTZ_DEBUG
 
-#ifndef NULL
-#define NULL 0x0
-#endif // !NULL
-
 #ifdef QUARTZ_API_EXPORT
 #define QUARTZ_API _declspec(dllexport)
 #else
 #define QUARTZ_API _declspec(dllimport)
 #endif
 
+#else
+
+// GCC and Clang, only used for headless tools such as the benchmarks
+#define INLINE inline
+
+#ifdef QUARTZ_DEBUG
+#define FORCE_INLINE INLINE
+#else
+#define FORCE_INLINE inline __attribute__((always_inline))
+#endif // QUARTZ_DEBUG
+
+#define QUARTZ_API __attribute__((visibility("default")))
+
+#if !defined(QUARTZ_64) && defined(__LP64__)
+#define QUARTZ_64
+#endif
+
+#endif // _MSC_VER
+
+#ifndef NULL
+#define NULL 0x0
+#endif // !NULL
+
 namespace Quartz
 {
+#ifdef _MSC_VER
 	typedef __int64 Int64;
 	typedef __int32 Int32;
 	typedef __int16 Int16;
@@ -29,11 +51,22 @@ namespace Quartz
 	typedef unsigned __int32 UInt32;
 	typedef unsigned __int16 UInt16;
 	typedef unsigned __int8  UInt8;
+#else
+	typedef long long	Int64;
+	typedef int			Int32;
+	typedef short		Int16;
+	typedef signed char	Int8;
+
+	typedef unsigned long long	UInt64;
+	typedef unsigned int		UInt32;
+	typedef unsigned short		UInt16;
+	typedef unsigned char		UInt8;
+#endif // _MSC_VER
 
 #ifdef QUARTZ_64
-	typedef unsigned __int64 USize;
+	typedef UInt64 USize;
 #else
-	typedef unsigned __int32 USize;
+	typedef UInt32 USize;
 #endif // QUARTZ_64
 
 	typedef bool   Bool8;	// <- Would really like this to be Bool (but Win32API is dumb)
@@ -60,6 +60,9 @@ struct Matrix4
 	/** Set to a scale matrix */
 	FORCEINLINE Matrix4& SetScale(const Vector3& scale);
 
+	/** Set to translation * rotation * scale, without the full matrix multiplies */
+	FORCEINLINE Matrix4& SetTransform(const Vector3& translation, const Quaternion& rotation, const Vector3& scale);
+
 	/** Set to a view matrix */
 	FORCEINLINE Matrix4& SetView(const Vector3& right, const Vector3& up, const Vector3& forward, const Vector3& position);
 
@@ -98,6 +98,26 @@ FORCEINLINE Matrix4& Matrix4::SetScale(const Vector3& scale)
 	return *this;
 }
 
+FORCEINLINE Matrix4& Matrix4::SetTransform(const Vector3& translation, const Quaternion& rotation, const Vector3& scale)
+{
+	SetRotation(rotation);
+
+	// Translation row is carried through the rotation like a row vector
+	float tx = translation.x * m00 + translation.y * m10 + translation.z * m20;
+	float ty = translation.x * m01 + translation.y * m11 + translation.z * m21;
+	float tz = translation.x * m02 + translation.y * m12 + translation.z * m22;
+
+	m00 *= scale.x;	m01 *= scale.y;	m02 *= scale.z;
+	m10 *= scale.x;	m11 *= scale.y;	m12 *= scale.z;
+	m20 *= scale.x;	m21 *= scale.y;	m22 *= scale.z;
+
+	m30 = tx * scale.x;
+	m31 = ty * scale.y;
+	m32 = tz * scale.z;
+
+	return *this;
+}
+
 FORCEINLINE Matrix4& Matrix4::SetView(const Vector3& right, const Vector3& up, const Vector3& forward, const Vector3& position)
 {
 	m00 = right.x;		m01 = right.y;		m02 = right.z;		m03 = 0.0f;
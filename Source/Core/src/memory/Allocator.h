@@ -0,0 +1,329 @@
+#pragma once
+
+#include "../Common.h"
+#include "../debug/Debug.h"
+
+#include <cstdlib>
+#include <cstring>
+#include <cstddef>
+#include <atomic>
+#include <type_traits>
+
+#if _MSC_VER
+#include <malloc.h>
+#endif
+
+namespace Quartz
+{
+	constexpr USize DEFAULT_ALIGNMENT = alignof(std::max_align_t);
+
+#ifdef QUARTZ_COUNT_ALLOCATIONS
+	/* Heap allocations made by HeapAllocator and AlignedAllocate, for benchmarks */
+	inline std::atomic<USize> gHeapAllocationCount(0);
+
+#define QUARTZ_COUNT_ALLOCATION() gHeapAllocationCount.fetch_add(1, std::memory_order_relaxed)
+#else
+#define QUARTZ_COUNT_ALLOCATION()
+#endif // QUARTZ_COUNT_ALLOCATIONS
+
+	/*
+		Containers take an allocator as a template parameter. An allocator
+		type provides:
+
+			void* Allocate(USize size, USize align);
+			void* Reallocate(void* pMemory, USize oldSize, USize newSize, USize align);
+			void Free(void* pMemory, USize size);
+
+		Reallocate is only used for trivially relocatable values and may move
+		the memory. Sizes are always passed back to Free so fixed-size and
+		tracking allocators do not need headers.
+	*/
+
+	/* The default allocator, forwards to malloc/realloc/free */
+	struct HeapAllocator
+	{
+		FORCE_INLINE void* Allocate(USize size, USize align = DEFAULT_ALIGNMENT)
+		{
+			DEBUG_ASSERT(align <= DEFAULT_ALIGNMENT && "HeapAllocator does not support over-aligned allocations!");
+			(void)align;
+			QUARTZ_COUNT_ALLOCATION();
+			return malloc(size);
+		}
+
+		FORCE_INLINE void* Reallocate(void* pMemory, USize /*oldSize*/, USize newSize, USize align = DEFAULT_ALIGNMENT)
+		{
+			DEBUG_ASSERT(align <= DEFAULT_ALIGNMENT && "HeapAllocator does not support over-aligned allocations!");
+			(void)align;
+			QUARTZ_COUNT_ALLOCATION();
+			return realloc(pMemory, newSize);
+		}
+
+		FORCE_INLINE void Free(void* pMemory, USize /*size*/)
+		{
+			free(pMemory);
+		}
+	};
+
+	/*
+		Allocates memory aligned to a power of two beyond DEFAULT_ALIGNMENT,
+		size must be a multiple of align. Release with AlignedFree.
+	*/
+	inline void* AlignedAllocate(USize size, USize align)
+	{
+		QUARTZ_COUNT_ALLOCATION();
+
+#if _MSC_VER
+		return _aligned_malloc(size, align);
+#else
+		return aligned_alloc(align, size);
+#endif
+	}
+
+	inline void AlignedFree(void* pMemory)
+	{
+#if _MSC_VER
+		_aligned_free(pMemory);
+#else
+		free(pMemory);
+#endif
+	}
+
+	/* Container allocator for over-aligned types, eg. alignas(64) per-thread data */
+	struct AlignedHeapAllocator
+	{
+		FORCE_INLINE static USize AlignedSize(USize size, USize align)
+		{
+			return (size + align - 1) & ~(align - 1);
+		}
+
+		FORCE_INLINE void* Allocate(USize size, USize align = DEFAULT_ALIGNMENT)
+		{
+			align = align > DEFAULT_ALIGNMENT ? align : DEFAULT_ALIGNMENT;
+			return AlignedAllocate(AlignedSize(size, align), align);
+		}
+
+		void* Reallocate(void* pMemory, USize oldSize, USize newSize, USize align = DEFAULT_ALIGNMENT)
+		{
+			void* pNewMemory = Allocate(newSize, align);
+
+			if (pMemory != nullptr)
+			{
+				memcpy(pNewMemory, pMemory, oldSize < newSize ? oldSize : newSize);
+				AlignedFree(pMemory);
+			}
+
+			return pNewMemory;
+		}
+
+		FORCE_INLINE void Free(void* pMemory, USize /*size*/)
+		{
+			AlignedFree(pMemory);
+		}
+	};
+
+	/* Runtime allocator interface, see PolymorphicAllocator */
+	class AllocatorBase
+	{
+	public:
+		virtual ~AllocatorBase() = default;
+
+		virtual void* Allocate(USize size, USize align) = 0;
+		virtual void Free(void* pMemory, USize size) = 0;
+
+		virtual void* Reallocate(void* pMemory, USize oldSize, USize newSize, USize align)
+		{
+			void* pNewMemory = Allocate(newSize, align);
+
+			if (pMemory != nullptr)
+			{
+				memcpy(pNewMemory, pMemory, oldSize < newSize ? oldSize : newSize);
+				Free(pMemory, oldSize);
+			}
+
+			return pNewMemory;
+		}
+	};
+
+	/* Exposes a template allocator through AllocatorBase */
+	template<typename AllocatorType>
+	class AllocatorAdapter : public AllocatorBase
+	{
+	private:
+		AllocatorType mAllocator;
+
+	public:
+		AllocatorAdapter() = default;
+
+		AllocatorAdapter(const AllocatorType& allocator)
+			: mAllocator(allocator) { }
+
+		void* Allocate(USize size, USize align) override
+		{
+			return mAllocator.Allocate(size, align);
+		}
+
+		void* Reallocate(void* pMemory, USize oldSize, USize newSize, USize align) override
+		{
+			return mAllocator.Reallocate(pMemory, oldSize, newSize, align);
+		}
+
+		void Free(void* pMemory, USize size) override
+		{
+			mAllocator.Free(pMemory, size);
+		}
+
+		AllocatorType& GetAllocator()
+		{
+			return mAllocator;
+		}
+	};
+
+	/* The process-wide heap as an AllocatorBase */
+	inline AllocatorBase* GetHeapAllocator()
+	{
+		static AllocatorAdapter<HeapAllocator> heapAllocator;
+		return &heapAllocator;
+	}
+
+	/*
+		Template allocator that forwards to an AllocatorBase chosen at
+		runtime, so one container type can be backed by any allocator.
+	*/
+	class PolymorphicAllocator
+	{
+	private:
+		AllocatorBase* mpAllocator;
+
+	public:
+		PolymorphicAllocator()
+			: mpAllocator(GetHeapAllocator()) { }
+
+		PolymorphicAllocator(AllocatorBase* pAllocator)
+			: mpAllocator(pAllocator) { }
+
+		FORCE_INLINE void* Allocate(USize size, USize align = DEFAULT_ALIGNMENT)
+		{
+			return mpAllocator->Allocate(size, align);
+		}
+
+		FORCE_INLINE void* Reallocate(void* pMemory, USize oldSize, USize newSize, USize align = DEFAULT_ALIGNMENT)
+		{
+			return mpAllocator->Reallocate(pMemory, oldSize, newSize, align);
+		}
+
+		FORCE_INLINE void Free(void* pMemory, USize size)
+		{
+			mpAllocator->Free(pMemory, size);
+		}
+
+		AllocatorBase* GetAllocatorBase() const
+		{
+			return mpAllocator;
+		}
+	};
+
+	/*
+		Counts allocations made through it before forwarding to a parent
+		allocator. Used to attribute memory to a subsystem.
+	*/
+	class TrackingAllocator : public AllocatorBase
+	{
+	private:
+		AllocatorBase*		mpParent;
+		std::atomic<USize>	mAllocatedBytes;
+		std::atomic<USize>	mPeakBytes;
+		std::atomic<USize>	mAllocationCount;
+		std::atomic<USize>	mLiveCount;
+
+		void Track(USize size)
+		{
+			const USize bytes = mAllocatedBytes.fetch_add(size, std::memory_order_relaxed) + size;
+			USize peak = mPeakBytes.load(std::memory_order_relaxed);
+
+			while (bytes > peak && !mPeakBytes.compare_exchange_weak(peak, bytes, std::memory_order_relaxed));
+		}
+
+	public:
+		TrackingAllocator(AllocatorBase* pParent = GetHeapAllocator())
+			: mpParent(pParent), mAllocatedBytes(0), mPeakBytes(0), mAllocationCount(0), mLiveCount(0) { }
+
+		void* Allocate(USize size, USize align) override
+		{
+			Track(size);
+			mAllocationCount.fetch_add(1, std::memory_order_relaxed);
+			mLiveCount.fetch_add(1, std::memory_order_relaxed);
+
+			return mpParent->Allocate(size, align);
+		}
+
+		void* Reallocate(void* pMemory, USize oldSize, USize newSize, USize align) override
+		{
+			if (pMemory == nullptr)
+			{
+				return Allocate(newSize, align);
+			}
+
+			mAllocatedBytes.fetch_sub(oldSize, std::memory_order_relaxed);
+			Track(newSize);
+			mAllocationCount.fetch_add(1, std::memory_order_relaxed);
+
+			return mpParent->Reallocate(pMemory, oldSize, newSize, align);
+		}
+
+		void Free(void* pMemory, USize size) override
+		{
+			if (pMemory != nullptr)
+			{
+				mAllocatedBytes.fetch_sub(size, std::memory_order_relaxed);
+				mLiveCount.fetch_sub(1, std::memory_order_relaxed);
+			}
+
+			mpParent->Free(pMemory, size);
+		}
+
+		/* Bytes currently allocated */
+		USize AllocatedBytes() const { return mAllocatedBytes.load(std::memory_order_relaxed); }
+
+		/* Highest number of bytes allocated at once */
+		USize PeakBytes() const { return mPeakBytes.load(std::memory_order_relaxed); }
+
+		/* Total calls to Allocate and Reallocate */
+		USize AllocationCount() const { return mAllocationCount.load(std::memory_order_relaxed); }
+
+		/* Allocations not yet freed */
+		USize LiveCount() const { return mLiveCount.load(std::memory_order_relaxed); }
+	};
+
+	/*
+		Holds a container's allocator. Stateless allocators are stored as an
+		empty base so they add nothing to the container's size.
+	*/
+	template<typename AllocatorType, Bool8 isEmpty = std::is_empty<AllocatorType>::value>
+	class AllocatorStorage
+	{
+	private:
+		AllocatorType mAllocator;
+
+	public:
+		AllocatorStorage() = default;
+
+		AllocatorStorage(const AllocatorType& allocator)
+			: mAllocator(allocator) { }
+
+		AllocatorType& GetAllocator() { return mAllocator; }
+		const AllocatorType& GetAllocator() const { return mAllocator; }
+	};
+
+	template<typename AllocatorType>
+	class AllocatorStorage<AllocatorType, true> : private AllocatorType
+	{
+	public:
+		AllocatorStorage() = default;
+
+		AllocatorStorage(const AllocatorType& allocator)
+			: AllocatorType(allocator) { }
+
+		AllocatorType& GetAllocator() { return *this; }
+		const AllocatorType& GetAllocator() const { return *this; }
+	};
+}
@@ -0,0 +1,321 @@
+#pragma once
+
+#include "Allocator.h"
+
+#include <thread>
+
+namespace Quartz
+{
+	/*
+		Bump allocator over a single block. Allocations are never freed
+		individually, everything is released at once by Reset. Allocate may
+		be called from several threads at once, Reset may not.
+
+		When the block is exhausted, allocations spill into overflow blocks
+		taken from the parent allocator. Reset releases them and grows the
+		block so the next cycle fits without spilling.
+	*/
+	class LinearArena final : public AllocatorBase
+	{
+	private:
+		struct OverflowBlock
+		{
+			OverflowBlock*	pNext;
+			USize			size;
+		};
+
+		AllocatorBase*					mpParent;
+		Byte*							mpBlock;
+		USize							mCapacity;
+		USize							mPeakBytes;
+		std::atomic<USize>				mOffset;
+		std::atomic<USize>				mOverflowBytes;
+		std::atomic<OverflowBlock*>		mpOverflow;
+
+		static FORCE_INLINE USize AlignUp(USize address, USize align)
+		{
+			return (address + (align - 1)) & ~static_cast<USize>(align - 1);
+		}
+
+		void* AllocateOverflow(USize size, USize align)
+		{
+			const USize blockSize = sizeof(OverflowBlock) + size + align;
+			OverflowBlock* pBlock = static_cast<OverflowBlock*>(mpParent->Allocate(blockSize, alignof(OverflowBlock)));
+
+			pBlock->size = blockSize;
+			pBlock->pNext = mpOverflow.load(std::memory_order_relaxed);
+
+			while (!mpOverflow.compare_exchange_weak(pBlock->pNext, pBlock,
+				std::memory_order_release, std::memory_order_relaxed));
+
+			mOverflowBytes.fetch_add(size, std::memory_order_relaxed);
+
+			return reinterpret_cast<void*>(AlignUp(reinterpret_cast<USize>(pBlock + 1), align));
+		}
+
+		void SetCapacity(USize capacity)
+		{
+			mpParent->Free(mpBlock, mCapacity);
+			mpBlock = static_cast<Byte*>(mpParent->Allocate(capacity, DEFAULT_ALIGNMENT));
+			mCapacity = capacity;
+		}
+
+	public:
+		LinearArena(AllocatorBase* pParent = GetHeapAllocator())
+			: mpParent(pParent), mpBlock(nullptr), mCapacity(0), mPeakBytes(0),
+			mOffset(0), mOverflowBytes(0), mpOverflow(nullptr) { }
+
+		LinearArena(USize capacity, AllocatorBase* pParent = GetHeapAllocator())
+			: LinearArena(pParent)
+		{
+			Reserve(capacity);
+		}
+
+		LinearArena(const LinearArena&) = delete;
+		LinearArena& operator=(const LinearArena&) = delete;
+
+		~LinearArena()
+		{
+			Reset();
+			mpParent->Free(mpBlock, mCapacity);
+		}
+
+		void* Allocate(USize size, USize align) override
+		{
+			const USize base = reinterpret_cast<USize>(mpBlock);
+			USize offset = mOffset.load(std::memory_order_relaxed);
+			USize end;
+
+			do
+			{
+				const USize start = AlignUp(base + offset, align) - base;
+				end = start + size;
+
+				if (end > mCapacity)
+				{
+					return AllocateOverflow(size, align);
+				}
+			}
+			while (!mOffset.compare_exchange_weak(offset, end, std::memory_order_relaxed));
+
+			return mpBlock + (end - size);
+		}
+
+		/* Resizes in place when pMemory is the most recent allocation */
+		void* Reallocate(void* pMemory, USize oldSize, USize newSize, USize align) override
+		{
+			if (pMemory == nullptr)
+			{
+				return Allocate(newSize, align);
+			}
+
+			Byte* pBytes = static_cast<Byte*>(pMemory);
+
+			if (pBytes >= mpBlock && pBytes < mpBlock + mCapacity)
+			{
+				const USize start = pBytes - mpBlock;
+				USize offset = start + oldSize;
+
+				if (start + newSize <= mCapacity &&
+					mOffset.compare_exchange_strong(offset, start + newSize, std::memory_order_relaxed))
+				{
+					return pMemory;
+				}
+			}
+
+			void* pNewMemory = Allocate(newSize, align);
+			memcpy(pNewMemory, pMemory, oldSize < newSize ? oldSize : newSize);
+
+			return pNewMemory;
+		}
+
+		void Free(void* /*pMemory*/, USize /*size*/) override
+		{
+			// Released by Reset
+		}
+
+		/* Grows the block to at least capacity bytes, the arena must be empty */
+		void Reserve(USize capacity)
+		{
+			DEBUG_ASSERT(mOffset.load(std::memory_order_relaxed) == 0 && "Cannot reserve a LinearArena in use!");
+
+			if (capacity > mCapacity)
+			{
+				SetCapacity(capacity);
+			}
+		}
+
+		/* Releases every allocation made since the last Reset */
+		void Reset()
+		{
+			OverflowBlock* pBlock = mpOverflow.exchange(nullptr, std::memory_order_acquire);
+
+			while (pBlock != nullptr)
+			{
+				OverflowBlock* pNext = pBlock->pNext;
+				mpParent->Free(pBlock, pBlock->size);
+				pBlock = pNext;
+			}
+
+			const USize overflowBytes = mOverflowBytes.exchange(0, std::memory_order_relaxed);
+			const USize usedBytes = mOffset.exchange(0, std::memory_order_relaxed) + overflowBytes;
+
+			if (usedBytes > mPeakBytes)
+			{
+				mPeakBytes = usedBytes;
+			}
+
+			if (overflowBytes > 0)
+			{
+				const USize doubled = mCapacity * 2;
+				SetCapacity(doubled > mPeakBytes ? doubled : mPeakBytes);
+			}
+		}
+
+		/* Bytes allocated from the block, excluding overflow */
+		USize Used() const { return mOffset.load(std::memory_order_relaxed); }
+
+		/* Bytes spilled into overflow blocks */
+		USize OverflowBytes() const { return mOverflowBytes.load(std::memory_order_relaxed); }
+
+		/* Highest usage seen by Reset */
+		USize PeakBytes() const { return mPeakBytes; }
+
+		USize Capacity() const { return mCapacity; }
+	};
+
+	/* Template allocator view of a LinearArena */
+	class ArenaAllocator
+	{
+	private:
+		LinearArena* mpArena;
+
+	public:
+		ArenaAllocator(LinearArena* pArena)
+			: mpArena(pArena) { }
+
+		FORCE_INLINE void* Allocate(USize size, USize align = DEFAULT_ALIGNMENT)
+		{
+			return mpArena->Allocate(size, align);
+		}
+
+		FORCE_INLINE void* Reallocate(void* pMemory, USize oldSize, USize newSize, USize align = DEFAULT_ALIGNMENT)
+		{
+			return mpArena->Reallocate(pMemory, oldSize, newSize, align);
+		}
+
+		FORCE_INLINE void Free(void* /*pMemory*/, USize /*size*/)
+		{
+			// Released by Reset
+		}
+
+		LinearArena* GetArena() const
+		{
+			return mpArena;
+		}
+	};
+
+	constexpr UInt32 MAX_FRAMES_IN_FLIGHT = 3;
+
+	/*
+		One LinearArena per frame in flight. NextFrame moves to the next
+		arena and resets it, so memory allocated during a frame stays valid
+		until NextFrame has been called framesInFlight more times.
+
+		At least two frames are kept, since frame memory such as event
+		queues is read in the frame after it was written. Only the thread
+		that initialized the arena may allocate from it, nothing orders
+		allocations from jobs against the Reset in NextFrame.
+	*/
+	class FrameArena
+	{
+	private:
+		LinearArena		mArenas[MAX_FRAMES_IN_FLIGHT];
+		UInt32			mFramesInFlight;
+		UInt32			mFrameIndex;
+		std::thread::id	mOwnerThread;
+
+	public:
+		FrameArena()
+			: mFramesInFlight(2), mFrameIndex(0), mOwnerThread(std::this_thread::get_id()) { }
+
+		void Initialize(UInt32 framesInFlight, USize capacity)
+		{
+			DEBUG_ASSERT(framesInFlight >= 2 && framesInFlight <= MAX_FRAMES_IN_FLIGHT &&
+				"Frame memory must live for at least 2 frames!");
+
+			mFramesInFlight = framesInFlight;
+			mFrameIndex = 0;
+			mOwnerThread = std::this_thread::get_id();
+
+			for (UInt32 i = 0; i < mFramesInFlight; i++)
+			{
+				mArenas[i].Reset();
+				mArenas[i].Reserve(capacity);
+			}
+		}
+
+		/* Begins a new frame, releasing the memory of the oldest frame */
+		void NextFrame()
+		{
+			DEBUG_ASSERT(IsOwnerThread() && "FrameArena used off its owner thread!");
+
+			mFrameIndex = (mFrameIndex + 1) % mFramesInFlight;
+			mArenas[mFrameIndex].Reset();
+		}
+
+		FORCE_INLINE void* Allocate(USize size, USize align = DEFAULT_ALIGNMENT)
+		{
+			DEBUG_ASSERT(IsOwnerThread() && "FrameArena used off its owner thread!");
+			return mArenas[mFrameIndex].Allocate(size, align);
+		}
+
+		FORCE_INLINE void* Reallocate(void* pMemory, USize oldSize, USize newSize, USize align = DEFAULT_ALIGNMENT)
+		{
+			DEBUG_ASSERT(IsOwnerThread() && "FrameArena used off its owner thread!");
+			return mArenas[mFrameIndex].Reallocate(pMemory, oldSize, newSize, align);
+		}
+
+		FORCE_INLINE Bool8 IsOwnerThread() const { return std::this_thread::get_id() == mOwnerThread; }
+
+		FORCE_INLINE LinearArena& GetCurrentArena() { return mArenas[mFrameIndex]; }
+		FORCE_INLINE UInt32 GetFrameIndex() const { return mFrameIndex; }
+		FORCE_INLINE UInt32 GetFramesInFlight() const { return mFramesInFlight; }
+	};
+
+	/*
+		Template allocator for frame-lifetime containers. Always allocates
+		from the current frame, so a container may keep growing across
+		frames, but its storage must be released (e.g. Reserve(0)) before
+		the frame it was allocated in is recycled.
+	*/
+	class FrameAllocator
+	{
+	private:
+		FrameArena* mpFrameArena;
+
+	public:
+		FrameAllocator(FrameArena* pFrameArena)
+			: mpFrameArena(pFrameArena) { }
+
+		FORCE_INLINE void* Allocate(USize size, USize align = DEFAULT_ALIGNMENT)
+		{
+			return mpFrameArena->Allocate(size, align);
+		}
+
+		FORCE_INLINE void* Reallocate(void* pMemory, USize oldSize, USize newSize, USize align = DEFAULT_ALIGNMENT)
+		{
+			return mpFrameArena->Reallocate(pMemory, oldSize, newSize, align);
+		}
+
+		FORCE_INLINE void Free(void* /*pMemory*/, USize /*size*/)
+		{
+			// Released by FrameArena::NextFrame
+		}
+
+		FrameArena* GetFrameArena() const
+		{
+			return mpFrameArena;
+		}
+	};
+}
@@ -0,0 +1,117 @@
+#pragma once
+
+#include "../Common.h"
+
+#include <atomic>
+
+namespace Quartz
+{
+	/*
+		Fixed capacity Chase-Lev work-stealing deque of pointers. The owning
+		thread pushes and pops at the bottom, any other thread may steal from
+		the top. Follows "Correct and Efficient Work-Stealing for Weak Memory
+		Models" (Le et al. 2013).
+	*/
+	template<typename Type, USize capacity>
+	class JobDeque
+	{
+	public:
+		static_assert((capacity & (capacity - 1)) == 0, "JobDeque capacity must be a power of two");
+
+		constexpr static Int64 MASK = static_cast<Int64>(capacity - 1);
+
+	private:
+		alignas(64) std::atomic<Int64>	mTop;
+		alignas(64) std::atomic<Int64>	mBottom;
+		std::atomic<Type*>				mItems[capacity];
+
+	public:
+		JobDeque()
+			: mTop(0), mBottom(0)
+		{
+			for (USize i = 0; i < capacity; i++)
+			{
+				mItems[i].store(nullptr, std::memory_order_relaxed);
+			}
+		}
+
+		JobDeque(const JobDeque&) = delete;
+		JobDeque& operator=(const JobDeque&) = delete;
+
+		/* Owner only. Returns false if the deque is full */
+		Bool8 Push(Type* pItem)
+		{
+			const Int64 bottom = mBottom.load(std::memory_order_relaxed);
+			const Int64 top = mTop.load(std::memory_order_acquire);
+
+			if (bottom - top >= static_cast<Int64>(capacity))
+			{
+				return false;
+			}
+
+			mItems[bottom & MASK].store(pItem, std::memory_order_relaxed);
+			mBottom.store(bottom + 1, std::memory_order_release);
+
+			return true;
+		}
+
+		/* Owner only. Returns the most recently pushed item or nullptr */
+		Type* Pop()
+		{
+			const Int64 bottom = mBottom.load(std::memory_order_relaxed) - 1;
+			mBottom.store(bottom, std::memory_order_relaxed);
+			std::atomic_thread_fence(std::memory_order_seq_cst);
+			Int64 top = mTop.load(std::memory_order_relaxed);
+
+			if (top > bottom)
+			{
+				mBottom.store(bottom + 1, std::memory_order_relaxed);
+				return nullptr;
+			}
+
+			Type* pItem = mItems[bottom & MASK].load(std::memory_order_relaxed);
+
+			if (top == bottom)
+			{
+				// Last item, race any thieves for it
+				if (!mTop.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+				{
+					pItem = nullptr;
+				}
+
+				mBottom.store(bottom + 1, std::memory_order_relaxed);
+			}
+
+			return pItem;
+		}
+
+		/* Any thread. Returns the oldest item, or nullptr if empty or another thread won it */
+		Type* Steal()
+		{
+			Int64 top = mTop.load(std::memory_order_acquire);
+			std::atomic_thread_fence(std::memory_order_seq_cst);
+			const Int64 bottom = mBottom.load(std::memory_order_acquire);
+
+			if (top >= bottom)
+			{
+				return nullptr;
+			}
+
+			Type* pItem = mItems[top & MASK].load(std::memory_order_relaxed);
+
+			if (!mTop.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+			{
+				return nullptr;
+			}
+
+			return pItem;
+		}
+
+		/* Approximate when called concurrently */
+		USize Size() const
+		{
+			const Int64 size = mBottom.load(std::memory_order_relaxed) - mTop.load(std::memory_order_relaxed);
+			return size > 0 ? static_cast<USize>(size) : 0;
+		}
+	};
+}
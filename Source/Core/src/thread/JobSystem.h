@@ -0,0 +1,684 @@
+#pragma once
+
+#include "../Common.h"
+#include "../debug/Debug.h"
+#include "../util/Array.h"
+#include "JobDeque.h"
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <new>
+#include <thread>
+#include <type_traits>
+#include <utility>
+
+namespace Quartz
+{
+	enum JobAffinity
+	{
+		JOB_AFFINITY_ANY,	// Any worker may run the job
+		JOB_AFFINITY_MAIN	// Only the main thread runs the job
+	};
+
+	class JobCounter;
+
+	/* A queued function. Small callables are stored inline, nothing is allocated per job */
+	struct alignas(64) Job
+	{
+		constexpr static USize DATA_SIZE = 80;
+
+		void				(*pInvoke)(Byte* pData);
+		JobCounter*			pCounter;
+		Job*				pNext;		// Link while waiting on a dependency
+		std::atomic<Bool8>	free;
+		Bool8				heap;
+		JobAffinity			affinity;
+		alignas(16) Byte	data[DATA_SIZE];
+
+		Job()
+			: pInvoke(nullptr), pCounter(nullptr), pNext(nullptr), free(true), heap(false), affinity(JOB_AFFINITY_ANY) { }
+	};
+
+	/*
+		Counts unfinished jobs. Jobs submitted with a counter increment it
+		and decrement it when they finish. Jobs submitted with a counter as
+		their dependency are held back until it reaches zero.
+	*/
+	class JobCounter
+	{
+	public:
+		friend class JobSystem;
+
+	private:
+		std::atomic<UInt32>	mCount;
+		std::mutex			mLock;
+		Job*				mpWaiting;
+
+		/* Returns the jobs released if this was the last unfinished job */
+		Job* Done()
+		{
+			UInt32 count = mCount.load(std::memory_order_relaxed);
+
+			while (count > 1)
+			{
+				if (mCount.compare_exchange_weak(count, count - 1, std::memory_order_acq_rel, std::memory_order_relaxed))
+				{
+					return nullptr;
+				}
+			}
+
+			// The final decrement happens under the lock, so a waiter that sees
+			// zero and destroys the counter blocks in the destructor until we
+			// are done with it
+			std::lock_guard<std::mutex> guard(mLock);
+
+			if (mCount.fetch_sub(1, std::memory_order_acq_rel) != 1)
+			{
+				return nullptr;
+			}
+
+			Job* pWaiting = mpWaiting;
+			mpWaiting = nullptr;
+
+			return pWaiting;
+		}
+
+		/* Returns false if the counter is already done and pJob should run now */
+		Bool8 AddWaiting(Job* pJob)
+		{
+			std::lock_guard<std::mutex> guard(mLock);
+
+			if (mCount.load(std::memory_order_acquire) == 0)
+			{
+				return false;
+			}
+
+			pJob->pNext = mpWaiting;
+			mpWaiting = pJob;
+
+			return true;
+		}
+
+	public:
+		JobCounter()
+			: mCount(0), mpWaiting(nullptr) { }
+
+		~JobCounter()
+		{
+			std::lock_guard<std::mutex> guard(mLock);
+			DEBUG_ASSERT(mpWaiting == nullptr && "JobCounter destroyed with jobs still waiting on it!");
+		}
+
+		JobCounter(const JobCounter&) = delete;
+		JobCounter& operator=(const JobCounter&) = delete;
+
+		FORCE_INLINE void Add(UInt32 count = 1)
+		{
+			mCount.fetch_add(count, std::memory_order_relaxed);
+		}
+
+		FORCE_INLINE Bool8 IsDone() const
+		{
+			return mCount.load(std::memory_order_acquire) == 0;
+		}
+
+		FORCE_INLINE UInt32 Count() const
+		{
+			return mCount.load(std::memory_order_relaxed);
+		}
+	};
+
+	/*
+		Work-stealing job system. The thread calling Initialize becomes the
+		main thread (worker 0), the remaining workers run on their own
+		threads. Each worker pushes and pops jobs on its own deque and steals
+		from the others when empty. Threads waiting on a counter run jobs
+		instead of blocking.
+
+		Jobs with JOB_AFFINITY_MAIN are only run by the main thread, either
+		while it waits or from RunMainThreadJobs. Without Initialize every
+		job runs inline on submit.
+	*/
+	class JobSystem
+	{
+	public:
+		constexpr static USize DEQUE_SIZE		= 4096;
+		constexpr static USize JOB_RING_SIZE	= 4096;
+		constexpr static UInt32 SPIN_COUNT		= 64;
+
+	private:
+		struct alignas(64) Worker
+		{
+			JobDeque<Job, DEQUE_SIZE>	deque;
+			Job*						pJobs;		// Job ring, slots are reused once free
+			USize						nextJob;
+			UInt32						random;
+			std::thread					thread;
+			std::thread::id				threadId;
+		};
+
+		Worker*					mpWorkers;
+		USize					mWorkerCount;
+		UInt32					mGeneration;
+
+		std::mutex				mQueueLock;
+		Array<Job*>				mSharedQueue;	// Jobs from non-worker threads or full deques
+		Array<Job*>				mMainQueue;
+		USize					mMainHead;
+		std::atomic<USize>		mSharedCount;
+		std::atomic<USize>		mMainCount;
+
+		std::atomic<Bool8>		mRunning;
+		std::atomic<USize>		mStarted;
+		std::atomic<USize>		mQueued;
+		std::atomic<UInt32>		mSleeping;
+		std::mutex				mSleepLock;
+		std::condition_variable	mWake;
+
+	private:
+		template<typename Func>
+		static void InvokeJob(Byte* pData)
+		{
+			Func& func = *reinterpret_cast<Func*>(pData);
+			func();
+			func.~Func();
+		}
+
+		Job* AllocateJob(Int32 workerIndex)
+		{
+			if (workerIndex >= 0)
+			{
+				Worker& worker = mpWorkers[workerIndex];
+				Job* pJob = &worker.pJobs[worker.nextJob & (JOB_RING_SIZE - 1)];
+
+				if (pJob->free.load(std::memory_order_acquire))
+				{
+					worker.nextJob++;
+					pJob->free.store(false, std::memory_order_relaxed);
+					pJob->heap = false;
+
+					return pJob;
+				}
+			}
+
+			// Non-worker thread, or the ring slot is still in flight
+			Job* pJob = new Job();
+			pJob->free.store(false, std::memory_order_relaxed);
+			pJob->heap = true;
+
+			return pJob;
+		}
+
+		void Enqueue(Job* pJob, Int32 workerIndex)
+		{
+			if (pJob->affinity == JOB_AFFINITY_MAIN)
+			{
+				std::lock_guard<std::mutex> guard(mQueueLock);
+				mMainQueue.PushBack(pJob);
+				mMainCount.fetch_add(1, std::memory_order_release);
+
+				return;
+			}
+
+			// Counted before the push so a thief never takes an uncounted job
+			mQueued.fetch_add(1, std::memory_order_seq_cst);
+
+			if (workerIndex < 0 || !mpWorkers[workerIndex].deque.Push(pJob))
+			{
+				std::lock_guard<std::mutex> guard(mQueueLock);
+				mSharedQueue.PushBack(pJob);
+				mSharedCount.fetch_add(1, std::memory_order_release);
+			}
+
+			if (mSleeping.load(std::memory_order_seq_cst) > 0)
+			{
+				{
+					std::lock_guard<std::mutex> guard(mSleepLock);
+				}
+
+				mWake.notify_one();
+			}
+		}
+
+		/* Queues pJob, or parks it on pDependency until that counter is done */
+		void Schedule(Job* pJob, JobCounter* pDependency, Int32 workerIndex)
+		{
+			if (pDependency == nullptr || !pDependency->AddWaiting(pJob))
+			{
+				Enqueue(pJob, workerIndex);
+			}
+		}
+
+		void Execute(Job* pJob, Int32 workerIndex)
+		{
+			pJob->pInvoke(pJob->data);
+
+			JobCounter* pCounter = pJob->pCounter;
+
+			if (pJob->heap)
+			{
+				delete pJob;
+			}
+			else
+			{
+				pJob->free.store(true, std::memory_order_release);
+			}
+
+			if (pCounter != nullptr)
+			{
+				Job* pReleased = pCounter->Done();
+
+				while (pReleased != nullptr)
+				{
+					Job* pNext = pReleased->pNext;
+					Enqueue(pReleased, workerIndex);
+					pReleased = pNext;
+				}
+			}
+		}
+
+		Job* TakeMainJob()
+		{
+			if (mMainCount.load(std::memory_order_acquire) == 0)
+			{
+				return nullptr;
+			}
+
+			std::lock_guard<std::mutex> guard(mQueueLock);
+
+			if (mMainHead == mMainQueue.Size())
+			{
+				return nullptr;
+			}
+
+			Job* pJob = mMainQueue[mMainHead++];
+			mMainCount.fetch_sub(1, std::memory_order_relaxed);
+
+			if (mMainHead == mMainQueue.Size())
+			{
+				mMainQueue.Clear();
+				mMainHead = 0;
+			}
+
+			return pJob;
+		}
+
+		Job* TakeSharedJob()
+		{
+			if (mSharedCount.load(std::memory_order_acquire) == 0)
+			{
+				return nullptr;
+			}
+
+			std::lock_guard<std::mutex> guard(mQueueLock);
+
+			if (mSharedQueue.Size() == 0)
+			{
+				return nullptr;
+			}
+
+			Job* pJob = mSharedQueue[mSharedQueue.Size() - 1];
+			mSharedQueue.PopBack();
+			mSharedCount.fetch_sub(1, std::memory_order_relaxed);
+
+			return pJob;
+		}
+
+		Job* FindJob(Int32 workerIndex)
+		{
+			Job* pJob = nullptr;
+
+			if (workerIndex == 0 && (pJob = TakeMainJob()) != nullptr)
+			{
+				return pJob;
+			}
+
+			if (workerIndex >= 0 && (pJob = mpWorkers[workerIndex].deque.Pop()) != nullptr)
+			{
+				mQueued.fetch_sub(1, std::memory_order_relaxed);
+				return pJob;
+			}
+
+			if ((pJob = TakeSharedJob()) != nullptr)
+			{
+				mQueued.fetch_sub(1, std::memory_order_relaxed);
+				return pJob;
+			}
+
+			// Steal, starting from a random victim to spread contention
+			UInt32 random = static_cast<UInt32>(workerIndex + 1) * 0x9E3779B9u;
+
+			if (workerIndex >= 0)
+			{
+				UInt32& state = mpWorkers[workerIndex].random;
+				state ^= state << 13;
+				state ^= state >> 17;
+				state ^= state << 5;
+				random = state;
+			}
+
+			for (USize i = 0; i < mWorkerCount; i++)
+			{
+				const USize victim = (random + i) % mWorkerCount;
+
+				if (static_cast<Int32>(victim) == workerIndex)
+				{
+					continue;
+				}
+
+				if ((pJob = mpWorkers[victim].deque.Steal()) != nullptr)
+				{
+					mQueued.fetch_sub(1, std::memory_order_relaxed);
+					return pJob;
+				}
+			}
+
+			return nullptr;
+		}
+
+		void WorkerMain(Int32 workerIndex)
+		{
+			mpWorkers[workerIndex].threadId = std::this_thread::get_id();
+			mStarted.fetch_add(1, std::memory_order_release);
+
+			UInt32 idle = 0;
+
+			while (mRunning.load(std::memory_order_acquire))
+			{
+				Job* pJob = FindJob(workerIndex);
+
+				if (pJob != nullptr)
+				{
+					Execute(pJob, workerIndex);
+					idle = 0;
+					continue;
+				}
+
+				if (++idle < SPIN_COUNT)
+				{
+					std::this_thread::yield();
+					continue;
+				}
+
+				std::unique_lock<std::mutex> lock(mSleepLock);
+				mSleeping.fetch_add(1, std::memory_order_seq_cst);
+
+				mWake.wait_for(lock, std::chrono::milliseconds(2), [this]()
+				{
+					return !mRunning.load(std::memory_order_acquire) ||
+						mQueued.load(std::memory_order_seq_cst) > 0;
+				});
+
+				mSleeping.fetch_sub(1, std::memory_order_relaxed);
+				idle = 0;
+			}
+
+			// Jobs pushed by jobs still running during Shutdown
+			while (Job* pJob = mpWorkers[workerIndex].deque.Pop())
+			{
+				Execute(pJob, workerIndex);
+			}
+		}
+
+		template<typename Func>
+		void SplitRange(Func* pFunc, USize begin, USize end, USize batch, JobCounter* pCounter)
+		{
+			// Hand the upper halves to thieves, each stolen half keeps splitting
+			while (end - begin > batch)
+			{
+				const USize middle = begin + (end - begin) / 2;
+
+				Submit([this, pFunc, middle, end, batch, pCounter]()
+				{
+					SplitRange(pFunc, middle, end, batch, pCounter);
+				},
+				pCounter);
+
+				end = middle;
+			}
+
+			(*pFunc)(begin, end);
+		}
+
+	public:
+		JobSystem()
+			: mpWorkers(nullptr), mWorkerCount(0), mGeneration(0), mMainHead(0),
+			mSharedCount(0), mMainCount(0), mRunning(false), mStarted(0), mQueued(0), mSleeping(0) { }
+
+		JobSystem(const JobSystem&) = delete;
+		JobSystem& operator=(const JobSystem&) = delete;
+
+		~JobSystem()
+		{
+			Shutdown();
+		}
+
+		/* Starts workerCount - 1 threads, 0 uses one worker per hardware thread */
+		void Initialize(USize workerCount = 0)
+		{
+			DEBUG_ASSERT(mpWorkers == nullptr && "JobSystem is already initialized!");
+
+			if (workerCount == 0)
+			{
+				workerCount = std::thread::hardware_concurrency();
+				workerCount = workerCount > 0 ? workerCount : 1;
+			}
+
+			mpWorkers = new Worker[workerCount];
+			mWorkerCount = workerCount;
+			mGeneration++;
+			mRunning.store(true, std::memory_order_release);
+
+			for (USize i = 0; i < workerCount; i++)
+			{
+				mpWorkers[i].pJobs = new Job[JOB_RING_SIZE];
+				mpWorkers[i].nextJob = 0;
+				mpWorkers[i].random = static_cast<UInt32>(i + 1) * 0x9E3779B9u;
+			}
+
+			mpWorkers[0].threadId = std::this_thread::get_id();
+			mStarted.store(0, std::memory_order_relaxed);
+
+			for (USize i = 1; i < workerCount; i++)
+			{
+				mpWorkers[i].thread = std::thread(&JobSystem::WorkerMain, this, static_cast<Int32>(i));
+			}
+
+			// Every worker has published its thread id before any job can look one up
+			while (mStarted.load(std::memory_order_acquire) != workerCount - 1)
+			{
+				std::this_thread::yield();
+			}
+		}
+
+		/* Runs the remaining jobs and joins the worker threads */
+		void Shutdown()
+		{
+			if (mpWorkers == nullptr)
+			{
+				return;
+			}
+
+			while (Job* pJob = FindJob(0))
+			{
+				Execute(pJob, 0);
+			}
+
+			{
+				std::lock_guard<std::mutex> guard(mSleepLock);
+				mRunning.store(false, std::memory_order_release);
+			}
+
+			mWake.notify_all();
+
+			for (USize i = 1; i < mWorkerCount; i++)
+			{
+				mpWorkers[i].thread.join();
+			}
+
+			for (USize i = 0; i < mWorkerCount; i++)
+			{
+				delete[] mpWorkers[i].pJobs;
+			}
+
+			delete[] mpWorkers;
+			mpWorkers = nullptr;
+			mWorkerCount = 0;
+		}
+
+		/* Index of the calling worker thread, or -1 for threads outside the job system */
+		Int32 GetWorkerIndex() const
+		{
+			// Cached per thread, the owner check keeps each JobSystem and generation apart
+			static thread_local const JobSystem* spOwner = nullptr;
+			static thread_local UInt32 sGeneration = 0;
+			static thread_local Int32 sIndex = -1;
+
+			if (spOwner != this || sGeneration != mGeneration)
+			{
+				const std::thread::id threadId = std::this_thread::get_id();
+				sIndex = -1;
+
+				for (USize i = 0; i < mWorkerCount; i++)
+				{
+					if (mpWorkers[i].threadId == threadId)
+					{
+						sIndex = static_cast<Int32>(i);
+						break;
+					}
+				}
+
+				spOwner = this;
+				sGeneration = mGeneration;
+			}
+
+			return sIndex;
+		}
+
+		/*
+			Queues func to run on a worker. pCounter is incremented now and
+			decremented when func returns. The job does not start before
+			pDependency is done.
+		*/
+		template<typename Func>
+		void Submit(Func&& func, JobCounter* pCounter = nullptr, JobCounter* pDependency = nullptr,
+			JobAffinity affinity = JOB_AFFINITY_ANY)
+		{
+			using FuncType = std::decay_t<Func>;
+
+			static_assert(sizeof(FuncType) <= Job::DATA_SIZE, "Job function is too large, capture less by value");
+			static_assert(alignof(FuncType) <= 16, "Job function alignment is too large");
+
+			if (mpWorkers == nullptr)
+			{
+				DEBUG_ASSERT((pDependency == nullptr || pDependency->IsDone()) && "JobSystem is not initialized!");
+				func();
+				return;
+			}
+
+			const Int32 workerIndex = GetWorkerIndex();
+			Job* pJob = AllocateJob(workerIndex);
+
+			new (pJob->data) FuncType(std::forward<Func>(func));
+			pJob->pInvoke = &InvokeJob<FuncType>;
+			pJob->pCounter = pCounter;
+			pJob->pNext = nullptr;
+			pJob->affinity = affinity;
+
+			if (pCounter != nullptr)
+			{
+				pCounter->Add();
+			}
+
+			Schedule(pJob, pDependency, workerIndex);
+		}
+
+		/* Runs jobs on the calling thread until counter is done */
+		void Wait(const JobCounter& counter)
+		{
+			const Int32 workerIndex = GetWorkerIndex();
+			UInt32 idle = 0;
+
+			while (!counter.IsDone())
+			{
+				Job* pJob = mpWorkers != nullptr ? FindJob(workerIndex) : nullptr;
+
+				if (pJob != nullptr)
+				{
+					Execute(pJob, workerIndex);
+					idle = 0;
+				}
+				else if (++idle < SPIN_COUNT)
+				{
+					std::this_thread::yield();
+				}
+				else
+				{
+					std::this_thread::sleep_for(std::chrono::microseconds(50));
+				}
+			}
+		}
+
+		/*
+			Calls func(begin, end) over subranges of [0, count) in parallel and
+			returns once all have finished. Ranges are split in halves down to
+			a batch of at least minBatch, so idle workers steal large ranges
+			first and only busy workers are left with small ones.
+		*/
+		template<typename Func>
+		void ParallelFor(USize count, Func&& func, USize minBatch = 1)
+		{
+			if (count == 0)
+			{
+				return;
+			}
+
+			const USize workerCount = mWorkerCount > 0 ? mWorkerCount : 1;
+			USize batch = count / (workerCount * 8);
+			batch = batch > minBatch ? batch : minBatch;
+			batch = batch > 0 ? batch : 1;
+
+			if (workerCount == 1 || count <= batch)
+			{
+				func(static_cast<USize>(0), count);
+				return;
+			}
+
+			JobCounter counter;
+			SplitRange(&func, 0, count, batch, &counter);
+			Wait(counter);
+		}
+
+		/* Runs every queued main thread job, called once per frame by the engine */
+		void RunMainThreadJobs()
+		{
+			if (mpWorkers == nullptr)
+			{
+				return;
+			}
+
+			DEBUG_ASSERT(IsMainThread() && "RunMainThreadJobs called off the main thread!");
+
+			while (Job* pJob = TakeMainJob())
+			{
+				Execute(pJob, 0);
+			}
+		}
+
+		FORCE_INLINE Bool8 IsMainThread() const
+		{
+			return mpWorkers == nullptr || GetWorkerIndex() == 0;
+		}
+
+		FORCE_INLINE Bool8 IsInitialized() const { return mpWorkers != nullptr; }
+		FORCE_INLINE USize GetWorkerCount() const { return mWorkerCount > 0 ? mWorkerCount : 1; }
+	};
+
+	/*
+		The process wide JobSystem. Defined by the Engine module so modules
+		and ECS systems submit to the same workers.
+	*/
+	QUARTZ_API JobSystem& GetJobSystem();
+}
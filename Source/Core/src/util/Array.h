@@ -1,21 +1,26 @@
 #pragma once
 
 #include "../Common.h"
+#include "../memory/Allocator.h"
+#include "Utility.h"
 #include <cstdlib>
 #include <cstring>
 #include <new>
+#include <utility>
+#include <type_traits>
 
 #include "../debug/Debug.h"
 
 namespace Quartz
 {
-	template<typename _ValueType>
-	class Array
+	template<typename _ValueType, typename _Allocator = HeapAllocator>
+	class Array : public AllocatorStorage<_Allocator>
 	{
 	public:
 		using ValueType = _ValueType;
 		using SizeType = USize;
-		using ArrayType = Array<_ValueType>;
+		using AllocatorType = _Allocator;
+		using ArrayType = Array<_ValueType, _Allocator>;
 
 		class Iterator
 		{
@@ -103,33 +108,120 @@ namespace Quartz
 			Swap(array1.mpData, array2.mpData);
 			Swap(array1.mSize, array2.mSize);
 			Swap(array1.mCapacity, array2.mCapacity);
+			Swap(array1.GetAllocator(), array2.GetAllocator());
+		}
+
+		ValueType* AllocateData(SizeType capacity)
+		{
+			return static_cast<ValueType*>(this->GetAllocator().Allocate(capacity * sizeof(ValueType), alignof(ValueType)));
+		}
+
+		void FreeData(ValueType* pData, SizeType capacity)
+		{
+			if (pData != nullptr)
+			{
+				this->GetAllocator().Free(pData, capacity * sizeof(ValueType));
+			}
+		}
+
+		/*
+			Moves count values from pSrc into uninitialized pDest, leaving pSrc
+			uninitialized. The ranges may overlap.
+		*/
+		static void Relocate(ValueType* pDest, ValueType* pSrc, SizeType count)
+		{
+			if constexpr (IsTriviallyRelocatable<ValueType>::value)
+			{
+				if (count > 0)
+				{
+					memmove(static_cast<void*>(pDest), pSrc, count * sizeof(ValueType));
+				}
+			}
+			else if (pDest < pSrc)
+			{
+				for (SizeType i = 0; i < count; i++)
+				{
+					new (&pDest[i]) ValueType(Move(pSrc[i]));
+					pSrc[i].~ValueType();
+				}
+			}
+			else if (pDest > pSrc)
+			{
+				for (SizeType i = count; i > 0; i--)
+				{
+					new (&pDest[i - 1]) ValueType(Move(pSrc[i - 1]));
+					pSrc[i - 1].~ValueType();
+				}
+			}
 		}
 
 		void ReserveImpl(SizeType capacity, SizeType offset = 0)
 		{
-			ValueType* mpPrev = mpData;
-			mpData = static_cast<ValueType*>(malloc(capacity * sizeof(ValueType)));
+			if (capacity == 0)
+			{
+				FreeData(mpData, mCapacity);
+				mpData = nullptr;
+				mCapacity = 0;
+				return;
+			}
 
-			for (SizeType i = 0; i < mSize; i++)
+			if constexpr (IsTriviallyRelocatable<ValueType>::value)
 			{
-				Swap(mpData[i + offset], mpPrev[i]);
+				if (offset == 0)
+				{
+					// Values can be moved by the allocator, possibly in place
+					mpData = static_cast<ValueType*>(this->GetAllocator().Reallocate(mpData,
+						mCapacity * sizeof(ValueType), capacity * sizeof(ValueType), alignof(ValueType)));
+					mCapacity = capacity;
+					return;
+				}
 			}
 
+			ValueType* pPrev = mpData;
+			mpData = AllocateData(capacity);
+
+			Relocate(mpData + offset, pPrev, mSize);
+
+			// No need to destruct values because
+			// all valid entries have been relocated
+			FreeData(pPrev, mCapacity);
+
 			mCapacity = capacity;
+		}
+
+		/*
+			Grows the array and constructs a value at the end. The value is
+			constructed before the old values are relocated, so args may
+			safely reference values in this array.
+		*/
+		template<typename... Args>
+		ValueType* EmplaceBackGrow(Args&&... args)
+		{
+			const SizeType capacity = NextSize(mCapacity);
+			ValueType* pNext = AllocateData(capacity);
+			ValueType* pValue = new (&pNext[mSize]) ValueType(std::forward<Args>(args)...);
+
+			Relocate(pNext, mpData, mSize);
+			FreeData(mpData, mCapacity);
 
-			// No need to destruct values because 
-			// all valid entries have been swapped
-			free(mpPrev);
+			mpData = pNext;
+			mCapacity = capacity;
+			++mSize;
+
+			return pValue;
 		}
 
 	public:
 		Array()
 			: mpData(nullptr), mSize(0), mCapacity(0) {}
 
-		Array(SizeType size)
-			: mSize(size), mCapacity(size)
+		explicit Array(const AllocatorType& allocator)
+			: AllocatorStorage<AllocatorType>(allocator), mpData(nullptr), mSize(0), mCapacity(0) {}
+
+		Array(SizeType size, const AllocatorType& allocator = AllocatorType())
+			: AllocatorStorage<AllocatorType>(allocator), mSize(size), mCapacity(size)
 		{
-			mpData = static_cast<ValueType*>(malloc(size * sizeof(ValueType)));
+			mpData = AllocateData(size);
 
 			for (SizeType i = 0; i < mSize; i++)
 			{
@@ -138,10 +230,10 @@ namespace Quartz
 			}
 		}
 
-		Array(SizeType size, const ValueType& value)
-			: mSize(size), mCapacity(size)
+		Array(SizeType size, const ValueType& value, const AllocatorType& allocator = AllocatorType())
+			: AllocatorStorage<AllocatorType>(allocator), mSize(size), mCapacity(size)
 		{
-			mpData = static_cast<ValueType*>(malloc(size * sizeof(ValueType)));
+			mpData = AllocateData(size);
 
 			for (SizeType i = 0; i < mSize; i++)
 			{
@@ -151,14 +243,24 @@ namespace Quartz
 		}
 
 		Array(const ArrayType& array)
-			: mSize(array.mSize), mCapacity(array.mCapacity)
+			: AllocatorStorage<AllocatorType>(array.GetAllocator()), mSize(array.mSize), mCapacity(array.mCapacity)
 		{
-			mpData = static_cast<ValueType*>(malloc(array.mCapacity * sizeof(ValueType)));
+			mpData = AllocateData(array.mCapacity);
 
-			for (SizeType i = 0; i < mSize; i++)
+			if constexpr (std::is_trivially_copyable<ValueType>::value)
 			{
-				// Construct value from given value from the array
-				new (&mpData[i]) ValueType(array.mpData[i]);
+				if (mSize > 0)
+				{
+					memcpy(mpData, array.mpData, mSize * sizeof(ValueType));
+				}
+			}
+			else
+			{
+				for (SizeType i = 0; i < mSize; i++)
+				{
+					// Construct value from given value from the array
+					new (&mpData[i]) ValueType(array.mpData[i]);
+				}
 			}
 		}
 
@@ -168,23 +270,16 @@ namespace Quartz
 			Swap(*this, array);
 		}
 
-		//Todo: make custom implementation
-		Array(std::initializer_list<ValueType> list) :
-			ArrayType(list.size())
+		Array(std::initializer_list<ValueType> list, const AllocatorType& allocator = AllocatorType()) :
+			ArrayType(allocator)
 		{
-			//memcpy(mpData, list.begin(), mSize * sizeof(ValueType));
-
-			for (SizeType i = 0; i < mSize; i++)
-			{
-				// Construct value from given value from the array
-				new (&mpData[i]) ValueType(*(list.begin() + i));
-			}
+			Append(list.begin(), list.size());
 		}
 
 		~Array()
 		{
 			Clear();
-			free(mpData);
+			FreeData(mpData, mCapacity);
 		}
 
 		ValueType* PushFront(const ValueType& value)
@@ -199,7 +294,7 @@ namespace Quartz
 			else
 			{
 				// Move all values right by one
-				memmove(&mpData[1], &mpData[0], mSize * sizeof(ValueType));
+				Relocate(&mpData[1], &mpData[0], mSize);
 			}
 
 			++mSize;
@@ -221,7 +316,7 @@ namespace Quartz
 			else
 			{
 				// Move all values right by one
-				memmove(&mpData[1], &mpData[0], mSize * sizeof(ValueType));
+				Relocate(&mpData[1], &mpData[0], mSize);
 			}
 
 			++mSize;
@@ -231,25 +326,67 @@ namespace Quartz
 		}
 
 		ValueType* PushBack(const ValueType& value)
+		{
+			return EmplaceBack(value);
+		}
+
+		ValueType* PushBack(ValueType&& rValue)
+		{
+			return EmplaceBack(Move(rValue));
+		}
+
+		/* Constructs a value in place at the end of the array */
+		template<typename... Args>
+		ValueType* EmplaceBack(Args&&... args)
 		{
 			if (mSize + 1 > mCapacity)
 			{
-				ReserveImpl(NextSize(mCapacity));
+				return EmplaceBackGrow(std::forward<Args>(args)...);
 			}
 
 			// Construct at the end of the array
-			return new (&mpData[mSize++]) ValueType(value);
+			return new (&mpData[mSize++]) ValueType(std::forward<Args>(args)...);
 		}
 
-		ValueType* PushBack(ValueType&& rValue)
+		/* Copies count values to the end of the array */
+		void Append(const ValueType* pValues, SizeType count)
 		{
-			if (mSize + 1 > mCapacity)
+			if (mSize + count > mCapacity)
 			{
-				ReserveImpl(NextSize(mCapacity));
+				// Values appended from this array move with it, the old block is freed
+				const Bool8 aliased = pValues >= mpData && pValues < mpData + mSize;
+				const SizeType offset = aliased ? static_cast<SizeType>(pValues - mpData) : 0;
+				const SizeType next = NextSize(mCapacity);
+
+				ReserveImpl(next > mSize + count ? next : mSize + count);
+
+				if (aliased)
+				{
+					pValues = mpData + offset;
+				}
 			}
 
-			// Construct at the end of the array
-			return new (&mpData[mSize++]) ValueType(Move(rValue));
+			if constexpr (std::is_trivially_copyable<ValueType>::value)
+			{
+				if (count > 0)
+				{
+					memcpy(&mpData[mSize], pValues, count * sizeof(ValueType));
+				}
+			}
+			else
+			{
+				for (SizeType i = 0; i < count; i++)
+				{
+					new (&mpData[mSize + i]) ValueType(pValues[i]);
+				}
+			}
+
+			mSize += count;
+		}
+
+		void Append(const ArrayType& array)
+		{
+			Append(array.mpData, array.mSize);
 		}
 
 		void PopBack()
@@ -270,21 +407,21 @@ namespace Quartz
 
 		void Remove(SizeType index)
 		{
-			mpData[index].~ValueType();
-
-			if (mSize > 0 && index < mSize)
+			if (index < mSize)
 			{
+				mpData[index].~ValueType();
+
 				// Move all values left by one
-				memmove(&mpData[index], &mpData[index + 1], (mSize - index) * sizeof(ValueType));
+				Relocate(&mpData[index], &mpData[index + 1], mSize - index - 1);
 				--mSize;
 			}
 		}
 
-		Bool8 Contains(const ValueType& value)
+		Bool8 Contains(const ValueType& value) const
 		{
-			for (const ValueType& match : *this)
+			for (SizeType i = 0; i < mSize; i++)
 			{
-				if (value == match)
+				if (mpData[i] == value)
 				{
 					return true;
 				}
@@ -294,7 +431,7 @@ namespace Quartz
 		}
 
 		// Returns size if index not found
-		SizeType IndexOf(const ValueType& value)
+		SizeType IndexOf(const ValueType& value) const
 		{
 			for (SizeType i = 0; i < mSize; i++)
 			{
@@ -348,7 +485,7 @@ namespace Quartz
 
 			else if (size < mSize)
 			{
-				for (SizeType i = mSize; i >= size; --i)
+				for (SizeType i = size; i < mSize; i++)
 				{
 					// Destruct valid entries
 					mpData[i].~ValueType();
@@ -358,6 +495,22 @@ namespace Quartz
 			mSize = size;
 		}
 
+		/*
+			Resizes without constructing new values. Only for trivial
+			types, eg. buffers that are about to be overwritten.
+		*/
+		void ResizeNoInit(SizeType size)
+		{
+			static_assert(std::is_trivial<ValueType>::value, "ResizeNoInit requires a trivial ValueType");
+
+			if (size > mCapacity)
+			{
+				ReserveImpl(size);
+			}
+
+			mSize = size;
+		}
+
 		void Reserve(SizeType capacity)
 		{
 			if (capacity < mSize)
@@ -472,4 +625,7 @@ namespace Quartz
 			return mSize == 0;
 		}
 	};
+
+	template<typename ValueType, typename AllocatorType>
+	struct IsTriviallyRelocatable<Array<ValueType, AllocatorType>> : public IsTriviallyRelocatable<AllocatorType> {};
 }
\ No newline at end of file
@@ -1,6 +1,8 @@
 #pragma once
 
 #include "../Common.h"
+#include "../memory/Allocator.h"
+#include "Utility.h"
 #include <cstdlib>
 #include <cstring>
 #include <new>
@@ -9,12 +11,13 @@
 
 namespace Quartz
 {
-	template<typename _Type>
-	class DataBuffer
+	template<typename _Type, typename _Allocator = HeapAllocator>
+	class DataBuffer : public AllocatorStorage<_Allocator>
 	{
 	public:
 		using Type			= _Type;
-		using BufferType	= DataBuffer<Type>;
+		using AllocatorType	= _Allocator;
+		using BufferType	= DataBuffer<Type, AllocatorType>;
 
 	private:
 		Type* mpData;
@@ -33,16 +36,33 @@ namespace Quartz
 			Swap(array1.mpData, array2.mpData);
 			Swap(array1.mSize, array2.mSize);
 			Swap(array1.mCapacity, array2.mCapacity);
+			Swap(array1.GetAllocator(), array2.GetAllocator());
+		}
+
+		Type* AllocateData(USize capacity)
+		{
+			return static_cast<Type*>(this->GetAllocator().Allocate(capacity * sizeof(Type), alignof(Type)));
+		}
+
+		void FreeData(Type* pData, USize capacity)
+		{
+			if (pData != nullptr)
+			{
+				this->GetAllocator().Free(pData, capacity * sizeof(Type));
+			}
 		}
 
 	public:
 		DataBuffer()
 			: mpData(nullptr), mSize(0), mCapacity(0) {}
 
-		DataBuffer(USize capacity)
-			: mSize(0), mCapacity(capacity)
+		explicit DataBuffer(const AllocatorType& allocator)
+			: AllocatorStorage<AllocatorType>(allocator), mpData(nullptr), mSize(0), mCapacity(0) {}
+
+		DataBuffer(USize capacity, const AllocatorType& allocator = AllocatorType())
+			: AllocatorStorage<AllocatorType>(allocator), mSize(0), mCapacity(capacity)
 		{
-			mpData = static_cast<Type*>(malloc(mCapacity * sizeof(Type)));
+			mpData = AllocateData(mCapacity);
 
 			for (USize i = 0; i < mCapacity; i++)
 			{
@@ -52,9 +72,9 @@ namespace Quartz
 		}
 
 		DataBuffer(const BufferType& buffer)
-			: mSize(buffer.mSize), mCapacity(buffer.mCapacity)
+			: AllocatorStorage<AllocatorType>(buffer.GetAllocator()), mSize(buffer.mSize), mCapacity(buffer.mCapacity)
 		{
-			mpData = static_cast<Type*>(malloc(buffer.mCapacity * sizeof(Type)));
+			mpData = AllocateData(buffer.mCapacity);
 
 			for (USize i = 0; i < buffer.mSize; i++)
 			{
@@ -77,7 +97,7 @@ namespace Quartz
 				mpData[i].~Type();
 			}
 
-			free(mpData);
+			FreeData(mpData, mCapacity);
 		}
 
 		template<typename ValueType>
@@ -115,19 +135,32 @@ namespace Quartz
 
 		void Reserve(USize capacity)
 		{
-			Type* mpPrev = mpData;
-			mpData = static_cast<Type*>(calloc(capacity, sizeof(Type)));
+			if constexpr (IsTriviallyRelocatable<Type>::value)
+			{
+				mpData = static_cast<Type*>(this->GetAllocator().Reallocate(mpData,
+					mCapacity * sizeof(Type), capacity * sizeof(Type), alignof(Type)));
 
-			for (USize i = 0; i < mSize; i++)
+				if (capacity > mCapacity)
+				{
+					memset(mpData + mCapacity, 0, (capacity - mCapacity) * sizeof(Type));
+				}
+			}
+			else
 			{
-				Swap(mpData[i], mpPrev[i]);
+				Type* mpPrev = mpData;
+				mpData = AllocateData(capacity);
+				memset(mpData, 0, capacity * sizeof(Type));
+
+				for (USize i = 0; i < mSize; i++)
+				{
+					new (&mpData[i]) Type(Move(mpPrev[i]));
+					mpPrev[i].~Type();
+				}
+
+				FreeData(mpPrev, mCapacity);
 			}
 
 			mCapacity = capacity;
-
-			// No need to destruct values because 
-			// all valid entries have been swapped
-			free(mpPrev);
 		}
 
 		BufferType& operator=(BufferType buffer)
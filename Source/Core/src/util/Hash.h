@@ -1,22 +1,163 @@
 #pragma once
 #include "../Common.h"
 
+#include <cstring>
+
+#if _MSC_VER && defined(_M_X64)
+#include <intrin.h>
+#pragma intrinsic(_umul128)
+#endif
+
 namespace Quartz
 {
 	template<typename HashType>
 	UInt32 Hash(const HashType& value) = delete;
 
+	/*
+		Allows Lookup to be used in place of Key when probing hashed containers
+		(Map, Set, Table) without constructing a Key. Specializations must
+		provide a LookupType and a static Hash(lookup) that is equal to Hash<Key>
+		of the equivalent key. Lookup is always decayed before matching.
+	*/
+	template<typename Key, typename Lookup>
+	struct TransparentHash { };
+
+	//////////////////////////////////////////////////////////////
+	// Byte Hashing (wyhash final v4)
+	// https://github.com/wangyi-fudan/wyhash
+	//////////////////////////////////////////////////////////////
+
+	/* 64x64 -> 128 bit multiply, a receives the low and b the high half */
+	FORCE_INLINE void HashMultiply(UInt64& a, UInt64& b)
+	{
+#if _MSC_VER && defined(_M_X64)
+		a = _umul128(a, b, &b);
+#elif defined(__SIZEOF_INT128__)
+		__uint128_t result = static_cast<__uint128_t>(a) * b;
+		a = static_cast<UInt64>(result);
+		b = static_cast<UInt64>(result >> 64);
+#else
+		const UInt64 ha = a >> 32, hb = b >> 32, la = (UInt32)a, lb = (UInt32)b;
+		const UInt64 rh = ha * hb, rm0 = ha * lb, rm1 = hb * la, rl = la * lb;
+		const UInt64 t = rl + (rm0 << 32);
+		UInt64 carry = t < rl;
+		const UInt64 low = t + (rm1 << 32);
+		carry += low < t;
+		a = low;
+		b = rh + (rm0 >> 32) + (rm1 >> 32) + carry;
+#endif
+	}
+
+	/* 128 bit multiply folded back to 64 bits */
+	FORCE_INLINE UInt64 HashMix(UInt64 a, UInt64 b)
+	{
+		HashMultiply(a, b);
+		return a ^ b;
+	}
+
+	FORCE_INLINE UInt64 HashRead8(const Byte* pData)
+	{
+		UInt64 value;
+		memcpy(&value, pData, sizeof(UInt64));
+		return value;
+	}
+
+	FORCE_INLINE UInt64 HashRead4(const Byte* pData)
+	{
+		UInt32 value;
+		memcpy(&value, pData, sizeof(UInt32));
+		return value;
+	}
+
+	/*
+		Hashes an arbitrary block of bytes. Inputs over 48 bytes are
+		consumed 48 bytes per iteration across three independent lanes.
+	*/
+	inline UInt64 HashBytes(const void* pData, USize length, UInt64 seed = 0)
+	{
+		constexpr UInt64 SECRET0 = 0x2D358DCCAA6C78A5ull;
+		constexpr UInt64 SECRET1 = 0x8BB84B93962EACC9ull;
+		constexpr UInt64 SECRET2 = 0x4B33A62ED433D4A3ull;
+		constexpr UInt64 SECRET3 = 0x4D5A2DA51DE1AA47ull;
+
+		const Byte* pBytes = static_cast<const Byte*>(pData);
+		UInt64 a;
+		UInt64 b;
+
+		seed ^= HashMix(seed ^ SECRET0, SECRET1);
+
+		if (length <= 16)
+		{
+			if (length >= 4)
+			{
+				const USize offset = (length >> 3) << 2;
+				a = (HashRead4(pBytes) << 32) | HashRead4(pBytes + offset);
+				b = (HashRead4(pBytes + length - 4) << 32) | HashRead4(pBytes + length - 4 - offset);
+			}
+			else if (length > 0)
+			{
+				a = (static_cast<UInt64>(pBytes[0]) << 16) |
+					(static_cast<UInt64>(pBytes[length >> 1]) << 8) |
+					static_cast<UInt64>(pBytes[length - 1]);
+				b = 0;
+			}
+			else
+			{
+				a = 0;
+				b = 0;
+			}
+		}
+		else
+		{
+			USize remaining = length;
+
+			if (remaining > 48)
+			{
+				UInt64 seed1 = seed;
+				UInt64 seed2 = seed;
+
+				do
+				{
+					seed	= HashMix(HashRead8(pBytes) ^ SECRET1, HashRead8(pBytes + 8) ^ seed);
+					seed1	= HashMix(HashRead8(pBytes + 16) ^ SECRET2, HashRead8(pBytes + 24) ^ seed1);
+					seed2	= HashMix(HashRead8(pBytes + 32) ^ SECRET3, HashRead8(pBytes + 40) ^ seed2);
+					pBytes += 48;
+					remaining -= 48;
+				}
+				while (remaining > 48);
+
+				seed ^= seed1 ^ seed2;
+			}
+
+			while (remaining > 16)
+			{
+				seed = HashMix(HashRead8(pBytes) ^ SECRET1, HashRead8(pBytes + 8) ^ seed);
+				pBytes += 16;
+				remaining -= 16;
+			}
+
+			a = HashRead8(pBytes + remaining - 16);
+			b = HashRead8(pBytes + remaining - 8);
+		}
+
+		a ^= SECRET1;
+		b ^= seed;
+		HashMultiply(a, b);
+
+		return HashMix(a ^ SECRET0 ^ length, b ^ SECRET1);
+	}
+
 	template<>
 	FORCE_INLINE UInt32 Hash<Int32>(const Int32& value)
 	{
 		//https://stackoverflow.com/questions/664014/what-integer-hash-function-are-good-that-accepts-an-integer-hash-key
-		return value * 2654435761 % (2 ^ 32);
+		return static_cast<UInt32>(value) * 2654435761U;
 	}
 
 	template<>
 	FORCE_INLINE UInt32 Hash<UInt32>(const UInt32& value)
 	{
-		return value * 2654435761 % (2 ^ 32);
+		return value * 2654435761U;
 	}
 
 	template<>
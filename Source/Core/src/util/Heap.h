@@ -1,15 +1,19 @@
 #pragma once
 
 #include "../Common.h"
+#include "../memory/Allocator.h"
+
+#include <new>
 
 namespace Quartz
 {
-	template<typename _Type>
-	class Heap
+	template<typename _Type, typename _Allocator = HeapAllocator>
+	class Heap : public AllocatorStorage<_Allocator>
 	{
 	public:
 		using Type = _Type;
-		using HeapType = Heap<Type>;
+		using AllocatorType = _Allocator;
+		using HeapType = Heap<Type, AllocatorType>;
 
 	private:
 		struct HeapNode
@@ -43,6 +47,18 @@ namespace Quartz
 		USize mSize;
 
 	private:
+		HeapNode* CreateNode(USize key, const Type& value)
+		{
+			void* pMemory = this->GetAllocator().Allocate(sizeof(HeapNode), alignof(HeapNode));
+			return new (pMemory) HeapNode(key, value, nullptr, nullptr);
+		}
+
+		void DestroyNode(HeapNode* pNode)
+		{
+			pNode->~HeapNode();
+			this->GetAllocator().Free(pNode, sizeof(HeapNode));
+		}
+
 		HeapNode* MergeNodes(HeapNode* pNode1, HeapNode* pNode2)
 		{
 			if (pNode1 == nullptr)
@@ -86,7 +102,10 @@ namespace Quartz
 
 	public:
 		Heap()
-			: mpRoot(nullptr) {}
+			: mpRoot(nullptr), mSize(0) {}
+
+		explicit Heap(const AllocatorType& allocator)
+			: AllocatorStorage<AllocatorType>(allocator), mpRoot(nullptr), mSize(0) {}
 
 		/*
 		Heap(const HeapType& heap)
@@ -95,7 +114,7 @@ namespace Quartz
 
 		Type* Insert(USize key, const Type& value)
 		{
-			HeapNode* pNewNode = new HeapNode(key, value, nullptr, nullptr);
+			HeapNode* pNewNode = CreateNode(key, value);
 			mpRoot = MergeNodes(mpRoot, pNewNode);
 			++mSize;
 
@@ -113,7 +132,7 @@ namespace Quartz
 			{
 				HeapNode* pPrevRoot = mpRoot;
 				mpRoot = MergeChild(mpRoot->pChild);
-				delete pPrevRoot;
+				DestroyNode(pPrevRoot);
 
 				--mSize;
 			}
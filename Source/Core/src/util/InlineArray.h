@@ -0,0 +1,570 @@
+#pragma once
+
+#include "../Common.h"
+#include "../memory/Allocator.h"
+#include "Array.h"
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <utility>
+#include <type_traits>
+
+#include "../debug/Debug.h"
+
+namespace Quartz
+{
+	/*
+		An Array that stores up to inlineCount values in place and
+		only allocates from the heap once it grows beyond that.
+	*/
+	template<typename _ValueType, USize inlineCount, typename _Allocator = HeapAllocator>
+	class InlineArray : public AllocatorStorage<_Allocator>
+	{
+	public:
+		using ValueType = _ValueType;
+		using SizeType = USize;
+		using AllocatorType = _Allocator;
+		using ArrayType = InlineArray<_ValueType, inlineCount, _Allocator>;
+		using Iterator = typename Array<_ValueType>::Iterator;
+
+		constexpr static SizeType INLINE_COUNT = inlineCount;
+
+		static_assert(inlineCount > 0, "InlineArray requires an inline count greater than zero");
+
+	protected:
+		ValueType*	mpData;
+		SizeType	mSize;
+		SizeType	mCapacity;
+
+		alignas(ValueType) Byte mInline[inlineCount * sizeof(ValueType)];
+
+	protected:
+		SizeType NextSize(SizeType size)
+		{
+			return static_cast<SizeType>((static_cast<Float32>(size) * 1.5f) + 0.5f);
+		}
+
+		ValueType* InlineData()
+		{
+			return reinterpret_cast<ValueType*>(mInline);
+		}
+
+		Bool8 IsInline() const
+		{
+			return mpData == reinterpret_cast<const ValueType*>(mInline);
+		}
+
+		ValueType* AllocateData(SizeType capacity)
+		{
+			return static_cast<ValueType*>(this->GetAllocator().Allocate(capacity * sizeof(ValueType), alignof(ValueType)));
+		}
+
+		void FreeData(ValueType* pData, SizeType capacity)
+		{
+			this->GetAllocator().Free(pData, capacity * sizeof(ValueType));
+		}
+
+		/*
+			Moves count values from pSrc into uninitialized pDest, leaving pSrc
+			uninitialized. The ranges may overlap.
+		*/
+		static void Relocate(ValueType* pDest, ValueType* pSrc, SizeType count)
+		{
+			if constexpr (IsTriviallyRelocatable<ValueType>::value)
+			{
+				if (count > 0)
+				{
+					memmove(static_cast<void*>(pDest), pSrc, count * sizeof(ValueType));
+				}
+			}
+			else if (pDest < pSrc)
+			{
+				for (SizeType i = 0; i < count; i++)
+				{
+					new (&pDest[i]) ValueType(Move(pSrc[i]));
+					pSrc[i].~ValueType();
+				}
+			}
+			else if (pDest > pSrc)
+			{
+				for (SizeType i = count; i > 0; i--)
+				{
+					new (&pDest[i - 1]) ValueType(Move(pSrc[i - 1]));
+					pSrc[i - 1].~ValueType();
+				}
+			}
+		}
+
+		void ReserveImpl(SizeType capacity, SizeType offset = 0)
+		{
+			if (capacity <= INLINE_COUNT && mSize + offset <= INLINE_COUNT)
+			{
+				// Fits inline, move back from the heap if needed
+				if (!IsInline())
+				{
+					ValueType* pPrev = mpData;
+					mpData = InlineData();
+					Relocate(mpData + offset, pPrev, mSize);
+					FreeData(pPrev, mCapacity);
+				}
+				else if (offset > 0)
+				{
+					Relocate(mpData + offset, mpData, mSize);
+				}
+
+				mCapacity = INLINE_COUNT;
+				return;
+			}
+
+			if constexpr (IsTriviallyRelocatable<ValueType>::value)
+			{
+				if (offset == 0 && !IsInline())
+				{
+					mpData = static_cast<ValueType*>(this->GetAllocator().Reallocate(mpData,
+						mCapacity * sizeof(ValueType), capacity * sizeof(ValueType), alignof(ValueType)));
+					mCapacity = capacity;
+					return;
+				}
+			}
+
+			ValueType* pPrev = mpData;
+			mpData = AllocateData(capacity);
+
+			Relocate(mpData + offset, pPrev, mSize);
+
+			if (pPrev != InlineData())
+			{
+				FreeData(pPrev, mCapacity);
+			}
+
+			mCapacity = capacity;
+		}
+
+		template<typename... Args>
+		ValueType* EmplaceBackGrow(Args&&... args)
+		{
+			const SizeType capacity = NextSize(mCapacity);
+			ValueType* pNext = AllocateData(capacity);
+			ValueType* pValue = new (&pNext[mSize]) ValueType(std::forward<Args>(args)...);
+
+			Relocate(pNext, mpData, mSize);
+
+			if (!IsInline())
+			{
+				FreeData(mpData, mCapacity);
+			}
+
+			mpData = pNext;
+			mCapacity = capacity;
+			++mSize;
+
+			return pValue;
+		}
+
+		/* Takes the values of array, leaving it empty */
+		void TakeFrom(ArrayType& array)
+		{
+			if (array.IsInline())
+			{
+				Relocate(mpData, array.mpData, array.mSize);
+			}
+			else
+			{
+				// Heap memory is taken along with the allocator that owns it
+				this->GetAllocator() = array.GetAllocator();
+				mpData = array.mpData;
+				mCapacity = array.mCapacity;
+
+				array.mpData = array.InlineData();
+				array.mCapacity = INLINE_COUNT;
+			}
+
+			mSize = array.mSize;
+			array.mSize = 0;
+		}
+
+	public:
+		InlineArray()
+			: mpData(InlineData()), mSize(0), mCapacity(INLINE_COUNT) {}
+
+		explicit InlineArray(const AllocatorType& allocator)
+			: AllocatorStorage<AllocatorType>(allocator), mpData(InlineData()), mSize(0), mCapacity(INLINE_COUNT) {}
+
+		InlineArray(SizeType size, const AllocatorType& allocator = AllocatorType())
+			: InlineArray(allocator)
+		{
+			Resize(size);
+		}
+
+		InlineArray(SizeType size, const ValueType& value, const AllocatorType& allocator = AllocatorType())
+			: InlineArray(allocator)
+		{
+			Resize(size, value);
+		}
+
+		InlineArray(const ArrayType& array)
+			: InlineArray(array.GetAllocator())
+		{
+			Append(array.mpData, array.mSize);
+		}
+
+		InlineArray(ArrayType&& array) noexcept
+			: InlineArray(array.GetAllocator())
+		{
+			TakeFrom(array);
+		}
+
+		InlineArray(std::initializer_list<ValueType> list, const AllocatorType& allocator = AllocatorType())
+			: InlineArray(allocator)
+		{
+			Append(list.begin(), list.size());
+		}
+
+		~InlineArray()
+		{
+			Clear();
+
+			if (!IsInline())
+			{
+				FreeData(mpData, mCapacity);
+			}
+		}
+
+		ValueType* PushFront(const ValueType& value)
+		{
+			return EmplaceFront(value);
+		}
+
+		ValueType* PushFront(ValueType&& rValue)
+		{
+			return EmplaceFront(Move(rValue));
+		}
+
+		template<typename... Args>
+		ValueType* EmplaceFront(Args&&... args)
+		{
+			// Constructed first, args may reference values in this array
+			ValueType value(std::forward<Args>(args)...);
+
+			if (mSize + 1 > mCapacity)
+			{
+				// Reserve with offset of 1
+				// so that we dont need to move
+				// data again after resizing
+				ReserveImpl(NextSize(mCapacity), 1);
+			}
+			else
+			{
+				// Move all values right by one
+				Relocate(&mpData[1], &mpData[0], mSize);
+			}
+
+			++mSize;
+
+			// Construct at the beginning of the array
+			return new (&mpData[0]) ValueType(Move(value));
+		}
+
+		ValueType* PushBack(const ValueType& value)
+		{
+			return EmplaceBack(value);
+		}
+
+		ValueType* PushBack(ValueType&& rValue)
+		{
+			return EmplaceBack(Move(rValue));
+		}
+
+		/* Constructs a value in place at the end of the array */
+		template<typename... Args>
+		ValueType* EmplaceBack(Args&&... args)
+		{
+			if (mSize + 1 > mCapacity)
+			{
+				return EmplaceBackGrow(std::forward<Args>(args)...);
+			}
+
+			// Construct at the end of the array
+			return new (&mpData[mSize++]) ValueType(std::forward<Args>(args)...);
+		}
+
+		/* Copies count values to the end of the array */
+		void Append(const ValueType* pValues, SizeType count)
+		{
+			if (mSize + count > mCapacity)
+			{
+				// Values appended from this array move with it, the old block is freed
+				const Bool8 aliased = pValues >= mpData && pValues < mpData + mSize;
+				const SizeType offset = aliased ? static_cast<SizeType>(pValues - mpData) : 0;
+				const SizeType next = NextSize(mCapacity);
+
+				ReserveImpl(next > mSize + count ? next : mSize + count);
+
+				if (aliased)
+				{
+					pValues = mpData + offset;
+				}
+			}
+
+			if constexpr (std::is_trivially_copyable<ValueType>::value)
+			{
+				if (count > 0)
+				{
+					memcpy(&mpData[mSize], pValues, count * sizeof(ValueType));
+				}
+			}
+			else
+			{
+				for (SizeType i = 0; i < count; i++)
+				{
+					new (&mpData[mSize + i]) ValueType(pValues[i]);
+				}
+			}
+
+			mSize += count;
+		}
+
+		void Append(const ArrayType& array)
+		{
+			Append(array.mpData, array.mSize);
+		}
+
+		void PopBack()
+		{
+			if (mSize > 0)
+			{
+				Remove(mSize - 1);
+			}
+		}
+
+		void PopFront()
+		{
+			if (mSize > 0)
+			{
+				Remove(0);
+			}
+		}
+
+		void Remove(SizeType index)
+		{
+			if (index < mSize)
+			{
+				mpData[index].~ValueType();
+
+				// Move all values left by one
+				Relocate(&mpData[index], &mpData[index + 1], mSize - index - 1);
+				--mSize;
+			}
+		}
+
+		Bool8 Contains(const ValueType& value)
+		{
+			return IndexOf(value) != mSize;
+		}
+
+		// Returns size if index not found
+		SizeType IndexOf(const ValueType& value)
+		{
+			for (SizeType i = 0; i < mSize; i++)
+			{
+				if (mpData[i] == value)
+				{
+					return i;
+				}
+			}
+
+			return mSize;
+		}
+
+		void Resize(SizeType size)
+		{
+			if (size < mSize)
+			{
+				// Cannot resize smaller than mSize
+				return;
+			}
+
+			if (size > mCapacity)
+			{
+				// Size is larger than capacity, reserve more space
+				ReserveImpl(size);
+			}
+
+			for (SizeType i = mSize; i < size; i++)
+			{
+				// Construct new default-constructed value
+				new (&mpData[i]) ValueType();
+			}
+
+			mSize = size;
+		}
+
+		void Resize(SizeType size, const ValueType& value)
+		{
+			if (size > mSize)
+			{
+				if (size > mCapacity)
+				{
+					ReserveImpl(size);
+				}
+
+				for (SizeType i = mSize; i < size; i++)
+				{
+					// Construct new value with given initial value
+					new (&mpData[i]) ValueType(value);
+				}
+			}
+
+			else if (size < mSize)
+			{
+				for (SizeType i = size; i < mSize; i++)
+				{
+					// Destruct valid entries
+					mpData[i].~ValueType();
+				}
+			}
+
+			mSize = size;
+		}
+
+		/*
+			Resizes without constructing new values. Only for trivial
+			types, eg. buffers that are about to be overwritten.
+		*/
+		void ResizeNoInit(SizeType size)
+		{
+			static_assert(std::is_trivial<ValueType>::value, "ResizeNoInit requires a trivial ValueType");
+
+			if (size > mCapacity)
+			{
+				ReserveImpl(size);
+			}
+
+			mSize = size;
+		}
+
+		void Reserve(SizeType capacity)
+		{
+			if (capacity <= mCapacity)
+			{
+				return;
+			}
+
+			ReserveImpl(capacity);
+		}
+
+		void Shrink()
+		{
+			ReserveImpl(mSize);
+		}
+
+		void Clear()
+		{
+			for (SizeType i = 0; i < mSize; i++)
+			{
+				// Destruct valid entries
+				mpData[i].~ValueType();
+			}
+
+			mSize = 0;
+		}
+
+		ArrayType& operator=(const ArrayType& array)
+		{
+			if (this != &array)
+			{
+				Clear();
+				Append(array.mpData, array.mSize);
+			}
+
+			return *this;
+		}
+
+		ArrayType& operator=(ArrayType&& array) noexcept
+		{
+			if (this != &array)
+			{
+				Clear();
+
+				if (!array.IsInline() && !IsInline())
+				{
+					FreeData(mpData, mCapacity);
+					mpData = InlineData();
+					mCapacity = INLINE_COUNT;
+				}
+
+				TakeFrom(array);
+			}
+
+			return *this;
+		}
+
+		ArrayType& operator=(std::initializer_list<ValueType> list)
+		{
+			Clear();
+			Append(list.begin(), list.size());
+			return *this;
+		}
+
+		ValueType& operator[](SizeType index)
+		{
+			DEBUG_ASSERT(index < mSize && "Array index out of bounds!");
+			return mpData[index];
+		}
+
+		const ValueType& operator[](SizeType index) const
+		{
+			DEBUG_ASSERT(index < mSize && "Array index out of bounds!");
+			return mpData[index];
+		}
+
+		Iterator begin()
+		{
+			return Iterator(mpData);
+		}
+
+		Iterator end()
+		{
+			return Iterator(mpData + mSize);
+		}
+
+		////////////////////////////////
+
+		Iterator begin() const
+		{
+			return Iterator(mpData);
+		}
+
+		Iterator end() const
+		{
+			return Iterator(mpData + mSize);
+		}
+
+		////////////////////////////////
+
+		ValueType* Data()
+		{
+			return mpData;
+		}
+
+		const ValueType* Data() const
+		{
+			return mpData;
+		}
+
+		SizeType Size() const
+		{
+			return mSize;
+		}
+
+		SizeType Capacity() const
+		{
+			return mCapacity;
+		}
+
+		Bool8 IsEmpty() const
+		{
+			return mSize == 0;
+		}
+	};
+}
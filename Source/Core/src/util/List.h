@@ -1,10 +1,20 @@
 #pragma once
 
+#include "../Common.h"
+#include "../memory/Allocator.h"
+
+#include <new>
+#include <utility>
+
 namespace Quartz
 {
-	template<typename Type>
-	class List
+	template<typename Type, typename _Allocator = HeapAllocator>
+	class List : public AllocatorStorage<_Allocator>
 	{
+	public:
+		using AllocatorType = _Allocator;
+		using ListType = List<Type, _Allocator>;
+
 	private:
 		struct ListNode
 		{
@@ -22,59 +32,107 @@ namespace Quartz
 		ListNode* mpHead;
 		ListNode* mpTail;
 
-	public:
-		List()
-			: mpHead(nullptr) {}
-
-		List(const List& list)
-			: mpHead(list.mpHead) {}
-
-		void PushBack(const Type& value)
+		template<typename Value>
+		ListNode* CreateNode(Value&& value, ListNode* pLast, ListNode* pNext)
 		{
-			ListNode* pNewNode = new ListNode(value, mpTail, nullptr);
-
-			if (mpTail != nullptr)
-			{
-				mpTail->pNext = pNewNode;
-			}
+			void* pMemory = this->GetAllocator().Allocate(sizeof(ListNode), alignof(ListNode));
+			return new (pMemory) ListNode(std::forward<Value>(value), pLast, pNext);
+		}
 
-			mpTail = pNewNode;
+		void DestroyNode(ListNode* pNode)
+		{
+			pNode->~ListNode();
+			this->GetAllocator().Free(pNode, sizeof(ListNode));
 		}
 
-		void PushBack(Type&& value)
+		template<typename Value>
+		void PushBackImpl(Value&& value)
 		{
-			ListNode* pNewNode = new ListNode(Move(value), mpTail, nullptr);
+			ListNode* pNewNode = CreateNode(std::forward<Value>(value), mpTail, nullptr);
 
 			if (mpTail != nullptr)
 			{
 				mpTail->pNext = pNewNode;
 			}
+			else
+			{
+				mpHead = pNewNode;
+			}
 
 			mpTail = pNewNode;
 		}
 
-		void PushFront(const Type& value)
+		template<typename Value>
+		void PushFrontImpl(Value&& value)
 		{
-			ListNode* pNewNode = new ListNode(value, nullptr, mpHead);
+			ListNode* pNewNode = CreateNode(std::forward<Value>(value), nullptr, mpHead);
 
 			if (mpHead != nullptr)
 			{
 				mpHead->pLast = pNewNode;
 			}
+			else
+			{
+				mpTail = pNewNode;
+			}
 
 			mpHead = pNewNode;
 		}
 
-		void PushFront(Type&& value)
+	public:
+		List()
+			: mpHead(nullptr), mpTail(nullptr) {}
+
+		explicit List(const AllocatorType& allocator)
+			: AllocatorStorage<AllocatorType>(allocator), mpHead(nullptr), mpTail(nullptr) {}
+
+		List(const ListType& list)
+			: AllocatorStorage<AllocatorType>(list.GetAllocator()), mpHead(nullptr), mpTail(nullptr)
 		{
-			ListNode* pNewNode = new ListNode(Move(value), nullptr, mpHead);
+			for (ListNode* pNode = list.mpHead; pNode != nullptr; pNode = pNode->pNext)
+			{
+				PushBackImpl(pNode->value);
+			}
+		}
 
-			if (mpHead != nullptr)
+		~List()
+		{
+			Clear();
+		}
+
+		ListType& operator=(const ListType& list)
+		{
+			if (this != &list)
 			{
-				mpHead->pLast = pNewNode;
+				Clear();
+
+				for (ListNode* pNode = list.mpHead; pNode != nullptr; pNode = pNode->pNext)
+				{
+					PushBackImpl(pNode->value);
+				}
 			}
 
-			mpHead = pNewNode;
+			return *this;
+		}
+
+		void PushBack(const Type& value)
+		{
+			PushBackImpl(value);
+		}
+
+		void PushBack(Type&& value)
+		{
+			PushBackImpl(Move(value));
+		}
+
+		void PushFront(const Type& value)
+		{
+			PushFrontImpl(value);
+		}
+
+		void PushFront(Type&& value)
+		{
+			PushFrontImpl(Move(value));
 		}
 
 		void PopBack()
@@ -88,8 +146,12 @@ namespace Quartz
 				{
 					mpTail->pNext = nullptr;
 				}
+				else
+				{
+					mpHead = nullptr;
+				}
 
-				delete pOldHead;
+				DestroyNode(pOldTail);
 			}
 		}
 
@@ -104,8 +166,20 @@ namespace Quartz
 				{
 					mpHead->pLast = nullptr;
 				}
+				else
+				{
+					mpTail = nullptr;
+				}
+
+				DestroyNode(pOldHead);
+			}
+		}
 
-				delete pOldHead;
+		void Clear()
+		{
+			while (mpHead != nullptr)
+			{
+				PopFront();
 			}
 		}
 
@@ -119,4 +193,4 @@ namespace Quartz
 			return mpTail != nullptr ? &mpTail->value : nullptr;
 		}
 	};
-}
\ No newline at end of file
+}
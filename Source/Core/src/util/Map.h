@@ -2,9 +2,22 @@
 
 #include "../Common.h"
 #include "Table.h"
+#include "Utility.h"
+
+#include <type_traits>
 
 namespace Quartz
 {
+	/* Wraps a key or transparent lookup so it can be compared against a MapPair */
+	template<typename Lookup>
+	struct MapLookup
+	{
+		const Lookup& key;
+
+		explicit MapLookup(const Lookup& key)
+			: key(key) { }
+	};
+
 	template<typename _Key, typename _Value>
 	struct MapPair
 	{
@@ -54,17 +67,28 @@ namespace Quartz
 		{
 			return key != pair.key;
 		}
+
+		template<typename Lookup>
+		Bool8 operator==(const MapLookup<Lookup>& lookup)
+		{
+			return key == lookup.key;
+		}
 	};
 
-	template<typename _Key, typename _Value>
+	template<typename _Key, typename _Value, typename _Allocator = HeapAllocator>
 	class Map
 	{
 	public:
-		using MapType	= Map<_Key, _Value>;
-		using KeyType	= _Key;
-		using ValueType = _Value;
-		using PairType	= MapPair<KeyType, ValueType>;
-		using TableType = Table<PairType>;
+		using MapType		= Map<_Key, _Value, _Allocator>;
+		using KeyType		= _Key;
+		using ValueType		= _Value;
+		using AllocatorType	= _Allocator;
+		using PairType		= MapPair<KeyType, ValueType>;
+		using TableType		= Table<PairType, AllocatorType>;
+
+		/* Enabled when Lookup has a TransparentHash specialization for KeyType */
+		template<typename Lookup>
+		using TransparentType = typename TransparentHash<KeyType, std::decay_t<Lookup>>::LookupType;
 
 	private:
 		TableType mTable;
@@ -73,8 +97,11 @@ namespace Quartz
 		Map()
 			: mTable() {}
 
-		Map(UInt32 size)
-			: mTable(size) {}
+		explicit Map(const AllocatorType& allocator)
+			: mTable(allocator) {}
+
+		Map(UInt32 size, const AllocatorType& allocator = AllocatorType())
+			: mTable(size, allocator) {}
 
 		Map(const MapType& map)
 			: mTable(map.mTable) {}
@@ -117,6 +144,19 @@ namespace Quartz
 			return Put(key, ValueType());
 		}
 
+		template<typename Lookup, typename = TransparentType<Lookup>>
+		ValueType& operator[](const Lookup& key)
+		{
+			ValueType* pValue = Get(key);
+
+			if (pValue != nullptr)
+			{
+				return *pValue;
+			}
+
+			return Put(KeyType(key), ValueType());
+		}
+
 		typename TableType::Iterator begin()
 		{
 			return mTable.begin();
@@ -139,12 +179,49 @@ namespace Quartz
 
 		PairType* Find(const KeyType& key)
 		{
-			return mTable.Find(Hash(key), PairType(key));
+			return mTable.Find(Hash(key), MapLookup<KeyType>(key));
 		}
 
 		ValueType* Get(const KeyType& key)
 		{
-			PairType* pPair = mTable.Find(Hash(key), PairType(key));
+			PairType* pPair = mTable.Find(Hash(key), MapLookup<KeyType>(key));
+			return pPair == nullptr ? nullptr : &pPair->value;
+		}
+
+		/*
+			Transparent lookups probe the map without constructing a KeyType,
+			eg. Map<String, T>::Get("name") does not allocate a String.
+		*/
+
+		template<typename Lookup, typename = TransparentType<Lookup>>
+		PairType* Find(const Lookup& key)
+		{
+			using Transparent = TransparentHash<KeyType, std::decay_t<Lookup>>;
+			return mTable.Find(Transparent::Hash(key), MapLookup<Lookup>(key));
+		}
+
+		template<typename Lookup, typename = TransparentType<Lookup>>
+		ValueType* Get(const Lookup& key)
+		{
+			PairType* pPair = Find(key);
+			return pPair == nullptr ? nullptr : &pPair->value;
+		}
+
+		/*
+			Pre-hashed lookups. The hash must be equal to Hash<KeyType>()
+			of the equivalent key, allowing hashes to be cached by the caller.
+		*/
+
+		template<typename Lookup>
+		PairType* Find(UInt32 hash, const Lookup& key)
+		{
+			return mTable.Find(hash, MapLookup<Lookup>(key));
+		}
+
+		template<typename Lookup>
+		ValueType* Get(UInt32 hash, const Lookup& key)
+		{
+			PairType* pPair = mTable.Find(hash, MapLookup<Lookup>(key));
 			return pPair == nullptr ? nullptr : &pPair->value;
 		}
 
@@ -163,24 +240,52 @@ namespace Quartz
 			mTable.Clear();
 		}
 
+		void Remove(const KeyType& key)
+		{
+			mTable.Remove(Hash(key), MapLookup<KeyType>(key));
+		}
+
+		template<typename Lookup, typename = TransparentType<Lookup>>
+		void Remove(const Lookup& key)
+		{
+			using Transparent = TransparentHash<KeyType, std::decay_t<Lookup>>;
+			mTable.Remove(Transparent::Hash(key), MapLookup<Lookup>(key));
+		}
+
 		Bool8 Contains(const KeyType& key)
 		{
-			return mTable.Contains(Hash(key), PairType(key));
+			return mTable.Contains(Hash(key), MapLookup<KeyType>(key));
+		}
+
+		template<typename Lookup, typename = TransparentType<Lookup>>
+		Bool8 Contains(const Lookup& key)
+		{
+			using Transparent = TransparentHash<KeyType, std::decay_t<Lookup>>;
+			return mTable.Contains(Transparent::Hash(key), MapLookup<Lookup>(key));
+		}
+
+		template<typename Lookup>
+		Bool8 Contains(UInt32 hash, const Lookup& key)
+		{
+			return mTable.Contains(hash, MapLookup<Lookup>(key));
 		}
 
 		UInt32 Size() const
 		{
-			return mTable.mSize;
+			return mTable.Size();
 		}
 
 		UInt32 Capacity() const
 		{
-			return mTable.mCapacity;
+			return mTable.Capacity();
 		}
 
 		UInt32 Threshold() const
 		{
-			return mTable.mThreshold;
+			return mTable.Threshold();
 		}
 	};
+
+	template<typename KeyType, typename ValueType, typename AllocatorType>
+	struct IsTriviallyRelocatable<Map<KeyType, ValueType, AllocatorType>> : public IsTriviallyRelocatable<AllocatorType> {};
 }
\ No newline at end of file
@@ -0,0 +1,274 @@
+#pragma once
+
+#include "../Common.h"
+#include "../memory/Allocator.h"
+#include "Hash.h"
+#include "Map.h"
+#include "String.h"
+
+#include <atomic>
+#include <mutex>
+#include <new>
+#include <shared_mutex>
+
+namespace Quartz
+{
+	/*
+		Interned strings, indexed by a 32 bit id. Each distinct string is
+		copied once into chunked storage and is never moved or released, so
+		views returned by GetView stay valid for the life of the table.
+
+		Lookups are split across shards by hash, each guarded by a shared
+		mutex, so threads only contend when interning into the same shard.
+		Id 0 is always the empty string.
+	*/
+	class NameTable
+	{
+	public:
+		static constexpr UInt32 SHARD_COUNT = 16;
+		static constexpr UInt32 PAGE_SIZE	= 1024;
+		static constexpr UInt32 MAX_PAGES	= 4096;
+		static constexpr USize	CHUNK_SIZE	= 16 * 1024;
+
+	private:
+		struct Chunk
+		{
+			Chunk*	pNext;
+			USize	size;
+		};
+
+		struct Shard
+		{
+			std::shared_mutex		lock;
+			Map<StringView, UInt32>	ids;
+			Chunk*					pChunks = nullptr;
+			USize					chunkOffset = CHUNK_SIZE;
+		};
+
+		Shard						mShards[SHARD_COUNT];
+		std::atomic<StringView*>	mpPages[MAX_PAGES];
+		std::atomic<UInt32>			mNextId;
+		std::mutex					mPageLock;
+
+		/* Copies str into the shard's chunks, called with the shard locked */
+		static const Char* CopyString(Shard& shard, StringView str)
+		{
+			const USize size = str.Length() + 1;
+
+			if (shard.chunkOffset + size > CHUNK_SIZE)
+			{
+				const USize dataSize = size > CHUNK_SIZE ? size : CHUNK_SIZE;
+				Chunk* pChunk = static_cast<Chunk*>(GetHeapAllocator()->Allocate(sizeof(Chunk) + dataSize, alignof(Chunk)));
+
+				pChunk->pNext = shard.pChunks;
+				pChunk->size = sizeof(Chunk) + dataSize;
+
+				shard.pChunks = pChunk;
+				shard.chunkOffset = 0;
+			}
+
+			Char* pStr = reinterpret_cast<Char*>(shard.pChunks + 1) + shard.chunkOffset;
+			memcpy(pStr, str.Str(), str.Length() * sizeof(Char));
+			pStr[str.Length()] = '\0';
+
+			shard.chunkOffset += size;
+
+			return pStr;
+		}
+
+		StringView* GetPage(UInt32 page)
+		{
+			StringView* pPage = mpPages[page].load(std::memory_order_acquire);
+
+			if (pPage == nullptr)
+			{
+				std::lock_guard<std::mutex> guard(mPageLock);
+				pPage = mpPages[page].load(std::memory_order_relaxed);
+
+				if (pPage == nullptr)
+				{
+					void* pMemory = GetHeapAllocator()->Allocate(PAGE_SIZE * sizeof(StringView), alignof(StringView));
+					pPage = new (pMemory) StringView[PAGE_SIZE];
+					mpPages[page].store(pPage, std::memory_order_release);
+				}
+			}
+
+			return pPage;
+		}
+
+		FORCE_INLINE Shard& ShardOf(UInt32 hash)
+		{
+			// Map buckets use the low bits, shard on the high ones
+			return mShards[hash >> 28];
+		}
+
+	public:
+		NameTable()
+			: mNextId(1)
+		{
+			static_assert(SHARD_COUNT == 16, "ShardOf assumes 16 shards");
+
+			for (UInt32 i = 0; i < MAX_PAGES; i++)
+			{
+				mpPages[i].store(nullptr, std::memory_order_relaxed);
+			}
+
+			GetPage(0)[0] = StringView();
+		}
+
+		NameTable(const NameTable&) = delete;
+		NameTable& operator=(const NameTable&) = delete;
+
+		~NameTable()
+		{
+			for (Shard& shard : mShards)
+			{
+				Chunk* pChunk = shard.pChunks;
+
+				while (pChunk != nullptr)
+				{
+					Chunk* pNext = pChunk->pNext;
+					GetHeapAllocator()->Free(pChunk, pChunk->size);
+					pChunk = pNext;
+				}
+			}
+
+			for (UInt32 i = 0; i < MAX_PAGES; i++)
+			{
+				StringView* pPage = mpPages[i].load(std::memory_order_relaxed);
+
+				if (pPage != nullptr)
+				{
+					GetHeapAllocator()->Free(pPage, PAGE_SIZE * sizeof(StringView));
+				}
+			}
+		}
+
+		/* Returns the id of str, adding it to the table if it is new */
+		UInt32 Intern(StringView str)
+		{
+			if (str.IsEmpty())
+			{
+				return 0;
+			}
+
+			const UInt32 hash = Hash<StringView>(str);
+			Shard& shard = ShardOf(hash);
+
+			{
+				std::shared_lock<std::shared_mutex> readGuard(shard.lock);
+				const MapPair<StringView, UInt32>* pPair = shard.ids.Find(hash, str);
+
+				if (pPair != nullptr)
+				{
+					return pPair->value;
+				}
+			}
+
+			std::unique_lock<std::shared_mutex> writeGuard(shard.lock);
+			const MapPair<StringView, UInt32>* pPair = shard.ids.Find(hash, str);
+
+			if (pPair != nullptr)
+			{
+				return pPair->value;
+			}
+
+			const UInt32 id = mNextId.fetch_add(1, std::memory_order_relaxed);
+			DEBUG_ASSERT(id < PAGE_SIZE * MAX_PAGES && "NameTable is full!");
+
+			const StringView stored(CopyString(shard, str), str.Length());
+			GetPage(id / PAGE_SIZE)[id % PAGE_SIZE] = stored;
+			shard.ids.Put(stored, id);
+
+			return id;
+		}
+
+		/* Finds the id of str without adding it, returns false if str was never interned */
+		Bool8 Find(StringView str, UInt32& id)
+		{
+			if (str.IsEmpty())
+			{
+				id = 0;
+				return true;
+			}
+
+			const UInt32 hash = Hash<StringView>(str);
+			Shard& shard = ShardOf(hash);
+
+			std::shared_lock<std::shared_mutex> readGuard(shard.lock);
+			const MapPair<StringView, UInt32>* pPair = shard.ids.Find(hash, str);
+
+			if (pPair != nullptr)
+			{
+				id = pPair->value;
+				return true;
+			}
+
+			return false;
+		}
+
+		/* The interned string of id, null-terminated */
+		FORCE_INLINE StringView GetView(UInt32 id) const
+		{
+			return mpPages[id / PAGE_SIZE].load(std::memory_order_acquire)[id % PAGE_SIZE];
+		}
+
+		UInt32 Count() const
+		{
+			return mNextId.load(std::memory_order_relaxed);
+		}
+	};
+
+	/*
+		The process wide NameTable. Defined by the Engine module so every
+		module linked against it resolves strings to the same ids.
+	*/
+	QUARTZ_API NameTable& GetNameTable();
+
+	/*
+		A string interned in the global NameTable. Constructing a Name hashes
+		the string once, after which copies compare and hash by id only.
+	*/
+	class Name
+	{
+	private:
+		UInt32 mId;
+
+	public:
+		constexpr Name()
+			: mId(0) { }
+
+		Name(StringView str)
+			: mId(GetNameTable().Intern(str)) { }
+
+		Name(const Char* str)
+			: Name(StringView(str)) { }
+
+		Name(const String& str)
+			: Name(StringView(str)) { }
+
+		/* Returns the existing Name of str, or the empty Name if str was never interned */
+		static Name Find(StringView str)
+		{
+			Name name;
+			GetNameTable().Find(str, name.mId);
+			return name;
+		}
+
+		FORCE_INLINE UInt32 GetId() const { return mId; }
+		FORCE_INLINE Bool8 IsEmpty() const { return mId == 0; }
+
+		FORCE_INLINE StringView View() const { return GetNameTable().GetView(mId); }
+		FORCE_INLINE const Char* Str() const { return View().Str(); }
+		FORCE_INLINE USize Length() const { return View().Length(); }
+
+		FORCE_INLINE Bool8 operator==(const Name& name) const { return mId == name.mId; }
+		FORCE_INLINE Bool8 operator!=(const Name& name) const { return mId != name.mId; }
+	};
+
+	template<>
+	FORCE_INLINE UInt32 Hash<Name>(const Name& value)
+	{
+		return Hash<UInt32>(value.GetId());
+	}
+}
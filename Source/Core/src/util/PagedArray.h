@@ -0,0 +1,216 @@
+#pragma once
+
+#include "../Common.h"
+#include "../memory/Allocator.h"
+#include "Array.h"
+
+#include <cstring>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace Quartz
+{
+	/*
+		Array stored in fixed-size pages. Values are not moved by growth,
+		which only allocates a new page instead of relocating every value.
+		Pages are kept when values are popped and reused by later pushes.
+	*/
+	template<typename _ValueType, USize pageSize = 1024>
+	class PagedArray
+	{
+	public:
+		static_assert((pageSize & (pageSize - 1)) == 0, "PagedArray page size must be a power of two");
+
+		using ValueType = _ValueType;
+		using SizeType = USize;
+
+		constexpr static USize PAGE_SIZE = pageSize;
+		constexpr static USize PAGE_ALIGN = alignof(ValueType) > DEFAULT_ALIGNMENT ? alignof(ValueType) : DEFAULT_ALIGNMENT;
+		constexpr static USize PAGE_BYTES = (sizeof(ValueType) * PAGE_SIZE + PAGE_ALIGN - 1) & ~(PAGE_ALIGN - 1);
+
+		class Iterator
+		{
+		private:
+			PagedArray*	pArray;
+			SizeType	index;
+
+		public:
+			Iterator()
+				: pArray(nullptr), index(0) { }
+
+			Iterator(PagedArray* pArray, SizeType index)
+				: pArray(pArray), index(index) { }
+
+			Iterator& operator++()
+			{
+				++index;
+				return *this;
+			}
+
+			Iterator operator++(int)
+			{
+				Iterator temp(*this);
+				++index;
+				return temp;
+			}
+
+			Bool8 operator==(const Iterator& it) const
+			{
+				return index == it.index;
+			}
+
+			Bool8 operator!=(const Iterator& it) const
+			{
+				return index != it.index;
+			}
+
+			ValueType& operator*()
+			{
+				return (*pArray)[index];
+			}
+
+			ValueType* operator->()
+			{
+				return &(*pArray)[index];
+			}
+		};
+
+	private:
+		Array<ValueType*>	mPages;
+		SizeType			mSize;
+
+	private:
+		ValueType* NextSlot()
+		{
+			if (mSize == mPages.Size() * PAGE_SIZE)
+			{
+				mPages.PushBack(static_cast<ValueType*>(AlignedAllocate(PAGE_BYTES, PAGE_ALIGN)));
+			}
+
+			return &(*this)[mSize++];
+		}
+
+	public:
+		PagedArray()
+			: mPages(), mSize(0) {}
+
+		PagedArray(const PagedArray&) = delete;
+		PagedArray& operator=(const PagedArray&) = delete;
+
+		~PagedArray()
+		{
+			Clear();
+
+			for (ValueType* pPage : mPages)
+			{
+				AlignedFree(pPage);
+			}
+		}
+
+		template<typename Value>
+		ValueType* PushBack(Value&& value)
+		{
+			return new (NextSlot()) ValueType(std::forward<Value>(value));
+		}
+
+		/* Copies count values to the end of the array, a page at a time */
+		void Append(const ValueType* pValues, SizeType count)
+		{
+			Reserve(mSize + count);
+
+			while (count > 0)
+			{
+				const SizeType offset = mSize & (PAGE_SIZE - 1);
+				const SizeType chunk = PAGE_SIZE - offset < count ? PAGE_SIZE - offset : count;
+				ValueType* pDest = &mPages[mSize / PAGE_SIZE][offset];
+
+				if constexpr (std::is_trivially_copyable<ValueType>::value)
+				{
+					memcpy(pDest, pValues, chunk * sizeof(ValueType));
+				}
+				else
+				{
+					for (SizeType i = 0; i < chunk; i++)
+					{
+						new (&pDest[i]) ValueType(pValues[i]);
+					}
+				}
+
+				mSize += chunk;
+				pValues += chunk;
+				count -= chunk;
+			}
+		}
+
+		void PopBack()
+		{
+			if (mSize > 0)
+			{
+				(*this)[--mSize].~ValueType();
+			}
+		}
+
+		/* Grows by copies of value or shrinks to size values */
+		void Resize(SizeType size, const ValueType& value)
+		{
+			Reserve(size);
+
+			while (mSize < size)
+			{
+				new (&(*this)[mSize++]) ValueType(value);
+			}
+
+			while (mSize > size)
+			{
+				PopBack();
+			}
+		}
+
+		/* Destroys every value, pages are kept */
+		void Clear()
+		{
+			while (mSize > 0)
+			{
+				PopBack();
+			}
+		}
+
+		/* Allocates pages for at least capacity values */
+		void Reserve(SizeType capacity)
+		{
+			while (mPages.Size() * PAGE_SIZE < capacity)
+			{
+				mPages.PushBack(static_cast<ValueType*>(AlignedAllocate(PAGE_BYTES, PAGE_ALIGN)));
+			}
+		}
+
+		FORCE_INLINE ValueType& operator[](SizeType index)
+		{
+			return mPages[index / PAGE_SIZE][index & (PAGE_SIZE - 1)];
+		}
+
+		FORCE_INLINE const ValueType& operator[](SizeType index) const
+		{
+			return mPages[index / PAGE_SIZE][index & (PAGE_SIZE - 1)];
+		}
+
+		FORCE_INLINE ValueType* GetPage(SizeType page) { return mPages[page]; }
+		FORCE_INLINE SizeType GetPageCount() const { return mPages.Size(); }
+
+		Iterator begin()
+		{
+			return Iterator(this, 0);
+		}
+
+		Iterator end()
+		{
+			return Iterator(this, mSize);
+		}
+
+		SizeType Size() const
+		{
+			return mSize;
+		}
+	};
+}
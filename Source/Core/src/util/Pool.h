@@ -1,34 +1,39 @@
 #pragma once
 #include "../Common.h"
 #include "../debug/Debug.h"
+#include "../memory/Allocator.h"
 
 #include "Array.h"
-#include "Stack.h"
-#include "Map.h"
+#include "Utils.h"
+
+#include <new>
+#include <utility>
 
 namespace Quartz
 {
-	template<typename Type, UInt32 SIZE>
-	class PoolBlock
+	/* Generation-checked reference to a pool slot. A default handle is never valid. */
+	struct PoolHandle
 	{
-	private:
-		union
-		{
-			Type mValues[SIZE];
-			char mData[SIZE * sizeof(Type)];
-		};
+		UInt32 index;
+		UInt32 generation;
 
-	public:
-		PoolBlock();
+		PoolHandle()
+			: index(0), generation(0) { }
 
-		Type* CreateNoInit(UInt32 index);
+		PoolHandle(UInt32 index, UInt32 generation)
+			: index(index), generation(generation) { }
 
-		template<typename... Args>
-		Type* Create(UInt32 index, Args&&... args);
+		FORCE_INLINE Bool8 IsNull() const { return generation == 0; }
 
-		void Free(UInt32 index);
+		FORCE_INLINE Bool8 operator==(const PoolHandle& handle) const
+		{
+			return index == handle.index && generation == handle.generation;
+		}
 
-		Type& operator[](UInt32 index);
+		FORCE_INLINE Bool8 operator!=(const PoolHandle& handle) const
+		{
+			return !(*this == handle);
+		}
 	};
 
 	class IPool
@@ -39,55 +44,206 @@ namespace Quartz
 		virtual void Free(void* pType) = 0;
 	};
 
+	/*
+		Object pool with stable addresses. Blocks are aligned to their own
+		power-of-two size, so the block owning a pointer is found by masking
+		the address. Unused slots are chained into an intrusive free list and
+		each block keeps an occupancy bitmap that iteration scans word by word.
+
+		BLOCK_SIZE is the minimum number of slots per block. Blocks are
+		rounded up to a power of two and the slack holds extra slots.
+	*/
 	template<typename Type, UInt32 BLOCK_SIZE = 1024U>
 	class Pool : public IPool
 	{
+	private:
+		struct alignas(alignof(Type) > alignof(void*) ? alignof(Type) : alignof(void*)) Slot
+		{
+			Byte data[sizeof(Type) > sizeof(void*) ? sizeof(Type) : sizeof(void*)];
+		};
+
+		constexpr static USize SLOT_SIZE = sizeof(Slot);
+		constexpr static USize SLOT_ALIGN = alignof(Slot);
+
+		/* Block index, occupancy bitmap and generations */
+		constexpr static USize HeaderSize(USize slotCount)
+		{
+			return (8 + ((slotCount + 63) / 64) * 8 + slotCount * 4 + 7) & ~static_cast<USize>(7);
+		}
+
+		constexpr static USize SlotOffset(USize slotCount)
+		{
+			return (HeaderSize(slotCount) + SLOT_ALIGN - 1) & ~(SLOT_ALIGN - 1);
+		}
+
+		constexpr static USize ComputeBlockBytes()
+		{
+			const USize bytes = SlotOffset(BLOCK_SIZE) + BLOCK_SIZE * SLOT_SIZE;
+			USize blockBytes = 1;
+
+			while (blockBytes < bytes)
+			{
+				blockBytes <<= 1;
+			}
+
+			return blockBytes;
+		}
+
+		constexpr static USize ComputeSlotCount(USize blockBytes)
+		{
+			// Each slot also costs 4 bytes of generation and one bit of bitmap
+			USize count = ((blockBytes - 16 - SLOT_ALIGN) * 8) / (SLOT_SIZE * 8 + 33);
+
+			while (SlotOffset(count + 1) + (count + 1) * SLOT_SIZE <= blockBytes)
+			{
+				count++;
+			}
+
+			while (SlotOffset(count) + count * SLOT_SIZE > blockBytes)
+			{
+				count--;
+			}
+
+			return count;
+		}
+
+	public:
+		constexpr static USize BLOCK_BYTES = ComputeBlockBytes();
+		constexpr static UInt32 SLOTS_PER_BLOCK = static_cast<UInt32>(ComputeSlotCount(BLOCK_BYTES));
+
+	private:
+		constexpr static UInt32 BITMAP_WORDS = (SLOTS_PER_BLOCK + 63) / 64;
+		constexpr static USize SLOT_OFFSET = SlotOffset(SLOTS_PER_BLOCK);
+
+		struct Block
+		{
+			UInt32	index;
+			UInt32	reserved;
+			UInt64	occupied[BITMAP_WORDS];
+			UInt32	generations[SLOTS_PER_BLOCK];
+		};
+
+		static_assert(sizeof(Block) <= SLOT_OFFSET, "Pool block header overlaps its slots!");
+		static_assert(SLOTS_PER_BLOCK >= BLOCK_SIZE, "Pool block is too small!");
+
 	public:
 		class Iterator
 		{
 		private:
-			typename Map<UInt64, UInt32>::Iterator pItr;
+			Block* const*	mppBlock;
+			Block* const*	mppEnd;
+			UInt32			mWord;
+			UInt64			mBits;
+
+			/* Moves to the next live slot once the current word is used up */
+			void SkipEmpty()
+			{
+				while (mBits == 0)
+				{
+					if (++mWord == BITMAP_WORDS)
+					{
+						if (++mppBlock == mppEnd)
+						{
+							mWord = 0;
+							return;
+						}
+
+						mWord = 0;
+					}
+
+					mBits = (*mppBlock)->occupied[mWord];
+				}
+			}
 
 		public:
-			Iterator(typename Map<UInt64, UInt32>::Iterator itr);
-			Iterator(const Iterator& it);
-			Iterator(Iterator&& it) noexcept;
-
-			Iterator& operator++();
-			Iterator operator++(int);
+			Iterator(Block* const* ppBlock, Block* const* ppEnd)
+				: mppBlock(ppBlock), mppEnd(ppEnd), mWord(0), mBits(0)
+			{
+				if (mppBlock != mppEnd)
+				{
+					mBits = (*mppBlock)->occupied[0];
+					SkipEmpty();
+				}
+			}
+
+			Iterator& operator++()
+			{
+				mBits &= mBits - 1;
+				SkipEmpty();
+				return *this;
+			}
+
+			Iterator operator++(int)
+			{
+				Iterator temp(*this);
+				++(*this);
+				return temp;
+			}
+
+			Bool8 operator==(const Iterator& it) const
+			{
+				return mppBlock == it.mppBlock && mWord == it.mWord && mBits == it.mBits;
+			}
+
+			Bool8 operator!=(const Iterator& it) const
+			{
+				return !(*this == it);
+			}
+
+			Type& operator*()
+			{
+				const UInt32 slotIndex = mWord * 64 + CountTrailingZeros64(mBits);
+				return *reinterpret_cast<Type*>(Slots(*mppBlock) + slotIndex);
+			}
+
+			Type* operator->()
+			{
+				return &**this;
+			}
+		};
 
-			Bool8 operator==(const Iterator& it) const;
-			Bool8 operator!=(const Iterator& it) const;
-			Bool8 operator>=(const Iterator& it) const;
-			Bool8 operator<=(const Iterator& it) const;
-			Bool8 operator>(const Iterator& it) const;
-			Bool8 operator<(const Iterator& it) const;
+	private:
+		Array<Block*>	mBlocks;
+		Slot*			mpFreeList;
+		UInt32			mUsed;
+		UInt32			mCapacity;
 
-			Iterator& operator=(const Iterator& it);
+		FORCE_INLINE static Slot* Slots(Block* pBlock)
+		{
+			return reinterpret_cast<Slot*>(reinterpret_cast<Byte*>(pBlock) + SLOT_OFFSET);
+		}
 
-			Type& operator*();
-			Type* operator->();
-		};
+		FORCE_INLINE static Block* BlockOf(const void* pValue)
+		{
+			return reinterpret_cast<Block*>(reinterpret_cast<USize>(pValue) & ~(BLOCK_BYTES - 1));
+		}
 
-	private:
-		Array<PoolBlock<Type, BLOCK_SIZE>*> mBlocks;
-		UInt32 mUsed;
-		UInt32 mCapacity;
+		FORCE_INLINE static Slot*& NextFree(Slot* pSlot)
+		{
+			return *reinterpret_cast<Slot**>(pSlot);
+		}
 
-		Map<UInt64, UInt32> mPtrIndexMap;
+		FORCE_INLINE static Bool8 IsOccupied(const Block* pBlock, UInt32 slotIndex)
+		{
+			return (pBlock->occupied[slotIndex >> 6] >> (slotIndex & 63)) & 1;
+		}
 
-		Stack<UInt32> mFreeIndices;
-		UInt32 mMaxIndex;
+		void AllocateBlock();
+		Slot* AcquireSlot();
+		void ReleaseSlot(Block* pBlock, UInt32 slotIndex);
 
-		UInt32 NextIndex();
+		Bool8 Owns(const Block* pBlock) const;
 
 	public:
 		Pool();
-		Pool(const Pool& pool);
-		Pool(Pool&& pool);
+		Pool(const Pool& pool) = delete;
+		Pool(Pool&& pool) noexcept;
 
 		~Pool();
 
+		Pool& operator=(const Pool& pool) = delete;
+
+		/* Returns uninitialized memory for a Type, still released by Free */
 		Type* CreateNoInit();
 
 		template<typename... Args>
@@ -95,255 +251,232 @@ namespace Quartz
 
 		void Free(void* pType) override;
 
+		/* Destroys every live value, blocks are kept for reuse */
+		void Clear();
+
+		PoolHandle GetHandle(const Type* pValue) const;
+
+		/* Returns nullptr if the handle's value has been freed */
+		Type* Get(PoolHandle handle);
+
+		Bool8 IsValid(PoolHandle handle) const;
+
+		/* Frees the handle's value, stale handles are ignored */
+		void Free(PoolHandle handle);
+
 		Iterator begin();
 		Iterator end();
 
 		FORCE_INLINE UInt32 GetUsed() { return mUsed; }
 		FORCE_INLINE UInt32 GetCapacity() { return mCapacity; }
-		FORCE_INLINE UInt32 GetBlockCount() { return mCapacity / BLOCK_SIZE; }
+		FORCE_INLINE UInt32 GetBlockCount() { return mBlocks.Size(); }
 	};
 
-	template<typename Type, UInt32 SIZE>
-	PoolBlock<Type, SIZE>::PoolBlock()
-		: mData{}
-	{
-		// Nothing
-	}
-
 	template<typename Type, UInt32 BLOCK_SIZE>
-	Pool<Type, BLOCK_SIZE>::Iterator::Iterator(typename Map<UInt64, UInt32>::Iterator itr)
-		: pItr(itr)
+	void Pool<Type, BLOCK_SIZE>::AllocateBlock()
 	{
-		// Nothing
-	}
+		Block* pBlock = static_cast<Block*>(AlignedAllocate(BLOCK_BYTES, BLOCK_BYTES));
 
-	template<typename Type, UInt32 BLOCK_SIZE>
-	Pool<Type, BLOCK_SIZE>::Iterator::Iterator(const Iterator& it)
-		: pItr(it.pItr)
-	{
-		// Nothing
-	}
+		pBlock->index = mBlocks.Size();
+		pBlock->reserved = 0;
+		memset(pBlock->occupied, 0, sizeof(pBlock->occupied));
 
-	template<typename Type, UInt32 BLOCK_SIZE>
-	Pool<Type, BLOCK_SIZE>::Iterator::Iterator(Iterator&& it) noexcept
-		: pItr(it.pItr)
-	{
-		// Nothing
-	}
+		for (UInt32 i = 0; i < SLOTS_PER_BLOCK; i++)
+		{
+			pBlock->generations[i] = 1;
+		}
 
-	template<typename Type, UInt32 BLOCK_SIZE>
-	typename Pool<Type, BLOCK_SIZE>::Iterator& Pool<Type, BLOCK_SIZE>::Iterator::operator++()
-	{
-		++pItr;
-		return *this;
-	}
+		// Chain the new slots in address order so they are handed out sequentially
+		Slot* pSlots = Slots(pBlock);
 
-	template<typename Type, UInt32 BLOCK_SIZE>
-	typename Pool<Type, BLOCK_SIZE>::Iterator Pool<Type, BLOCK_SIZE>::Iterator::operator++(int)
-	{
-		Pool<Type, BLOCK_SIZE>::Iterator temp(*this);
-		++pItr;
-		return temp;
-	}
+		for (UInt32 i = 0; i < SLOTS_PER_BLOCK - 1; i++)
+		{
+			NextFree(&pSlots[i]) = &pSlots[i + 1];
+		}
 
-	template<typename Type, UInt32 BLOCK_SIZE>
-	Bool8 Pool<Type, BLOCK_SIZE>::Iterator::operator==(const Iterator& it) const
-	{
-		return pItr == it.pItr;
-	}
+		NextFree(&pSlots[SLOTS_PER_BLOCK - 1]) = mpFreeList;
+		mpFreeList = pSlots;
 
-	template<typename Type, UInt32 BLOCK_SIZE>
-	Bool8 Pool<Type, BLOCK_SIZE>::Iterator::operator!=(const Iterator& it) const
-	{
-		return pItr != it.pItr;
+		mBlocks.PushBack(pBlock);
+		mCapacity += SLOTS_PER_BLOCK;
 	}
 
 	template<typename Type, UInt32 BLOCK_SIZE>
-	Bool8 Pool<Type, BLOCK_SIZE>::Iterator::operator>=(const Iterator& it) const
+	typename Pool<Type, BLOCK_SIZE>::Slot* Pool<Type, BLOCK_SIZE>::AcquireSlot()
 	{
-		return pItr >= it.pItr;
-	}
+		if (mpFreeList == nullptr)
+		{
+			AllocateBlock();
+		}
 
-	template<typename Type, UInt32 BLOCK_SIZE>
-	Bool8 Pool<Type, BLOCK_SIZE>::Iterator::operator<=(const Iterator& it) const
-	{
-		return pItr <= it.pItr;
-	}
+		Slot* pSlot = mpFreeList;
+		mpFreeList = NextFree(pSlot);
 
-	template<typename Type, UInt32 BLOCK_SIZE>
-	Bool8 Pool<Type, BLOCK_SIZE>::Iterator::operator>(const Iterator& it) const
-	{
-		return pItr > it.pItr;
-	}
+		Block* pBlock = BlockOf(pSlot);
+		const UInt32 slotIndex = static_cast<UInt32>(pSlot - Slots(pBlock));
+		pBlock->occupied[slotIndex >> 6] |= 1ull << (slotIndex & 63);
 
-	template<typename Type, UInt32 BLOCK_SIZE>
-	Bool8 Pool<Type, BLOCK_SIZE>::Iterator::operator<(const Iterator& it) const
-	{
-		return pItr < it.pItr;
-	}
+		++mUsed;
 
-	template<typename Type, UInt32 BLOCK_SIZE>
-	typename Pool<Type, BLOCK_SIZE>::Iterator& Pool<Type, BLOCK_SIZE>::Iterator::operator=(const Iterator& it)
-	{
-		pItr = it.pItr;
-		return *this;
+		return pSlot;
 	}
 
 	template<typename Type, UInt32 BLOCK_SIZE>
-	Type& Pool<Type, BLOCK_SIZE>::Iterator::operator*()
+	void Pool<Type, BLOCK_SIZE>::ReleaseSlot(Block* pBlock, UInt32 slotIndex)
 	{
-		return *reinterpret_cast<Type*>(pItr->key);
-	}
+		Slot* pSlot = Slots(pBlock) + slotIndex;
 
-	template<typename Type, UInt32 BLOCK_SIZE>
-	Type* Pool<Type, BLOCK_SIZE>::Iterator::operator->()
-	{
-		return (pItr->key);
-	}
+		pBlock->occupied[slotIndex >> 6] &= ~(1ull << (slotIndex & 63));
 
-	template<typename Type, UInt32 SIZE>
-	void PoolBlock<Type, SIZE>::Free(UInt32 index)
-	{
-		DEBUG_ASSERT(index < SIZE && "SubPool index out of bounds!");
+		// Generation 0 is reserved for null handles
+		if (++pBlock->generations[slotIndex] == 0)
+		{
+			pBlock->generations[slotIndex] = 1;
+		}
 
-		mValues[index].~Type();
-	}
+		NextFree(pSlot) = mpFreeList;
+		mpFreeList = pSlot;
 
-	template<typename Type, UInt32 SIZE>
-	Type& PoolBlock<Type, SIZE>::operator[](UInt32 index)
-	{
-		DEBUG_ASSERT(index < SIZE && "SubPool index out of bounds!");
-		return mValues[index];
+		--mUsed;
 	}
 
-	template<typename Type, UInt32 SIZE>
-	Type* PoolBlock<Type, SIZE>::CreateNoInit(UInt32 index)
+	template<typename Type, UInt32 BLOCK_SIZE>
+	Bool8 Pool<Type, BLOCK_SIZE>::Owns(const Block* pBlock) const
 	{
-		return mValues + index;
+		return pBlock->index < mBlocks.Size() && mBlocks[pBlock->index] == pBlock;
 	}
 
-	template<typename Type, UInt32 SIZE>
-	template<typename ...Args>
-	Type* PoolBlock<Type, SIZE>::Create(UInt32 index, Args&&... args)
+	template<typename Type, UInt32 BLOCK_SIZE>
+	Pool<Type, BLOCK_SIZE>::Pool()
+		: mpFreeList(nullptr), mUsed(0), mCapacity(0)
 	{
-		DEBUG_ASSERT(index < SIZE && "SubPool index out of bounds!");
-		return new (mValues + index) Type(std::forward<Args>(args)...);
+		// Nothing
 	}
 
 	template<typename Type, UInt32 BLOCK_SIZE>
-	UInt32 Pool<Type, BLOCK_SIZE>::NextIndex()
+	Pool<Type, BLOCK_SIZE>::Pool(Pool&& pool) noexcept
+		: mBlocks(Move(pool.mBlocks)), mpFreeList(pool.mpFreeList), mUsed(pool.mUsed), mCapacity(pool.mCapacity)
 	{
-		if (!mFreeIndices.IsEmpty())
-			return mFreeIndices.Pop();
-
-		return mMaxIndex++;
+		pool.mBlocks = Array<Block*>();
+		pool.mpFreeList = nullptr;
+		pool.mUsed = 0;
+		pool.mCapacity = 0;
 	}
 
 	template<typename Type, UInt32 BLOCK_SIZE>
-	Pool<Type, BLOCK_SIZE>::Pool()
-		: mUsed(0), mCapacity(0)
+	Pool<Type, BLOCK_SIZE>::~Pool()
 	{
-		// Nothing
+		Clear();
+
+		for (Block* pBlock : mBlocks)
+		{
+			AlignedFree(pBlock);
+		}
 	}
 
 	template<typename Type, UInt32 BLOCK_SIZE>
-	Pool<Type, BLOCK_SIZE>::Pool(const Pool& pool)
-		: mBlocks(pool.mBlocks), mUsed(pool.mUsed), mCapacity(pool.mCapacity)
+	Type* Pool<Type, BLOCK_SIZE>::CreateNoInit()
 	{
-		// Nothing
+		return reinterpret_cast<Type*>(AcquireSlot());
 	}
 
 	template<typename Type, UInt32 BLOCK_SIZE>
-	Pool<Type, BLOCK_SIZE>::Pool(Pool&& pool)
-		: mBlocks(pool.mBlocks), mUsed(pool.mUsed), mCapacity(pool.mCapacity)
+	template<typename ...Args>
+	Type* Pool<Type, BLOCK_SIZE>::Create(Args&&... args)
 	{
-		// Nothing
+		return new (AcquireSlot()) Type(std::forward<Args>(args)...);
 	}
 
 	template<typename Type, UInt32 BLOCK_SIZE>
-	Pool<Type, BLOCK_SIZE>::~Pool()
+	void Pool<Type, BLOCK_SIZE>::Free(void* pVoid)
 	{
-		for (const auto& pair : mPtrIndexMap)
+		if (pVoid == nullptr)
 		{
-			const UInt32 blockIndex = pair.value / BLOCK_SIZE;
-			const UInt32 subIndex = pair.value % BLOCK_SIZE;
-			mBlocks[blockIndex]->Free(subIndex);
+			return;
 		}
+
+		Block* pBlock = BlockOf(pVoid);
+		const UInt32 slotIndex = static_cast<UInt32>(static_cast<Slot*>(pVoid) - Slots(pBlock));
+
+		DEBUG_ASSERT(Owns(pBlock) && "Pointer was not allocated from this pool!");
+		DEBUG_ASSERT(IsOccupied(pBlock, slotIndex) && "Pool slot was already freed!");
+
+		static_cast<Type*>(pVoid)->~Type();
+		ReleaseSlot(pBlock, slotIndex);
 	}
 
 	template<typename Type, UInt32 BLOCK_SIZE>
-	void Pool<Type, BLOCK_SIZE>::Free(void* pVoid)
+	void Pool<Type, BLOCK_SIZE>::Clear()
 	{
-		auto it = mPtrIndexMap.Find(reinterpret_cast<UInt64>(pVoid));
-
-		if (it.IsValid())
+		for (Block* pBlock : mBlocks)
 		{
-			const UInt32 blockIndex = it->value / BLOCK_SIZE;
-			const UInt32 subIndex = it->value % BLOCK_SIZE;
-			mBlocks[blockIndex]->Free(subIndex);
-			mFreeIndices.Push(it->value);
-			mPtrIndexMap.Erase(it);
-
-			--mUsed;
+			for (UInt32 word = 0; word < BITMAP_WORDS; word++)
+			{
+				UInt64 bits = pBlock->occupied[word];
+
+				while (bits != 0)
+				{
+					const UInt32 slotIndex = word * 64 + CountTrailingZeros64(bits);
+					reinterpret_cast<Type*>(Slots(pBlock) + slotIndex)->~Type();
+					ReleaseSlot(pBlock, slotIndex);
+
+					bits &= bits - 1;
+				}
+			}
 		}
 	}
 
 	template<typename Type, UInt32 BLOCK_SIZE>
-	Type* Pool<Type, BLOCK_SIZE>::CreateNoInit()
+	PoolHandle Pool<Type, BLOCK_SIZE>::GetHandle(const Type* pValue) const
 	{
-		const UInt32 index = NextIndex();
+		Block* pBlock = BlockOf(pValue);
+		const UInt32 slotIndex = static_cast<UInt32>(reinterpret_cast<const Slot*>(pValue) - Slots(pBlock));
 
-		if (index >= mCapacity)
-		{
-			mBlocks.PushBack(new PoolBlock<Type, BLOCK_SIZE>());
-			mCapacity += BLOCK_SIZE;
-		}
+		DEBUG_ASSERT(Owns(pBlock) && IsOccupied(pBlock, slotIndex));
 
-		const UInt32 blockIndex = index / BLOCK_SIZE;
-		const UInt32 subIndex = index % BLOCK_SIZE;
+		return PoolHandle(pBlock->index * SLOTS_PER_BLOCK + slotIndex, pBlock->generations[slotIndex]);
+	}
 
-		PoolBlock<Type, BLOCK_SIZE>* mpBlock = mBlocks[blockIndex];
-		Type* pObject = mpBlock->CreateNoInit(subIndex);
-		mPtrIndexMap[reinterpret_cast<UInt64>(pObject)] = index;
+	template<typename Type, UInt32 BLOCK_SIZE>
+	Type* Pool<Type, BLOCK_SIZE>::Get(PoolHandle handle)
+	{
+		return IsValid(handle) ?
+			reinterpret_cast<Type*>(Slots(mBlocks[handle.index / SLOTS_PER_BLOCK]) + handle.index % SLOTS_PER_BLOCK) : nullptr;
+	}
 
-		++mUsed;
+	template<typename Type, UInt32 BLOCK_SIZE>
+	Bool8 Pool<Type, BLOCK_SIZE>::IsValid(PoolHandle handle) const
+	{
+		const UInt32 blockIndex = handle.index / SLOTS_PER_BLOCK;
+		const UInt32 slotIndex = handle.index % SLOTS_PER_BLOCK;
 
-		return pObject;
+		// Freed slots always have a newer generation than their handles
+		return blockIndex < mBlocks.Size() && mBlocks[blockIndex]->generations[slotIndex] == handle.generation
+			&& IsOccupied(mBlocks[blockIndex], slotIndex);
 	}
 
 	template<typename Type, UInt32 BLOCK_SIZE>
-	template<typename ...Args>
-	Type* Pool<Type, BLOCK_SIZE>::Create(Args&&... args)
+	void Pool<Type, BLOCK_SIZE>::Free(PoolHandle handle)
 	{
-		const UInt32 index = NextIndex();
-
-		if (index >= mCapacity)
+		if (IsValid(handle))
 		{
-			mBlocks.PushBack(new PoolBlock<Type, BLOCK_SIZE>());
-			mCapacity += BLOCK_SIZE;
-		}
-
-		const UInt32 blockIndex = index / BLOCK_SIZE;
-		const UInt32 subIndex = index % BLOCK_SIZE;
+			Block* pBlock = mBlocks[handle.index / SLOTS_PER_BLOCK];
+			const UInt32 slotIndex = handle.index % SLOTS_PER_BLOCK;
 
-		PoolBlock<Type, BLOCK_SIZE>* pBlock = mBlocks[blockIndex];
-		Type* pObject = pBlock->Create(subIndex, std::forward<Args>(args)...);
-		mPtrIndexMap[reinterpret_cast<UInt64>(pObject)] = index;
-
-		++mUsed;
-
-		return pObject;
+			reinterpret_cast<Type*>(Slots(pBlock) + slotIndex)->~Type();
+			ReleaseSlot(pBlock, slotIndex);
+		}
 	}
 
 	template<typename Type, UInt32 BLOCK_SIZE>
 	typename Pool<Type, BLOCK_SIZE>::Iterator Pool<Type, BLOCK_SIZE>::begin()
 	{
-		return Iterator(mPtrIndexMap.begin());
+		return Iterator(mBlocks.Data(), mBlocks.Data() + mBlocks.Size());
 	}
 
 	template<typename Type, UInt32 BLOCK_SIZE>
 	typename Pool<Type, BLOCK_SIZE>::Iterator Pool<Type, BLOCK_SIZE>::end()
 	{
-		return Iterator(mPtrIndexMap.end());
+		return Iterator(mBlocks.Data() + mBlocks.Size(), mBlocks.Data() + mBlocks.Size());
 	}
-}
\ No newline at end of file
+}
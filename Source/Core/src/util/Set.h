@@ -2,26 +2,34 @@
 
 #include "../Common.h"
 #include "Table.h"
+#include "Utility.h"
+
+#include <type_traits>
 
 namespace Quartz
 {
-	template<typename _Value>
+	template<typename _Value, typename _Allocator = HeapAllocator>
 	class Set
 	{
 	public:
-		using SetType	= Set<_Value>;
-		using ValueType = _Value;
-		using Iterator  = typename Table<ValueType>::Iterator;
+		using SetType		= Set<_Value, _Allocator>;
+		using ValueType		= _Value;
+		using AllocatorType	= _Allocator;
+		using TableType		= Table<ValueType, AllocatorType>;
+		using Iterator		= typename TableType::Iterator;
 
 	private:
-		Table<ValueType> mTable;
+		TableType mTable;
 
 	public:
 		Set()
 			: mTable() {}
 
-		Set(UInt32 size)
-			: mTable(size) {}
+		explicit Set(const AllocatorType& allocator)
+			: mTable(allocator) {}
+
+		Set(UInt32 size, const AllocatorType& allocator = AllocatorType())
+			: mTable(size, allocator) {}
 
 		Set(const SetType& set)
 			: mTable(set.mTable) {}
@@ -43,10 +51,10 @@ namespace Quartz
 			return mTable.Insert(Hash<ValueType>(value), std::forward<Value>(value));
 		}
 
-		/*void Remove(const ValueType& value)
+		void Remove(const ValueType& value)
 		{
 			mTable.Remove(Hash(value), value);
-		}*/
+		}
 
 		SetType& operator=(SetType set)
 		{
@@ -84,6 +92,21 @@ namespace Quartz
 			return mTable.Contains(Hash(value), value);
 		}
 
+		/* Transparent lookup, see TransparentHash */
+		template<typename Lookup, typename = typename TransparentHash<ValueType, std::decay_t<Lookup>>::LookupType>
+		Bool8 Contains(const Lookup& value)
+		{
+			using Transparent = TransparentHash<ValueType, std::decay_t<Lookup>>;
+			return mTable.Contains(Transparent::Hash(value), value);
+		}
+
+		/* Pre-hashed lookup, hash must be equal to Hash<ValueType>() of the equivalent value */
+		template<typename Lookup>
+		Bool8 Contains(UInt32 hash, const Lookup& value)
+		{
+			return mTable.Contains(hash, value);
+		}
+
 		UInt32 Size() const
 		{
 			return mTable.Size();
@@ -99,4 +122,7 @@ namespace Quartz
 			return mTable.Threshold();
 		}
 	};
+
+	template<typename ValueType, typename AllocatorType>
+	struct IsTriviallyRelocatable<Set<ValueType, AllocatorType>> : public IsTriviallyRelocatable<AllocatorType> {};
 }
\ No newline at end of file
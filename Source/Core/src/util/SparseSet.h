@@ -2,6 +2,7 @@
 
 #include "../Common.h"
 #include "Array.h"
+#include "Pool.h"
 #include "Utility.h"
 
 namespace Quartz
@@ -17,13 +18,20 @@ namespace Quartz
 		using SparseSetType		= SparseSet<_ValueType, _IntType, blockSize>;
 		using Iterator			= typename Array<ValueType>::Iterator;
 
-		using SparseBlock		= Array<IntType>;
-
 		constexpr static IntType NULL_INDEX = IntType(-1);
 
+		/* Dense index of each handle in a block, NULL_INDEX if absent */
+		struct SparseBlock
+		{
+			IntType indices[ENTITIES_PER_BLOCK];
+		};
+
 	private:
-		Array<ValueType>	mDense;
-		Array<SparseBlock>	mSparse;
+		Array<ValueType>			mDense;
+		Array<SparseBlock*>			mSparse;		// nullptr until a handle in the block is inserted
+		Pool<SparseBlock, 32>		mSparsePool;
+		Array<Array<SparseBlock>>	mSparseRuns;	// Blocks reserved together by ReserveSparse
+		UInt32						mLayoutVersion;	// Bumped whenever a stored handle changes dense index
 
 	private:
 		IntType GetBlockIndex(ValueType handle) const
@@ -38,7 +46,10 @@ namespace Quartz
 
 	public:
 		SparseSet()
-			: mDense(), mSparse() {}
+			: mDense(), mSparse(), mSparsePool(), mSparseRuns(), mLayoutVersion(0) {}
+
+		SparseSet(const SparseSet&) = delete;
+		SparseSet& operator=(const SparseSet&) = delete;
 
 		IntType Insert(ValueType handle)
 		{
@@ -47,23 +58,115 @@ namespace Quartz
 
 			if (Contains(handle))
 			{
-				return mSparse[blockIndex][blockOffset];
+				return mSparse[blockIndex]->indices[blockOffset];
 			}
 
 			if (blockIndex >= mSparse.Size())
 			{
-				mSparse.Resize(blockIndex + 1);
+				mSparse.Resize(blockIndex + 1, nullptr);
 			}
 
-			if (mSparse[blockIndex].Size() == 0)
+			if (mSparse[blockIndex] == nullptr)
 			{
-				mSparse[blockIndex].Resize(ENTITIES_PER_BLOCK, NULL_INDEX);
+				SparseBlock* pBlock = mSparsePool.CreateNoInit();
+
+				for (USize i = 0; i < ENTITIES_PER_BLOCK; i++)
+				{
+					pBlock->indices[i] = NULL_INDEX;
+				}
+
+				mSparse[blockIndex] = pBlock;
 			}
 
 			mDense.PushBack(handle);
-			mSparse[blockIndex][blockOffset] = mDense.Size() - 1;
+			mSparse[blockIndex]->indices[blockOffset] = mDense.Size() - 1;
+
+			return mSparse[blockIndex]->indices[blockOffset];
+		}
+
+		/*
+			Allocates the missing sparse blocks covering handles [first, end)
+			in a single allocation. Blocks are never freed on their own, so
+			the run lives as long as the set.
+		*/
+		void ReserveSparse(IntType first, IntType end)
+		{
+			if (first >= end)
+			{
+				return;
+			}
+
+			const IntType firstBlock = first / ENTITIES_PER_BLOCK;
+			const IntType endBlock = (end - 1) / ENTITIES_PER_BLOCK + 1;
+
+			if (endBlock > mSparse.Size())
+			{
+				mSparse.Resize(endBlock, nullptr);
+			}
+
+			USize missing = 0;
+
+			for (IntType i = firstBlock; i < endBlock; i++)
+			{
+				missing += mSparse[i] == nullptr;
+			}
+
+			if (missing == 0)
+			{
+				return;
+			}
+
+			Array<SparseBlock>& run = *mSparseRuns.PushBack(Array<SparseBlock>());
+			run.ResizeNoInit(missing);
+
+			// NULL_INDEX is all bits set
+			memset(static_cast<void*>(run.Data()), 0xFF, missing * sizeof(SparseBlock));
+
+			USize next = 0;
+
+			for (IntType i = firstBlock; i < endBlock; i++)
+			{
+				if (mSparse[i] == nullptr)
+				{
+					mSparse[i] = &run[next++];
+				}
+			}
+		}
+
+		/*
+			Appends count handles that are not in the set yet. The dense
+			array is copied in bulk and the missing sparse blocks between
+			the lowest and highest handle are allocated together.
+		*/
+		void InsertRange(const ValueType* pHandles, USize count)
+		{
+			if (count == 0)
+			{
+				return;
+			}
+
+			IntType minHandle = IntType(pHandles[0]);
+			IntType maxHandle = IntType(pHandles[0]);
+
+			for (USize i = 1; i < count; i++)
+			{
+				const IntType handle = IntType(pHandles[i]);
+				minHandle = handle < minHandle ? handle : minHandle;
+				maxHandle = handle > maxHandle ? handle : maxHandle;
+			}
+
+			ReserveSparse(minHandle, maxHandle + 1);
+
+			const IntType first = static_cast<IntType>(mDense.Size());
+			mDense.Append(pHandles, count);
+
+			for (USize i = 0; i < count; i++)
+			{
+				const IntType blockIndex = GetBlockIndex(pHandles[i]);
 
-			return mSparse[blockIndex][blockOffset];
+				assert(mSparse[blockIndex]->indices[GetBlockOffset(pHandles[i])] == NULL_INDEX && "SparseSet already contains handle!");
+				mSparse[blockIndex]->indices[GetBlockOffset(pHandles[i])] = first + static_cast<IntType>(i);
+			}
 		}
 
 		void Remove(ValueType handle)
@@ -73,15 +176,53 @@ namespace Quartz
 			const IntType blockIndex = GetBlockIndex(handle);
 			const IntType blockOffset = GetBlockOffset(handle);
 
-			mDense[mSparse[blockIndex][blockOffset]] = mDense[mDense.Size() - 1];
+			mDense[mSparse[blockIndex]->indices[blockOffset]] = mDense[mDense.Size() - 1];
 
 			const IntType removedBlockIndex = GetBlockIndex(mDense[mDense.Size() - 1]);
 			const IntType removedBlockOffset = GetBlockOffset(mDense[mDense.Size() - 1]);
 
-			mSparse[removedBlockIndex][removedBlockOffset] = mSparse[blockIndex][blockOffset];
-			mSparse[blockIndex][blockOffset] = NULL_INDEX;
+			mSparse[removedBlockIndex]->indices[removedBlockOffset] = mSparse[blockIndex]->indices[blockOffset];
+			mSparse[blockIndex]->indices[blockOffset] = NULL_INDEX;
 
 			mDense.PopBack();
+			mLayoutVersion++;
+		}
+
+		/* Swaps the handles at two dense indices, keeping the sparse indices valid */
+		void SwapDense(IntType index1, IntType index2)
+		{
+			if (index1 == index2)
+			{
+				return;
+			}
+
+			const ValueType handle1 = mDense[index1];
+			const ValueType handle2 = mDense[index2];
+
+			mDense[index1] = handle2;
+			mDense[index2] = handle1;
+
+			mSparse[GetBlockIndex(handle1)]->indices[GetBlockOffset(handle1)] = index2;
+			mSparse[GetBlockIndex(handle2)]->indices[GetBlockOffset(handle2)] = index1;
+			mLayoutVersion++;
+		}
+
+		/* Reserves dense space for capacity handles */
+		void Reserve(USize capacity)
+		{
+			mDense.Reserve(capacity);
+		}
+
+		/* Removes every handle, sparse blocks are kept for reuse */
+		void Clear()
+		{
+			for (const ValueType& handle : mDense)
+			{
+				mSparse[GetBlockIndex(handle)]->indices[GetBlockOffset(handle)] = NULL_INDEX;
+			}
+
+			mDense.Clear();
+			mLayoutVersion++;
 		}
 
 		Bool8 Contains(ValueType handle) const
@@ -89,12 +230,21 @@ namespace Quartz
 			const IntType blockIndex = GetBlockIndex(handle);
 			const IntType blockOffset = GetBlockOffset(handle);
 
-			if (blockIndex >= mSparse.Size() || mSparse[blockIndex].Size() == 0)
+			if (blockIndex >= mSparse.Size() || mSparse[blockIndex] == nullptr)
 			{
 				return false;
 			}
 
-			return mSparse[blockIndex][blockOffset] != NULL_INDEX;
+			return mSparse[blockIndex]->indices[blockOffset] != NULL_INDEX;
+		}
+
+		/*
+			Changes whenever a handle already stored may have moved to another
+			dense index. Inserting does not move existing handles.
+		*/
+		UInt32 GetLayoutVersion() const
+		{
+			return mLayoutVersion;
 		}
 
 		IntType Index(ValueType handle) const
@@ -102,7 +252,7 @@ namespace Quartz
 			const IntType blockIndex = GetBlockIndex(handle);
 			const IntType blockOffset = GetBlockOffset(handle);
 
-			return mSparse[blockIndex][blockOffset];
+			return mSparse[blockIndex]->indices[blockOffset];
 		}
 
 		Iterator begin()
@@ -115,6 +265,11 @@ namespace Quartz
 			return mDense.end();
 		}
 
+		ValueType* Data()
+		{
+			return mDense.Data();
+		}
+
 		USize Size() const
 		{
 			return mDense.Size();
@@ -3,13 +3,14 @@
 
 namespace Quartz
 {
-	template<class _Type>
-	class ArrayStack : protected Array<_Type>
+	template<class _Type, typename _Allocator = HeapAllocator>
+	class ArrayStack : protected Array<_Type, _Allocator>
 	{
 	public:
 		using Type				= _Type;
-		using ArrayStackType	= ArrayStack<_Type>;
-		using ArrayType			= Array<_Type>;
+		using AllocatorType		= _Allocator;
+		using ArrayStackType	= ArrayStack<_Type, _Allocator>;
+		using ArrayType			= Array<_Type, _Allocator>;
 
 	public:
 		ArrayStack() {}
@@ -22,31 +23,31 @@ namespace Quartz
 
 		void Push(const Type& value)
 		{
-			Array<Type>::PushBack(value);
+			ArrayType::PushBack(value);
 		}
 
 		void Push(Type&& value)
 		{
-			Array<Type>::PushBack(Move(value));
+			ArrayType::PushBack(Move(value));
 		}
 
 		Type* Peek()
 		{
 			// TODO: Replace with asserts?
-			if (Array<Type>::mSize == 0)
+			if (ArrayType::mSize == 0)
 			{
 				return nullptr;
 			}
 
-			return &Array<Type>::mpData[Array<Type>::mSize - 1];
+			return &ArrayType::mpData[ArrayType::mSize - 1];
 		}
 
 		void Pop()
 		{
 			// TODO: Replace with asserts?
-			if (!Array<Type>::mSize == 0)
+			if (!ArrayType::mSize == 0)
 			{
-				Array<Type>::Remove(Array<Type>::mSize - 1);
+				ArrayType::Remove(ArrayType::mSize - 1);
 			}
 		}
 
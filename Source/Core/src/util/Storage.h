@@ -1,9 +1,24 @@
 #pragma once
 
 #include "SparseSet.h"
+#include "PagedArray.h"
+
+#include <type_traits>
 
 namespace Quartz
 {
+	/*
+		Chooses how a Storage keeps its values. Specialize with a non-zero
+		PAGE_SIZE to keep a value type in fixed-size pages: values are not
+		moved by growth, at the cost of an extra indirection per access.
+		Removing still swaps the last value into the removed slot.
+	*/
+	template<typename ValueType>
+	struct StoragePaging
+	{
+		constexpr static USize PAGE_SIZE = 0;
+	};
+
 	template<typename _ValueType, typename _HandleType = UInt32, typename _IntType = UInt32, USize blockSize = 64>
 	class Storage : public SparseSet<_HandleType, _IntType, blockSize>
 	{
@@ -12,40 +27,118 @@ namespace Quartz
 		using HandleType	= _HandleType;
 		using IntType		= _IntType;
 		using BaseSet		= SparseSet<_HandleType, _IntType, blockSize>;
-		using Iterator		= typename Array<ValueType>::Iterator;
+
+		constexpr static USize PAGE_SIZE = StoragePaging<_ValueType>::PAGE_SIZE;
+		constexpr static Bool8 PAGED = PAGE_SIZE != 0;
+
+		using ValueArray	= std::conditional_t<PAGED, PagedArray<ValueType, (PAGED ? PAGE_SIZE : 1)>, Array<ValueType>>;
+		using Iterator		= typename ValueArray::Iterator;
 	
 	private:
-		Array<ValueType> mStorage;
+		ValueArray			mStorage;
+
+		/* Ticks each value was added and last changed at, parallel to mStorage when tracked */
+		Array<UInt32>		mAddedTicks;
+		Array<UInt32>		mChangedTicks;
+		Bool8				mTracked;
 
 	public:
 		Storage()
-			: BaseSet(), mStorage() {}
+			: BaseSet(), mStorage(), mTracked(false) {}
 
+		/* tick is only recorded if change tracking is enabled */
 		template<typename Value>
-		ValueType& Insert(HandleType handle, Value&& value)
+		ValueType& Insert(HandleType handle, Value&& value, UInt32 tick = 0)
 		{
 			IntType index = BaseSet::Insert(handle);
 
 			if (index < mStorage.Size())
 			{
+				if (mTracked)
+				{
+					mChangedTicks[index] = tick;
+				}
+
 				return mStorage[index] = std::forward<Value>(value);
 			}
 
+			if (mTracked)
+			{
+				mAddedTicks.PushBack(tick);
+				mChangedTicks.PushBack(tick);
+			}
+
 			return *mStorage.PushBack(std::forward<Value>(value));
 		}
 
+		/* Inserts count handles that are not stored yet, copying their values in bulk */
+		void InsertRange(const HandleType* pHandles, const ValueType* pValues, USize count, UInt32 tick = 0)
+		{
+			BaseSet::InsertRange(pHandles, count);
+			mStorage.Append(pValues, count);
+
+			if (mTracked)
+			{
+				mAddedTicks.Resize(mStorage.Size(), tick);
+				mChangedTicks.Resize(mStorage.Size(), tick);
+			}
+		}
+
+		/* Inserts count handles that are not stored yet, each with a copy of value */
+		void InsertRange(const HandleType* pHandles, USize count, const ValueType& value, UInt32 tick = 0)
+		{
+			BaseSet::InsertRange(pHandles, count);
+			mStorage.Resize(mStorage.Size() + count, value);
+
+			if (mTracked)
+			{
+				mAddedTicks.Resize(mStorage.Size(), tick);
+				mChangedTicks.Resize(mStorage.Size(), tick);
+			}
+		}
+
+		/* Reserves space for capacity handles and values */
+		void Reserve(USize capacity)
+		{
+			BaseSet::Reserve(capacity);
+			mStorage.Reserve(capacity);
+
+			if (mTracked)
+			{
+				mAddedTicks.Reserve(capacity);
+				mChangedTicks.Reserve(capacity);
+			}
+		}
+
 		void Remove(HandleType handle)
 		{
 			assert(BaseSet::Contains(handle) && "Storage does not contain handle!");
 
 			IntType index = BaseSet::Index(handle);
 			//Swap(mStorage[index], mStorage[mStorage.Size() - 1]);
-			mStorage[index] = mStorage[mStorage.Size() - 1];
+			mStorage[index] = Move(mStorage[mStorage.Size() - 1]);
 			mStorage.PopBack();
 
+			if (mTracked)
+			{
+				mAddedTicks[index] = mAddedTicks[mAddedTicks.Size() - 1];
+				mAddedTicks.PopBack();
+				mChangedTicks[index] = mChangedTicks[mChangedTicks.Size() - 1];
+				mChangedTicks.PopBack();
+			}
+
 			BaseSet::Remove(handle);
 		}
 
+		/* Removes every value, tracking stays enabled */
+		void Clear()
+		{
+			BaseSet::Clear();
+			mStorage.Clear();
+			mAddedTicks.Clear();
+			mChangedTicks.Clear();
+		}
+
 		Bool8 Contains(HandleType handle) const
 		{
 			return BaseSet::Contains(handle);
@@ -57,6 +150,113 @@ namespace Quartz
 			return mStorage[BaseSet::Index(handle)];
 		}
 
+		/* Same as Get, marking the value changed at tick */
+		ValueType& GetMut(HandleType handle, UInt32 tick)
+		{
+			assert(BaseSet::Contains(handle) && "Storage does not contain handle!");
+			IntType index = BaseSet::Index(handle);
+
+			if (mTracked)
+			{
+				mChangedTicks[index] = tick;
+			}
+
+			return mStorage[index];
+		}
+
+		/* Starts recording added and changed ticks, existing values count as tick 0 */
+		void EnableTracking()
+		{
+			if (!mTracked)
+			{
+				mAddedTicks.Resize(mStorage.Size(), 0);
+				mChangedTicks.Resize(mStorage.Size(), 0);
+				mTracked = true;
+			}
+		}
+
+		Bool8 IsTracked() const
+		{
+			return mTracked;
+		}
+
+		UInt32 GetAddedTick(HandleType handle) const
+		{
+			return mAddedTicks[BaseSet::Index(handle)];
+		}
+
+		UInt32 GetChangedTick(HandleType handle) const
+		{
+			return mChangedTicks[BaseSet::Index(handle)];
+		}
+
+		/* Value at index in the dense array, in the same order as the handles */
+		ValueType& GetDense(IntType index)
+		{
+			return mStorage[index];
+		}
+
+		/* Same as GetDense, marking the value changed at tick */
+		ValueType& GetDenseMut(IntType index, UInt32 tick)
+		{
+			if (mTracked)
+			{
+				mChangedTicks[index] = tick;
+			}
+
+			return mStorage[index];
+		}
+
+		/* Marks the values at dense indices [begin, end) changed at tick */
+		void MarkChanged(IntType begin, IntType end, UInt32 tick)
+		{
+			if (mTracked)
+			{
+				for (IntType i = begin; i < end; i++)
+				{
+					mChangedTicks[i] = tick;
+				}
+			}
+		}
+
+		/* Swaps two dense entries, handles and values together */
+		void SwapDense(IntType index1, IntType index2)
+		{
+			if (index1 == index2)
+			{
+				return;
+			}
+
+			BaseSet::SwapDense(index1, index2);
+			Swap(mStorage[index1], mStorage[index2]);
+
+			if (mTracked)
+			{
+				Swap(mAddedTicks[index1], mAddedTicks[index2]);
+				Swap(mChangedTicks[index1], mChangedTicks[index2]);
+			}
+		}
+
+		/* Contiguous values, parallel to the handles. Only for unpaged storages */
+		ValueType* GetDenseData()
+		{
+			static_assert(!PAGED, "Paged storages are not contiguous, use GetColumn!");
+			return mStorage.Data();
+		}
+
+		/* Values indexable by dense index, a raw pointer unless paged */
+		decltype(auto) GetColumn()
+		{
+			if constexpr (PAGED)
+			{
+				return (mStorage);
+			}
+			else
+			{
+				return mStorage.Data();
+			}
+		}
+
 		Iterator begin()
 		{
 			return mStorage.begin();
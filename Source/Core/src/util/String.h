@@ -1,10 +1,15 @@
 #pragma once
 
 #include "../Common.h"
+#include "../memory/Allocator.h"
 #include "Hash.h"
+#include "Utility.h"
 
 #include <cstring>
 #include <cassert>
+#include <atomic>
+#include <new>
+#include <type_traits>
 
 namespace Quartz
 {
@@ -27,33 +32,49 @@ namespace Quartz
 	}
 
 	template<typename CharType>
-	UInt32 StringHash(const CharType* pString)
+	FORCE_INLINE UInt32 StringHash(const CharType* pString, USize length)
 	{
-		return false;
+		return static_cast<UInt32>(HashBytes(pString, length * sizeof(CharType)));
+	}
+
+	template<typename CharType>
+	FORCE_INLINE UInt32 StringHash(const CharType* pString)
+	{
+		return StringHash(pString, StringLength(pString));
 	}
 
 	template<typename _CharType>
+	class StringViewBase;
+
+	template<typename _CharType, typename _Allocator = HeapAllocator, Bool8 atomicRefCount = false>
 	class SubStringBase;
 
-	template<typename _CharType>
-	class StringBase
+	/*
+		Strings of up to INLINE_LENGTH characters are stored in place. Longer
+		strings live in a reference counted heap buffer shared between copies.
+		With atomicRefCount the count is atomic, so copies may be shared and
+		released across threads.
+	*/
+	template<typename _CharType, typename _Allocator = HeapAllocator, Bool8 atomicRefCount = false>
+	class StringBase : public AllocatorStorage<_Allocator>
 	{
 	public:
-		using StringType = StringBase<_CharType>;
-		using SubStringType = SubStringBase<_CharType>;
+		using StringType = StringBase<_CharType, _Allocator, atomicRefCount>;
+		using SubStringType = SubStringBase<_CharType, _Allocator, atomicRefCount>;
+		using ViewType = StringViewBase<_CharType>;
 		using CharType = typename _CharType;
+		using AllocatorType = _Allocator;
 
 		friend SubStringType;
 
 	protected:
+		using RefCountType = typename std::conditional<atomicRefCount, std::atomic<USize>, USize>::type;
+
 		struct StringMeta
 		{
-			USize count;
+			RefCountType count;
 			USize length;
 
-			StringMeta() :
-				count(1), length(0) { }
-
 			StringMeta(USize count, USize length) :
 				count(count), length(length) { }
 		};
@@ -61,101 +82,174 @@ namespace Quartz
 		static constexpr USize charSize = sizeof(CharType);
 		static constexpr USize metaSize = sizeof(StringMeta);
 
+		/* The last storage byte holds the inline length, or HEAP_TAG */
+		static constexpr USize STORAGE_SIZE = 24;
+		static constexpr Byte HEAP_TAG = 0xFF;
+
+	public:
+		static constexpr USize INLINE_LENGTH = (STORAGE_SIZE - 1) / charSize - 1;
+
+	protected:
 		union
 		{
-			Byte* mpData;
-			StringMeta* mpMeta;
+			Byte*		mpData;
+			StringMeta*	mpMeta;
+			CharType	mInline[STORAGE_SIZE / charSize];
+			Byte		mStorage[STORAGE_SIZE];
 		};
 
-		static StringType Append(const StringType& string1, const CharType* pString2)
+		FORCE_INLINE Bool8 IsInline() const
 		{
-			StringType result;
-			USize length = StringLength(pString2);
-			result.Resize(string1.Length() + length);
-			memcpy(result.Data(), string1.Str(), string1.Length() * sizeof(CharType));
-			memcpy(result.Data() + string1.Length(), pString2, length * sizeof(CharType));
-			return result;
+			return mStorage[STORAGE_SIZE - 1] != HEAP_TAG;
 		}
 
-		static StringType Append(const CharType* pString1, const StringType& string2)
+		static constexpr USize BufferSize(USize length)
 		{
-			StringType result;
-			USize length = StringLength(pString1);
-			result.Resize(length + string2.Length());
-			memcpy(result.Data(), pString1, length * sizeof(CharType));
-			memcpy(result.Data() + length, string2.Str(), string2.Length() * sizeof(CharType));
-			return result;
+			return metaSize + (length + 1) * charSize;
+		}
+
+		/* Sets up unique, null-terminated storage for length characters */
+		void InitStorage(USize length)
+		{
+			if (length <= INLINE_LENGTH)
+			{
+				mInline[length] = 0;
+				mStorage[STORAGE_SIZE - 1] = static_cast<Byte>(length);
+			}
+			else
+			{
+				mpData = static_cast<Byte*>(this->GetAllocator().Allocate(BufferSize(length), alignof(StringMeta)));
+				new (mpMeta) StringMeta(1, length);
+				mStorage[STORAGE_SIZE - 1] = HEAP_TAG;
+
+				// Set last value to zero (null-termination)
+				reinterpret_cast<CharType*>(mpData + metaSize)[length] = 0;
+			}
+		}
+
+		void AddReference()
+		{
+			if (!IsInline())
+			{
+				if constexpr (atomicRefCount)
+				{
+					mpMeta->count.fetch_add(1, std::memory_order_relaxed);
+				}
+				else
+				{
+					++mpMeta->count;
+				}
+			}
+		}
+
+		void ReleaseStorage()
+		{
+			if (!IsInline())
+			{
+				Bool8 released;
+
+				if constexpr (atomicRefCount)
+				{
+					released = mpMeta->count.fetch_sub(1, std::memory_order_acq_rel) == 1;
+				}
+				else
+				{
+					released = --mpMeta->count == 0;
+				}
+
+				if (released)
+				{
+					const USize length = mpMeta->length;
+					mpMeta->~StringMeta();
+					this->GetAllocator().Free(mpData, BufferSize(length));
+				}
+			}
 		}
 
-		static StringType Append(const StringType& string1, const StringType& string2)
+		static StringType Concat(const ViewType& string1, const ViewType& string2)
 		{
 			StringType result;
-			result.Resize(string1.Length() + string2.Length());
-			memcpy(result.Data(), string1.Str(), string1.Length() * sizeof(CharType));
-			memcpy(result.Data() + string1.Length(), string2.Str(), string2.Length() * sizeof(CharType));
+			result.InitStorage(string1.Length() + string2.Length());
+			memcpy(result.Data(), string1.Str(), string1.Length() * charSize);
+			memcpy(result.Data() + string1.Length(), string2.Str(), string2.Length() * charSize);
 			return result;
 		}
 
 	public:
-		StringBase() :
-			mpMeta(new StringMeta()) { }
+		StringBase()
+		{
+			InitStorage(0);
+		}
+
+		explicit StringBase(const AllocatorType& allocator)
+			: AllocatorStorage<AllocatorType>(allocator)
+		{
+			InitStorage(0);
+		}
 
 		StringBase(const StringType& string)
-			: mpData(string.mpData)
+			: AllocatorStorage<AllocatorType>(string.GetAllocator())
 		{
-			++mpMeta->count;
+			memcpy(mStorage, string.mStorage, STORAGE_SIZE);
+			AddReference();
 		}
 
 		StringBase(StringType&& rString) noexcept
-			: StringType()
+			: AllocatorStorage<AllocatorType>(rString.GetAllocator())
 		{
-			Swap(*this, rString);
+			memcpy(mStorage, rString.mStorage, STORAGE_SIZE);
+			rString.InitStorage(0);
 		}
 
 		StringBase(const CharType* pString)
 			: StringBase(pString, StringLength(pString)) { }
 
-		StringBase(const CharType* pString, USize length)
+		StringBase(const CharType* pString, USize length, const AllocatorType& allocator = AllocatorType())
+			: AllocatorStorage<AllocatorType>(allocator)
 		{
-			const USize stringBufferSize = (length + 1) * charSize;
-			const USize fullBufferSize = metaSize + stringBufferSize;
-
-			mpData = new Byte[fullBufferSize];
-
-			*mpMeta = StringMeta(1, length);
-			memcpy(mpData + metaSize, pString, stringBufferSize);
-
-			// Set last value to zero (null-termination)
-			reinterpret_cast<CharType*>(mpData + metaSize)[length] = 0;
+			InitStorage(length);
+			memcpy(Data(), pString, length * charSize);
 		}
 
+		explicit StringBase(const ViewType& view, const AllocatorType& allocator = AllocatorType())
+			: StringBase(view.Str(), view.Length(), allocator) { }
+
 		StringBase(const SubStringType& substring)
-			: StringBase(substring.Str(), substring.Length()) { }
+			: StringBase(substring.Str(), substring.Length(), substring.mSrcString.GetAllocator()) { }
 
 		~StringBase()
 		{
-			if (--mpMeta->count == 0)
-			{
-				delete mpData;
-			}
+			ReleaseStorage();
 		}
 
 		friend void Swap(StringType& string1, StringType& string2)
 		{
 			using Quartz::Swap;
-			Swap(string1.mpData, string2.mpData);
+
+			Byte temp[STORAGE_SIZE];
+			memcpy(temp, string1.mStorage, STORAGE_SIZE);
+			memcpy(string1.mStorage, string2.mStorage, STORAGE_SIZE);
+			memcpy(string2.mStorage, temp, STORAGE_SIZE);
+
+			Swap(string1.GetAllocator(), string2.GetAllocator());
 		}
 
 		Bool8 operator==(const StringType& string) const
 		{
 			return (Length() == string.Length()) &&
-				(StringCompare(Str(), string.Str()) == 0);
+				(StringCompareCount(Str(), string.Str(), Length()) == 0);
 		}
 
 		Bool8 operator==(const SubStringType& substring) const
 		{
 			return (Length() == substring.Length()) &&
-				(StringCompare(Str(), substring.Str()) == 0);
+				(StringCompareCount(Str(), substring.Str(), Length()) == 0);
+		}
+
+		Bool8 operator==(const ViewType& view) const
+		{
+			return (Length() == view.Length()) &&
+				(StringCompareCount(Str(), view.Str(), Length()) == 0);
 		}
 
 		Bool8 operator==(const CharType* pString) const
@@ -173,6 +267,11 @@ namespace Quartz
 			return !operator==(substring);
 		}
 
+		Bool8 operator!=(const ViewType& view) const
+		{
+			return !operator==(view);
+		}
+
 		Bool8 operator!=(const CharType* pString) const
 		{
 			return !operator==(pString);
@@ -186,111 +285,225 @@ namespace Quartz
 
 		StringType operator+(const CharType* pString) const
 		{
-			return Append(*this, pString);
+			return Concat(*this, pString);
 		}
 
 		StringType operator+(const StringType& string) const
 		{
-			return Append(*this, string);
+			return Concat(*this, string);
+		}
+
+		StringType operator+(const ViewType& view) const
+		{
+			return Concat(*this, view);
 		}
 
 		friend StringType operator+(const CharType* pString1, const StringType& string2)
 		{
-			return Append(pString1, string2);
+			return Concat(pString1, string2);
 		}
 
 		StringType& operator+=(const CharType* pString)
 		{
-			*this = Append(*this, pString);
+			*this = Concat(*this, pString);
 			return *this;
 		}
 
 		StringType& operator+=(const StringType& string)
 		{
-			*this = Append(*this, string);
+			*this = Concat(*this, string);
 			return *this;
 		}
 
-		StringType& Resize(USize length)
+		StringType& operator+=(const ViewType& view)
 		{
-			const USize stringBufferSize = (length + 1) * charSize;
-			const USize fullBufferSize = metaSize + stringBufferSize;
-
-			const Byte* mpPrev = mpData;
+			*this = Concat(*this, view);
+			return *this;
+		}
 
-			mpData = new Byte[fullBufferSize];
-			mpMeta->count = ((StringMeta*)mpPrev)->count;
-			mpMeta->length = length;
+		/* Resizes into new unique storage, keeping as many characters as fit */
+		StringType& Resize(USize length)
+		{
+			const USize prevLength = Length();
 
-			reinterpret_cast<CharType*>(mpData + metaSize)[length] = 0;
+			StringType resized(this->GetAllocator());
+			resized.InitStorage(length);
+			memcpy(resized.Data(), Str(), (prevLength < length ? prevLength : length) * charSize);
 
-			delete mpPrev;
+			Swap(*this, resized);
 
 			return *this;
 		}
 
 		USize Hash() const
 		{
-			return StringHash(Str());
+			return StringHash(Str(), Length());
 		}
 
 		const CharType* Str() const
 		{
-			return reinterpret_cast<const CharType*>(mpData + metaSize);
+			return IsInline() ? mInline : reinterpret_cast<const CharType*>(mpData + metaSize);
 		}
 
 		CharType* Data()
 		{
-			return reinterpret_cast<CharType*>(mpData + metaSize);
+			return IsInline() ? mInline : reinterpret_cast<CharType*>(mpData + metaSize);
 		}
 
 		USize Length() const
 		{
-			return mpMeta->length;
+			return IsInline() ? mStorage[STORAGE_SIZE - 1] : mpMeta->length;
 		}
 
+		/* Inline strings are never shared */
 		USize RefCount() const
 		{
-			return mpMeta->count;
+			return IsInline() ? 1 : static_cast<USize>(mpMeta->count);
 		}
 
 		Bool8 IsUnique() const
 		{
-			return mpMeta->count == 1;
+			return RefCount() == 1;
 		}
 
 		Bool8 IsEmpty() const
 		{
-			return mpMeta->length == 0;
+			return Length() == 0;
 		}
 	};
 
+	/*
+		Non-owning view of a character range, cheap to pass by value wherever
+		a string is only read. Views of strings and substrings are not
+		guaranteed to be null-terminated.
+	*/
 	template<typename _CharType>
+	class StringViewBase
+	{
+	public:
+		using ViewType = StringViewBase<_CharType>;
+		using CharType = typename _CharType;
+
+	private:
+		static constexpr CharType EMPTY[1] = {};
+
+		const CharType*	mpData;
+		USize			mLength;
+
+	public:
+		constexpr StringViewBase()
+			: mpData(EMPTY), mLength(0) { }
+
+		StringViewBase(const CharType* pString)
+			: mpData(pString), mLength(StringLength(pString)) { }
+
+		constexpr StringViewBase(const CharType* pString, USize length)
+			: mpData(pString), mLength(length) { }
+
+		template<typename AllocatorType, Bool8 atomicRefCount>
+		StringViewBase(const StringBase<CharType, AllocatorType, atomicRefCount>& string)
+			: mpData(string.Str()), mLength(string.Length()) { }
+
+		template<typename AllocatorType, Bool8 atomicRefCount>
+		StringViewBase(const SubStringBase<CharType, AllocatorType, atomicRefCount>& substring)
+			: mpData(substring.Str()), mLength(substring.Length()) { }
+
+		Bool8 operator==(const ViewType& view) const
+		{
+			return (mLength == view.mLength) &&
+				(StringCompareCount(mpData, view.mpData, mLength) == 0);
+		}
+
+		Bool8 operator==(const CharType* pString) const
+		{
+			return (StringCompareCount(mpData, pString, mLength) == 0) &&
+				(pString[mLength] == 0);
+		}
+
+		Bool8 operator!=(const ViewType& view) const
+		{
+			return !operator==(view);
+		}
+
+		Bool8 operator!=(const CharType* pString) const
+		{
+			return !operator==(pString);
+		}
+
+		FORCE_INLINE const CharType& operator[](USize index) const
+		{
+			return mpData[index];
+		}
+
+		/* View of the characters in [start, end) */
+		ViewType SubView(USize start, USize end) const
+		{
+			assert(end >= start && "Substring end index is greater than start index!");
+			assert(end <= mLength && "Substring is out of bounds!");
+
+			return ViewType(mpData + start, end - start);
+		}
+
+		USize Hash() const
+		{
+			return StringHash(mpData, mLength);
+		}
+
+		FORCE_INLINE const CharType* Str() const
+		{
+			return mpData;
+		}
+
+		FORCE_INLINE USize Length() const
+		{
+			return mLength;
+		}
+
+		FORCE_INLINE Bool8 IsEmpty() const
+		{
+			return mLength == 0;
+		}
+
+		FORCE_INLINE const CharType* begin() const
+		{
+			return mpData;
+		}
+
+		FORCE_INLINE const CharType* end() const
+		{
+			return mpData + mLength;
+		}
+	};
+
+	template<typename _CharType, typename _Allocator, Bool8 atomicRefCount>
 	class SubStringBase
 	{
 	public:
-		friend class StringBase<_CharType>;
+		friend class StringBase<_CharType, _Allocator, atomicRefCount>;
 
 	public:
-		using StringType = StringBase<_CharType>;
-		using SubStringType = SubStringBase<_CharType>;
+		using StringType = StringBase<_CharType, _Allocator, atomicRefCount>;
+		using SubStringType = SubStringBase<_CharType, _Allocator, atomicRefCount>;
+		using ViewType = StringViewBase<_CharType>;
 		using CharType = typename _CharType;
 
 	protected:
 		USize mSubLength;
-		Byte* mpData;
+		USize mStart;
 
 		// By keeping a copy of the original,
 		// we guarantee the data is not deleted until
-		// all substrings are destroyed
+		// all substrings are destroyed. Characters are
+		// addressed by offset since short strings are
+		// stored inside the copy.
 		StringType	mSrcString;
 
 	public:
 		SubStringBase()
-			: mSubLength(0), mpData(nullptr), mSrcString() {}
+			: mSubLength(0), mStart(0), mSrcString() {}
 
 		SubStringBase(const SubStringType& substring)
-			: mSubLength(substring.mSubLength), mpData(substring.mpData), mSrcString(substring.mSrcString) {}
+			: mSubLength(substring.mSubLength), mStart(substring.mStart), mSrcString(substring.mSrcString) {}
 
 		SubStringBase(SubStringType&& rSubstring) noexcept :
 			SubStringType()
@@ -305,7 +518,7 @@ namespace Quartz
 			assert(start <= string.Length() && end <= string.Length() && "Substring is out of bounds!");
 
 			mSubLength = end - start;
-			mpData = reinterpret_cast<Byte*>(string.Data() + start);
+			mStart = start;
 		}
 
 		SubStringBase(SubStringType& substring, USize start, USize end)
@@ -315,14 +528,14 @@ namespace Quartz
 			assert(start <= substring.Length() && end <= substring.Length() && "Substring is out of bounds!");
 
 			mSubLength = end - start;
-			mpData = reinterpret_cast<Byte*>(substring.Data() + start);
+			mStart = substring.mStart + start;
 		}
 
 		friend void Swap(SubStringType& substring1, SubStringType& substring2)
 		{
 			using Quartz::Swap;
 			Swap(substring1.mSubLength, substring2.mSubLength);
-			Swap(substring1.mpData, substring2.mpData);
+			Swap(substring1.mStart, substring2.mStart);
 			Swap(substring1.mSrcString, substring2.mSrcString);
 		}
 
@@ -338,9 +551,16 @@ namespace Quartz
 				(StringCompareCount(Str(), substring.Str(), mSubLength) == 0);
 		}
 
+		Bool8 operator==(const ViewType& view) const
+		{
+			return (mSubLength == view.Length()) &&
+				(StringCompareCount(Str(), view.Str(), mSubLength) == 0);
+		}
+
 		Bool8 operator==(const CharType* pString) const
 		{
-			return StringCompareCount(Str(), pString, mSubLength) == 0;
+			return (StringCompareCount(Str(), pString, mSubLength) == 0) &&
+				(pString[mSubLength] == 0);
 		}
 
 		Bool8 operator!=(const StringType& string) const
@@ -353,6 +573,11 @@ namespace Quartz
 			return !operator==(substring);
 		}
 
+		Bool8 operator!=(const ViewType& view) const
+		{
+			return !operator==(view);
+		}
+
 		Bool8 operator!=(const CharType* pString) const
 		{
 			return !operator==(pString);
@@ -366,22 +591,22 @@ namespace Quartz
 
 		operator StringType()
 		{
-			return String(Str(), mSubLength);
+			return StringType(Str(), mSubLength, mSrcString.GetAllocator());
 		}
 
 		USize Hash() const
 		{
-			return StringHash(Str());
+			return StringHash(Str(), Length());
 		}
 
 		const CharType* Str() const
 		{
-			return reinterpret_cast<const CharType*>(mpData);
+			return mSrcString.Str() + mStart;
 		}
 
 		CharType* Data()
 		{
-			return reinterpret_cast<CharType*>(mpData);
+			return mSrcString.Data() + mStart;
 		}
 
 		USize Length() const
@@ -426,47 +651,27 @@ namespace Quartz
 		return static_cast<USize>(wcsncmp(pString1, pString2, count));
 	}
 
-	template<>
-	FORCE_INLINE UInt32 StringHash<char>(const char* pString)
-	{
-		// MurmurOAAT64 Hash
-
-		UInt64 hash = 525201411107845655ull;
-
-		while (*(pString++))
-		{
-			hash ^= *pString;
-			hash *= 0x5bd1e9955bd1e995;
-			hash ^= hash >> 47;
-		}
-
-		return static_cast<UInt32>(hash);
-	}
-
-	template<>
-	FORCE_INLINE UInt32 StringHash<wchar_t>(const wchar_t* pString)
-	{
-		// MurmurOAAT64 Hash
-
-		UInt64 hash = 525201411107845655ull;
-
-		while (*(pString++))
-		{
-			hash ^= *pString;
-			hash *= 0x5bd1e9955bd1e995;
-			hash ^= hash >> 47;
-		}
-
-		return static_cast<UInt32>(hash);
-	}
-
 	using StringA = StringBase<char>;
 	using StringW = StringBase<wchar_t>;
 	using SubStringA = SubStringBase<char>;
 	using SubStringW = SubStringBase<wchar_t>;
+	using StringViewA = StringViewBase<char>;
+	using StringViewW = StringViewBase<wchar_t>;
+
+	/* Strings that may be copied and released from several threads */
+	using SharedStringA = StringBase<char, HeapAllocator, true>;
+	using SharedStringW = StringBase<wchar_t, HeapAllocator, true>;
 
 	using String = StringA;
 	using SubString = SubStringA;
+	using StringView = StringViewA;
+	using SharedString = SharedStringA;
+
+	template<typename CharType, typename AllocatorType, Bool8 atomicRefCount>
+	struct IsTriviallyRelocatable<StringBase<CharType, AllocatorType, atomicRefCount>> : public IsTriviallyRelocatable<AllocatorType> {};
+
+	template<typename CharType, typename AllocatorType, Bool8 atomicRefCount>
+	struct IsTriviallyRelocatable<SubStringBase<CharType, AllocatorType, atomicRefCount>> : public IsTriviallyRelocatable<AllocatorType> {};
 
 	template<>
 	FORCE_INLINE UInt32 Hash<String>(const String& value)
@@ -480,39 +685,84 @@ namespace Quartz
 		return static_cast<UInt32>(value.Hash());
 	}
 
-	// @Todo: Speed up
-	FORCE_INLINE StringW StringAToStringW(const StringA& stringA)
+	template<>
+	FORCE_INLINE UInt32 Hash<StringView>(const StringView& value)
+	{
+		return static_cast<UInt32>(value.Hash());
+	}
+
+	template<>
+	FORCE_INLINE UInt32 Hash<StringViewW>(const StringViewW& value)
+	{
+		return static_cast<UInt32>(value.Hash());
+	}
+
+	/* Strings can be looked up by null-terminated character arrays, substrings or views */
+
+	template<typename CharType, typename AllocatorType, Bool8 atomicRefCount>
+	struct TransparentHash<StringBase<CharType, AllocatorType, atomicRefCount>, const CharType*>
+	{
+		using LookupType = const CharType*;
+
+		static FORCE_INLINE UInt32 Hash(const CharType* pString)
+		{
+			return StringHash(pString);
+		}
+	};
+
+	template<typename CharType, typename AllocatorType, Bool8 atomicRefCount>
+	struct TransparentHash<StringBase<CharType, AllocatorType, atomicRefCount>, CharType*>
+		: public TransparentHash<StringBase<CharType, AllocatorType, atomicRefCount>, const CharType*> { };
+
+	template<typename CharType, typename AllocatorType, Bool8 atomicRefCount>
+	struct TransparentHash<StringBase<CharType, AllocatorType, atomicRefCount>, SubStringBase<CharType, AllocatorType, atomicRefCount>>
+	{
+		using LookupType = SubStringBase<CharType, AllocatorType, atomicRefCount>;
+
+		static FORCE_INLINE UInt32 Hash(const LookupType& substring)
+		{
+			return static_cast<UInt32>(substring.Hash());
+		}
+	};
+
+	template<typename CharType, typename AllocatorType, Bool8 atomicRefCount>
+	struct TransparentHash<StringBase<CharType, AllocatorType, atomicRefCount>, StringViewBase<CharType>>
+	{
+		using LookupType = StringViewBase<CharType>;
+
+		static FORCE_INLINE UInt32 Hash(const LookupType& view)
+		{
+			return static_cast<UInt32>(view.Hash());
+		}
+	};
+
+	FORCE_INLINE StringW StringAToStringW(const StringViewA& stringA)
 	{
 		StringW wide;
 		wide.Resize(stringA.Length());
 
-		char* pStr = const_cast<StringA&>(stringA).Data();
+		const char* pStr = stringA.Str();
 		wchar_t* pWide = wide.Data();
 
-		while (*pStr)
+		for (USize i = 0; i < stringA.Length(); i++)
 		{
-			*pWide = (wchar_t)*pStr;
-			++pWide;
-			++pStr;
+			pWide[i] = (wchar_t)pStr[i];
 		}
 
 		return wide;
 	}
 
-	// @Todo: Speed up
-	FORCE_INLINE StringA StringWToStringA(const StringW& stringW)
+	FORCE_INLINE StringA StringWToStringA(const StringViewW& stringW)
 	{
 		StringA ascii;
 		ascii.Resize(stringW.Length());
 
-		wchar_t* pStr = const_cast<StringW&>(stringW).Data();
+		const wchar_t* pStr = stringW.Str();
 		char* pAscii = ascii.Data();
 
-		while (*pStr)
+		for (USize i = 0; i < stringW.Length(); i++)
 		{
-			*pAscii = *reinterpret_cast<char*>(pStr);
-			++pAscii;
-			++pStr;
+			pAscii[i] = (char)pStr[i];
 		}
 
 		return ascii;
@@ -1,8 +1,21 @@
 #pragma once
 
 #include "String.h"
+#include "Utils.h"
 
-#include <string>
+#include <cmath>
+#include <cstdlib>
+#include <limits>
+
+#if (defined(_M_X64) || defined(__SSE2__)) && !defined(NO_INTRINSICS)
+#define INTRIN_SSE2
+#include <emmintrin.h>
+#endif
+
+#if defined(__AVX2__) && !defined(NO_INTRINSICS)
+#define INTRIN_AVX2
+#include <immintrin.h>
+#endif
 
 namespace Quartz
 {
@@ -21,67 +34,491 @@ namespace Quartz
 	template<typename CharType>
 	constexpr CharType SPACE_SYMBOL = ' ';
 
+	//////////////////////////////////////////////////////////////
+	// Scanning
+	//////////////////////////////////////////////////////////////
+
+	/* Space, tab or carriage return. Newlines separate records and are not skipped */
+	template<typename CharType>
+	FORCE_INLINE Bool8 IsWhitespace(CharType value)
+	{
+		return value == ' ' || value == '\t' || value == '\r';
+	}
+
+	template<typename CharType>
+	FORCE_INLINE Bool8 IsDigit(CharType value)
+	{
+		return static_cast<UInt32>(value - '0') < 10;
+	}
+
+	/*
+		Returns the first character in [pBegin, pEnd) equal to value, or pEnd.
+		Single byte strings are compared 32 (AVX2) or 16 (SSE2) characters
+		at a time.
+	*/
+	template<typename CharType>
+	const CharType* FindChar(const CharType* pBegin, const CharType* pEnd, CharType value)
+	{
+		if constexpr (sizeof(CharType) == 1)
+		{
+#ifdef INTRIN_AVX2
+			const __m256i target32 = _mm256_set1_epi8(static_cast<char>(value));
+
+			for (; pEnd - pBegin >= 32; pBegin += 32)
+			{
+				const __m256i chunk = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(pBegin));
+				const UInt32 mask = static_cast<UInt32>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(chunk, target32)));
+
+				if (mask != 0)
+				{
+					return pBegin + CountTrailingZeros(mask);
+				}
+			}
+#endif
+#ifdef INTRIN_SSE2
+			const __m128i target16 = _mm_set1_epi8(static_cast<char>(value));
+
+			for (; pEnd - pBegin >= 16; pBegin += 16)
+			{
+				const __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pBegin));
+				const UInt32 mask = static_cast<UInt32>(_mm_movemask_epi8(_mm_cmpeq_epi8(chunk, target16)));
+
+				if (mask != 0)
+				{
+					return pBegin + CountTrailingZeros(mask);
+				}
+			}
+#endif
+		}
+
+		for (; pBegin != pEnd && *pBegin != value; ++pBegin);
+
+		return pBegin;
+	}
+
+	/* Returns the first character in [pBegin, pEnd) that is not whitespace, or pEnd */
+	template<typename CharType>
+	const CharType* SkipWhitespace(const CharType* pBegin, const CharType* pEnd)
+	{
+		if constexpr (sizeof(CharType) == 1)
+		{
+			// Short runs are the common case, check before loading a vector
+			if (pBegin != pEnd && !IsWhitespace(*pBegin))
+			{
+				return pBegin;
+			}
+
+#ifdef INTRIN_AVX2
+			const __m256i space32	= _mm256_set1_epi8(' ');
+			const __m256i tab32		= _mm256_set1_epi8('\t');
+			const __m256i return32	= _mm256_set1_epi8('\r');
+
+			for (; pEnd - pBegin >= 32; pBegin += 32)
+			{
+				const __m256i chunk = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(pBegin));
+				const __m256i blank = _mm256_or_si256(_mm256_cmpeq_epi8(chunk, space32),
+					_mm256_or_si256(_mm256_cmpeq_epi8(chunk, tab32), _mm256_cmpeq_epi8(chunk, return32)));
+				const UInt32 mask = ~static_cast<UInt32>(_mm256_movemask_epi8(blank));
+
+				if (mask != 0)
+				{
+					return pBegin + CountTrailingZeros(mask);
+				}
+			}
+#endif
+#ifdef INTRIN_SSE2
+			const __m128i space16	= _mm_set1_epi8(' ');
+			const __m128i tab16		= _mm_set1_epi8('\t');
+			const __m128i return16	= _mm_set1_epi8('\r');
+
+			for (; pEnd - pBegin >= 16; pBegin += 16)
+			{
+				const __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pBegin));
+				const __m128i blank = _mm_or_si128(_mm_cmpeq_epi8(chunk, space16),
+					_mm_or_si128(_mm_cmpeq_epi8(chunk, tab16), _mm_cmpeq_epi8(chunk, return16)));
+				const UInt32 mask = ~static_cast<UInt32>(_mm_movemask_epi8(blank)) & 0xFFFF;
+
+				if (mask != 0)
+				{
+					return pBegin + CountTrailingZeros(mask);
+				}
+			}
+#endif
+		}
+
+		for (; pBegin != pEnd && IsWhitespace(*pBegin); ++pBegin);
+
+		return pBegin;
+	}
+
+	//////////////////////////////////////////////////////////////
+	// Number Parsing
+	//////////////////////////////////////////////////////////////
+
+	/* A decimal number as mantissa * 10^exponent, with up to 19 significant digits */
+	struct ParsedDecimal
+	{
+		UInt64	mantissa;
+		Int64	exponent;
+		Bool8	negative;
+		Bool8	truncated;	// Non-zero digits past the 19th were dropped
+	};
+
+	/*
+		Scans [sign] digits [. digits] [(e|E) [sign] digits] into decimal.
+		Returns the end of the number, or nullptr if no digits were found.
+	*/
+	template<typename CharType>
+	const CharType* ScanDecimal(const CharType* pRead, const CharType* pEnd, ParsedDecimal& decimal)
+	{
+		constexpr UInt32 MAX_DIGITS = 19;
+
+		UInt64 mantissa = 0;
+		Int64 exponent = 0;
+		UInt32 digits = 0;
+		Bool8 truncated = false;
+
+		decimal.negative = false;
+
+		if (pRead != pEnd && (*pRead == '-' || *pRead == '+'))
+		{
+			decimal.negative = *pRead == '-';
+			++pRead;
+		}
+
+		const CharType* pInteger = pRead;
+
+		for (; pRead != pEnd && IsDigit(*pRead); ++pRead)
+		{
+			if (digits < MAX_DIGITS)
+			{
+				mantissa = mantissa * 10 + static_cast<UInt64>(*pRead - '0');
+				digits += mantissa != 0;
+			}
+			else
+			{
+				truncated |= *pRead != '0';
+				exponent++;
+			}
+		}
+
+		Bool8 anyDigits = pRead != pInteger;
+
+		if (pRead != pEnd && *pRead == '.')
+		{
+			const CharType* pFraction = ++pRead;
+
+			for (; pRead != pEnd && IsDigit(*pRead); ++pRead)
+			{
+				if (digits < MAX_DIGITS)
+				{
+					mantissa = mantissa * 10 + static_cast<UInt64>(*pRead - '0');
+					digits += mantissa != 0;
+					exponent--;
+				}
+				else
+				{
+					truncated |= *pRead != '0';
+				}
+			}
+
+			anyDigits |= pRead != pFraction;
+		}
+
+		if (!anyDigits)
+		{
+			return nullptr;
+		}
+
+		if (pRead != pEnd && (*pRead == 'e' || *pRead == 'E'))
+		{
+			const CharType* pExponent = pRead + 1;
+			Bool8 negativeExponent = false;
+
+			if (pExponent != pEnd && (*pExponent == '-' || *pExponent == '+'))
+			{
+				negativeExponent = *pExponent == '-';
+				++pExponent;
+			}
+
+			// Without digits the 'e' is not part of the number
+			if (pExponent != pEnd && IsDigit(*pExponent))
+			{
+				Int64 explicitExponent = 0;
+
+				for (; pExponent != pEnd && IsDigit(*pExponent); ++pExponent)
+				{
+					// Far beyond the range of a double, only needs to stay large
+					if (explicitExponent < 100000)
+					{
+						explicitExponent = explicitExponent * 10 + (*pExponent - '0');
+					}
+				}
+
+				exponent += negativeExponent ? -explicitExponent : explicitExponent;
+				pRead = pExponent;
+			}
+		}
+
+		decimal.mantissa	= mantissa;
+		decimal.exponent	= exponent;
+		decimal.truncated	= truncated;
+
+		return pRead;
+	}
+
+	/* Converts with the C runtime, for inputs the exact fast paths cannot handle */
+	template<typename FloatType, typename CharType>
+	FloatType ParseFloatSlow(const CharType* pBegin, const CharType* pEnd, const CharType** ppEnd)
+	{
+		char buffer[128];
+		USize length = 0;
+
+		// strtod would skip newlines and parse the next record
+		if (pBegin == pEnd || static_cast<UInt32>(*pBegin) <= ' ')
+		{
+			*ppEnd = pBegin;
+			return 0;
+		}
+
+		// Copy so the runtime stops at pEnd, numbers are always ASCII
+		for (const CharType* pRead = pBegin; pRead != pEnd && length < sizeof(buffer) - 1; ++pRead)
+		{
+			buffer[length++] = static_cast<char>(*pRead);
+		}
+
+		buffer[length] = '\0';
+
+		char* pBufferEnd = nullptr;
+		FloatType value;
+
+		if constexpr (sizeof(FloatType) == sizeof(Float32))
+		{
+			value = strtof(buffer, &pBufferEnd);
+		}
+		else
+		{
+			value = strtod(buffer, &pBufferEnd);
+		}
+
+		*ppEnd = pBegin + (pBufferEnd - buffer);
+
+		return value;
+	}
+
+	/* Exactly representable powers of ten */
+	constexpr Double64 EXACT_POWERS_OF_TEN[] =
+	{
+		1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+		1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+	};
+
+	/*
+		Correctly rounded when mantissa and 10^exponent are both exact
+		doubles, as a single multiply or divide then rounds once (Clinger).
+		Returns false when the fast path does not apply.
+	*/
+	FORCE_INLINE Bool8 DecimalToDouble(const ParsedDecimal& decimal, Double64& value)
+	{
+		constexpr UInt64 MAX_EXACT_MANTISSA = 1ull << 53;
+
+		if (decimal.mantissa == 0 && !decimal.truncated)
+		{
+			value = decimal.negative ? -0.0 : 0.0;
+			return true;
+		}
+
+		if (decimal.truncated || decimal.mantissa > MAX_EXACT_MANTISSA ||
+			decimal.exponent < -22 || decimal.exponent > 22)
+		{
+			return false;
+		}
+
+		value = static_cast<Double64>(decimal.mantissa);
+		value = decimal.exponent < 0 ?
+			value / EXACT_POWERS_OF_TEN[-decimal.exponent] :
+			value * EXACT_POWERS_OF_TEN[decimal.exponent];
+
+		if (decimal.negative)
+		{
+			value = -value;
+		}
+
+		return true;
+	}
+
+	/*
+		Parses a decimal integer, skipping leading whitespace. Out of range
+		values saturate. ppEnd receives the end of the number, or pBegin if
+		no digits were found.
+	*/
+	template<typename CharType>
+	Int64 ParseInt(const CharType* pBegin, const CharType* pEnd, const CharType** ppEnd)
+	{
+		const CharType* pRead = SkipWhitespace(pBegin, pEnd);
+		Bool8 negative = false;
+
+		if (pRead != pEnd && (*pRead == '-' || *pRead == '+'))
+		{
+			negative = *pRead == '-';
+			++pRead;
+		}
+
+		const CharType* pDigits = pRead;
+		UInt64 value = 0;
+		Bool8 overflow = false;
+
+		for (; pRead != pEnd && IsDigit(*pRead); ++pRead)
+		{
+			const UInt64 digit = static_cast<UInt64>(*pRead - '0');
+			overflow |= value > (std::numeric_limits<UInt64>::max() - digit) / 10;
+			value = value * 10 + digit;
+		}
+
+		if (pRead == pDigits)
+		{
+			*ppEnd = pBegin;
+			return 0;
+		}
+
+		*ppEnd = pRead;
+
+		constexpr UInt64 MAX_POSITIVE = static_cast<UInt64>(std::numeric_limits<Int64>::max());
+
+		if (negative)
+		{
+			return overflow || value > MAX_POSITIVE + 1 ?
+				std::numeric_limits<Int64>::min() : static_cast<Int64>(0 - value);
+		}
+
+		return overflow || value > MAX_POSITIVE ?
+			std::numeric_limits<Int64>::max() : static_cast<Int64>(value);
+	}
+
+	/*
+		Parses a correctly rounded double, skipping leading whitespace. Up to
+		15 significant digits with small exponents take an exact fast path,
+		anything else (and inf/nan) goes through strtod.
+	*/
 	template<typename CharType>
-	Float32 ReadFloat2(CharType* pStr, CharType** ppEnd)
+	Double64 ParseDouble(const CharType* pBegin, const CharType* pEnd, const CharType** ppEnd)
 	{
-		return 0.0f;
+		const CharType* pStart = SkipWhitespace(pBegin, pEnd);
+
+		ParsedDecimal decimal;
+		const CharType* pRead = ScanDecimal(pStart, pEnd, decimal);
+		Double64 value;
+
+		if (pRead != nullptr && DecimalToDouble(decimal, value))
+		{
+			*ppEnd = pRead;
+			return value;
+		}
+
+		value = ParseFloatSlow<Double64>(pStart, pEnd, ppEnd);
+
+		if (*ppEnd == pStart)
+		{
+			*ppEnd = pBegin;
+		}
+
+		return value;
 	}
 
+	/*
+		Parses a correctly rounded float, skipping leading whitespace. Rounding
+		the exact double again to float is only wrong when the double lands
+		exactly halfway between two floats, which falls back to strtof.
+	*/
 	template<typename CharType>
-	Int64 ReadInt2(CharType* pStr, CharType** ppEnd)
+	Float32 ParseFloat(const CharType* pBegin, const CharType* pEnd, const CharType** ppEnd)
 	{
-		return 0;
+		const CharType* pStart = SkipWhitespace(pBegin, pEnd);
+
+		ParsedDecimal decimal;
+		const CharType* pRead = ScanDecimal(pStart, pEnd, decimal);
+		Double64 exact;
+
+		if (pRead != nullptr && DecimalToDouble(decimal, exact))
+		{
+			const Float32 value = static_cast<Float32>(exact);
+
+			if (static_cast<Double64>(value) == exact)
+			{
+				*ppEnd = pRead;
+				return value;
+			}
+
+			const Float32 neighbour = std::nextafter(value, exact > value ?
+				std::numeric_limits<Float32>::infinity() : -std::numeric_limits<Float32>::infinity());
+
+			if ((static_cast<Double64>(value) + static_cast<Double64>(neighbour)) * 0.5 != exact)
+			{
+				*ppEnd = pRead;
+				return value;
+			}
+		}
+
+		Float32 value = ParseFloatSlow<Float32>(pStart, pEnd, ppEnd);
+
+		if (*ppEnd == pStart)
+		{
+			*ppEnd = pBegin;
+		}
+
+		return value;
 	}
 
+	/*
+		Reads tokens from a string without copying it. Returned views point
+		into the parsed string, which must outlive them.
+	*/
 	template<typename _CharType>
 	class StringParserBase
 	{
 	public:
 		using StringType = StringBase<_CharType>;
 		using SubStringType = SubStringBase<_CharType>;
+		using ViewType = StringViewBase<_CharType>;
 		using CharType = typename _CharType;
 
 	private:
-		CharType*		mpHead;
-		SubStringType	mSubString;
+		const CharType*	mpHead;
+		ViewType		mView;
 
-		UInt32 IndexOf(CharType* pChar)
+		UInt32 IndexOf(const CharType* pChar)
 		{
-			return pChar - mSubString.Str();
+			return pChar - mView.Str();
 		}
 
-		Bool8 IsEnd(CharType* pChar)
+		Bool8 IsEnd(const CharType* pChar)
 		{
-			return pChar == (mSubString.Str() + mSubString.Length());
+			return pChar == mView.end();
 		}
 
 	public:
-		explicit StringParserBase(const StringType& string)
-			: mSubString(const_cast<StringType&>(string), 0, string.Length()), mpHead(const_cast<StringType&>(string).Data()) { }
-
-		explicit StringParserBase(const SubStringType& substring)
-			: mSubString(substring), mpHead(const_cast<SubStringType&>(substring).Data()) { }
+		explicit StringParserBase(const ViewType& view)
+			: mpHead(view.Str()), mView(view) { }
 
 		CharType PeakChar()
 		{
 			return *mpHead;
 		}
 
-		SubStringType ReadToChar(CharType value)
+		ViewType ReadToChar(CharType value)
 		{
-			CharType* mpRead = mpHead;
-			for (; *mpRead != value && !IsEnd(mpRead); ++mpRead);
+			const CharType* mpRead = FindChar(mpHead, mView.end(), value);
 
-			SubStringType result(mSubString, IndexOf(mpHead), IndexOf(mpRead));
+			ViewType result = mView.SubView(IndexOf(mpHead), IndexOf(mpRead));
 
 			mpHead = mpRead;
 
 			return result;
 		}
 
-		SubStringType ReadLine()
+		ViewType ReadLine()
 		{
-			SubStringType result = ReadToChar(NEW_LINE<CharType>);
+			ViewType result = ReadToChar(NEW_LINE<CharType>);
 
 			// Skip '\n'
 			AdvanceChar();
@@ -91,8 +528,18 @@ namespace Quartz
 
 		Float32 ReadFloat()
 		{
-			CharType* mpRead = nullptr;
-			Float32 value = ReadFloat2<CharType>(mpHead, &mpRead);
+			const CharType* mpRead = nullptr;
+			Float32 value = ParseFloat(mpHead, mView.end(), &mpRead);
+
+			mpHead = mpRead;
+
+			return value;
+		}
+
+		Double64 ReadDouble()
+		{
+			const CharType* mpRead = nullptr;
+			Double64 value = ParseDouble(mpHead, mView.end(), &mpRead);
 
 			mpHead = mpRead;
 
@@ -101,8 +548,8 @@ namespace Quartz
 
 		Int32 ReadInt()
 		{
-			CharType* mpRead = nullptr;
-			Int64 value = ReadInt2<CharType>(mpHead, &mpRead);
+			const CharType* mpRead = nullptr;
+			Int64 value = ParseInt(mpHead, mView.end(), &mpRead);
 
 			mpHead = mpRead;
 
@@ -111,8 +558,8 @@ namespace Quartz
 
 		Int64 ReadLong()
 		{
-			CharType* mpRead = nullptr;
-			Int32 value = ReadInt2<CharType>(mpHead, &mpRead);
+			const CharType* mpRead = nullptr;
+			Int64 value = ParseInt(mpHead, mView.end(), &mpRead);
 
 			mpHead = mpRead;
 
@@ -129,9 +576,7 @@ namespace Quartz
 
 		void AdvanceWhitespace()
 		{
-			for (; (*mpHead == SPACE_SYMBOL<CharType> || 
-					*mpHead == TAB_SYMBOL<CharType> || 
-					*mpHead == CARRIAGE_RETURN<CharType>) && !IsEnd(); ++mpHead);
+			mpHead = SkipWhitespace(mpHead, mView.end());
 		}
 
 		Bool8 IsEnd()
@@ -152,32 +597,8 @@ namespace Quartz
 	template<> constexpr char SPACE_SYMBOL<char> = ' ';
 	template<> constexpr wchar_t SPACE_SYMBOL<wchar_t> = L' ';
 
-	template<>
-	FORCE_INLINE Float32 ReadFloat2<char>(char* pStr, char** ppEnd)
-	{
-		return strtof(pStr, ppEnd);
-	}
-
-	template<>
-	FORCE_INLINE Float32 ReadFloat2<wchar_t>(wchar_t* pStr, wchar_t** ppEnd)
-	{
-		return wcstof(pStr, ppEnd);
-	}
-
-	template<>
-	FORCE_INLINE Int64 ReadInt2<char>(char* pStr, char** ppEnd)
-	{
-		return strtol(pStr, ppEnd, 0);
-	}
-
-	template<>
-	FORCE_INLINE Int64 ReadInt2<wchar_t>(wchar_t* pStr, wchar_t** ppEnd)
-	{
-		return wcstol(pStr, ppEnd, 0);
-	}
-
 	using StringParserA = StringParserBase<char>;
 	using StringParserW = StringParserBase<wchar_t>;
 
 	using StringParser = StringParserA;
-}
\ No newline at end of file
+}
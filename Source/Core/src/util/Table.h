@@ -1,131 +1,169 @@
 #pragma once
 
-#include "Array.h"
+#include "../Common.h"
+#include "../memory/Allocator.h"
 #include "Hash.h"
 #include "Utils.h"
+#include "Utility.h"
+
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <utility>
+
+#if !defined(NO_INTRINSICS) && (defined(_M_X64) || defined(_M_AMD64) || \
+	(defined(_M_IX86_FP) && _M_IX86_FP >= 2) || defined(__SSE2__))
+#define TABLE_SSE2
+#include <emmintrin.h>
+#endif
 
 namespace Quartz
 {
-	template<typename _KeyValueType>
-	class TableEntry
+	/*
+		Control bytes describe the state of every slot in the table.
+		A full slot stores the low 7 bits of its hash (always positive),
+		empty and deleted slots have the high bit set. Deleted slots keep
+		probe runs intact until the table is rehashed.
+	*/
+	typedef Int8 TableControl;
+
+	constexpr TableControl TABLE_CONTROL_EMPTY		= static_cast<TableControl>(0x80);
+	constexpr TableControl TABLE_CONTROL_DELETED	= static_cast<TableControl>(0xFE);
+
+	/* Shared control group for tables that have not allocated yet */
+	alignas(16) inline const TableControl TABLE_EMPTY_GROUP[16] =
 	{
-	public:
-		using TableEntryType	= TableEntry<_KeyValueType>;
-		using KeyValueType		= _KeyValueType;
+		TABLE_CONTROL_EMPTY, TABLE_CONTROL_EMPTY, TABLE_CONTROL_EMPTY, TABLE_CONTROL_EMPTY,
+		TABLE_CONTROL_EMPTY, TABLE_CONTROL_EMPTY, TABLE_CONTROL_EMPTY, TABLE_CONTROL_EMPTY,
+		TABLE_CONTROL_EMPTY, TABLE_CONTROL_EMPTY, TABLE_CONTROL_EMPTY, TABLE_CONTROL_EMPTY,
+		TABLE_CONTROL_EMPTY, TABLE_CONTROL_EMPTY, TABLE_CONTROL_EMPTY, TABLE_CONTROL_EMPTY
+	};
 
+	/*
+		A window of 16 control bytes, matched all at once.
+		Every match returns a bitmask where bit N refers to the Nth byte.
+	*/
+	class TableGroup
+	{
 	public:
-		KeyValueType	keyValue;
-		UInt32			hash;
+		constexpr static UInt32 WIDTH = 16;
 
-		union
-		{
-			struct
-			{
-			Bool8 isFirst : 1;
-			Bool8 isLast : 1;
-			UInt8 reserved : 5;
-			Bool8 isDeleted : 1;
-			};
-
-			UInt8 meta;
-		};
+	private:
+#ifdef TABLE_SSE2
+		__m128i mControl;
+#else
+		TableControl mControl[WIDTH];
+#endif
 
 	public:
-		TableEntry() :
-			keyValue(), hash(0), meta(0) { }
-
-		TableEntry(UInt32 hash, KeyValueType&& keyValue) :
-			hash(hash), keyValue(Move(keyValue)), meta(0) {}
+#ifdef TABLE_SSE2
+		FORCE_INLINE explicit TableGroup(const TableControl* pControl)
+			: mControl(_mm_loadu_si128(reinterpret_cast<const __m128i*>(pControl))) { }
 
-		TableEntry(UInt32 hash, const KeyValueType& keyValue) :
-			hash(hash), keyValue(keyValue), meta(0) {}
-
-		TableEntry(const TableEntry& entry) :
-			hash(entry.hash), keyValue(entry.keyValue), meta(entry.meta) {}
-
-		TableEntry(TableEntry&& entry) noexcept :
-			TableEntry()
+		FORCE_INLINE UInt32 Match(TableControl value) const
 		{
-			Swap(*this, entry);
+			return static_cast<UInt32>(_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_set1_epi8(value), mControl)));
 		}
 
-		TableEntryType& operator=(TableEntryType entry)
+		FORCE_INLINE UInt32 MatchEmpty() const
 		{
-			Swap(*this, entry);
-			return *this;
+			return Match(TABLE_CONTROL_EMPTY);
 		}
 
-		friend void Swap(TableEntryType& entry1, TableEntryType& entry2)
+		FORCE_INLINE UInt32 MatchEmptyOrDeleted() const
 		{
-			using Quartz::Swap;
-			Swap(entry1.hash, entry2.hash);
-			Swap(entry1.keyValue, entry2.keyValue);
-			// Dont swap meta
+			// Only empty and deleted control bytes have the sign bit set
+			return static_cast<UInt32>(_mm_movemask_epi8(mControl));
+		}
+#else
+		FORCE_INLINE explicit TableGroup(const TableControl* pControl)
+		{
+			memcpy(mControl, pControl, WIDTH);
 		}
 
-		Bool8 IsEmpty()
+		FORCE_INLINE UInt32 Match(TableControl value) const
 		{
-			return hash == 0;
+			UInt32 mask = 0;
+
+			for (UInt32 i = 0; i < WIDTH; i++)
+			{
+				mask |= static_cast<UInt32>(mControl[i] == value) << i;
+			}
+
+			return mask;
 		}
 
-		Bool8 IsDeleted()
+		FORCE_INLINE UInt32 MatchEmpty() const
 		{
-			return isDeleted;
+			return Match(TABLE_CONTROL_EMPTY);
 		}
 
-		Bool8 IsFirst()
+		FORCE_INLINE UInt32 MatchEmptyOrDeleted() const
 		{
-			return isFirst;
+			UInt32 mask = 0;
+
+			for (UInt32 i = 0; i < WIDTH; i++)
+			{
+				mask |= static_cast<UInt32>(mControl[i] < 0) << i;
+			}
+
+			return mask;
 		}
+#endif
 
-		Bool8 IsLast()
+		FORCE_INLINE UInt32 MatchFull() const
 		{
-			return isLast;
+			return ~MatchEmptyOrDeleted() & 0xFFFF;
 		}
 	};
 
-	template<typename _KeyValueType>
-	class Table
+	/*
+		Open-addressing hash table (SwissTable style).
+
+		Memory is one block split into three arrays: the slots holding
+		the key/values, the full 32-bit hashes (only read when moving entries)
+		and the control bytes. Lookups scan the control bytes one group at a
+		time and only touch slots whose 7-bit hash tag matches.
+
+		Probes walk aligned groups, so erasing only leaves a deleted marker
+		when the slot's own group is full, since a probe may have passed over
+		it. Otherwise the slot becomes empty again. Deleted markers count
+		towards the load and are dropped the next time the table is rehashed.
+
+		WARNING: Insert may rehash and move every entry. Pointers, references
+		and iterators are invalidated by it. Remove only invalidates the
+		removed entry.
+	*/
+	template<typename _KeyValueType, typename _Allocator = HeapAllocator>
+	class Table : public AllocatorStorage<_Allocator>
 	{
 	public:
-		using KeyValueType = _KeyValueType;
-		using TableType = Table<KeyValueType>;
-		using TableEntryType = TableEntry<KeyValueType>;
-
-		constexpr static Float32	LOAD_FACTOR = 0.85f;
-		constexpr static USize		INITAL_SIZE = 16;
+		using KeyValueType	= _KeyValueType;
+		using AllocatorType	= _Allocator;
+		using TableType		= Table<KeyValueType, AllocatorType>;
 
-		constexpr static UInt32		ERASED_BIT = (0x1 << 31);
+		constexpr static UInt32 GROUP_WIDTH		= TableGroup::WIDTH;
+		constexpr static UInt32 INITAL_SIZE		= GROUP_WIDTH;
 
 		class Iterator
 		{
 		private:
-			TableEntryType* pItr;
+			TableType*	pTable;
+			UInt32		index;
 
 		public:
 			Iterator()
-				: pItr(nullptr) { }
+				: pTable(nullptr), index(0) { }
 
-			Iterator(TableEntryType* pItr)
-				: pItr(pItr) { }
+			Iterator(TableType* pTable, UInt32 index)
+				: pTable(pTable), index(index) { }
 
 			Iterator(const Iterator& it)
-				: pItr(it.pItr) { }
+				: pTable(it.pTable), index(it.index) { }
 
 			Iterator& operator++()
 			{
-				do
-				{
-					if (pItr->IsLast())
-					{
-						++pItr;
-						return *this;
-					}
-
-					++pItr;
-				}
-				while (pItr->IsEmpty());
-
+				index = pTable->NextFull(index + 1);
 				return *this;
 			}
 
@@ -133,267 +171,398 @@ namespace Quartz
 			{
 				Iterator temp(*this);
 				++(*this);
-				return *temp;
+				return temp;
 			}
 
 			Bool8 operator==(const Iterator& it) const
 			{
-				return pItr == it.pItr;
+				return index == it.index;
 			}
 
 			Bool8 operator!=(const Iterator& it) const
 			{
-				return pItr != it.pItr;
+				return index != it.index;
 			}
 
 			Bool8 operator>=(const Iterator& it) const
 			{
-				return pItr >= it.pItr;
+				return index >= it.index;
 			}
 
 			Bool8 operator<=(const Iterator& it) const
 			{
-				return pItr <= it.pItr;
+				return index <= it.index;
 			}
 
 			Bool8 operator>(const Iterator& it) const
 			{
-				return pItr > it.pItr;
+				return index > it.index;
 			}
 
 			Bool8 operator<(const Iterator& it) const
 			{
-				return pItr < it.pItr;
+				return index < it.index;
 			}
 
 			KeyValueType& operator*()
 			{
-				return pItr->keyValue;
+				return pTable->mpSlots[index];
 			}
 
 			KeyValueType* operator->()
 			{
-				return &pItr->keyValue;
+				return &pTable->mpSlots[index];
 			}
 		};
 
+		friend class Iterator;
+
 	private:
-		Array<TableEntryType> mTable;
-		UInt32 mSize;
-		UInt32 mCapacity;
-		UInt32 mThreshold;
-		UInt32 mMask;
+		KeyValueType*	mpSlots;
+		UInt32*			mpHashes;
+		TableControl*	mpControl;
+		UInt32			mSize;
+		UInt32			mDeleted;
+		UInt32			mCapacity;
+		UInt32			mThreshold;
+		UInt32			mMask;
 
-		UInt32 PrepHash(UInt32 hash)
-		{
-			//hash &= 0x7FFFFFFF;
-			hash |= hash == 0;
+	private:
+		/* Mix the user hash so that both the tag and the position bits are usable */
+		static FORCE_INLINE UInt32 PrepHash(UInt32 hash)
+		{
+			hash ^= hash >> 16;
+			hash *= 0x85EBCA6B;
+			hash ^= hash >> 13;
+			hash *= 0xC2B2AE35;
+			hash ^= hash >> 16;
 			return hash;
 		}
 
-		UInt32 GetDistance(UInt32 hash, UInt32 index)
+		static FORCE_INLINE UInt32 HashPosition(UInt32 hash)
 		{
-			return (index + mCapacity - (hash & mMask)) & mMask;
+			return hash >> 7;
 		}
 
-		TableEntryType* FindEntry(UInt32 hash, const KeyValueType& keyValue)
+		/* Probes start at and step over whole aligned groups */
+		FORCE_INLINE UInt32 GroupPosition(UInt32 hash) const
 		{
-			hash = PrepHash(hash);
+			return HashPosition(hash) & mMask & ~(GROUP_WIDTH - 1);
+		}
 
-			UInt32 index = hash & mMask;
-			UInt32 original = index;
-			UInt32 dist = 0;
+		static FORCE_INLINE TableControl HashTag(UInt32 hash)
+		{
+			return static_cast<TableControl>(hash & 0x7F);
+		}
 
-			while (true)
-			{
-				if (mTable[index].hash == 0 || dist > GetDistance(mTable[index].hash, index))
-				{
-					return nullptr;
-				}
-				else if (mTable[index].hash == hash && mTable[index].keyValue == keyValue)
-				{
-					return &mTable[index];
-				}
+		static UInt32 CapacityFor(UInt32 count)
+		{
+			UInt32 capacity = INITAL_SIZE;
 
-				index = (index + 1) & mMask;
-				++dist;
+			while (ThresholdFor(capacity) < count)
+			{
+				capacity <<= 1;
 			}
 
-			return nullptr;
+			return capacity;
 		}
 
-		template<typename KeyValue>
-		TableEntryType& FindInsertEntry(UInt32 hash, KeyValue&& keyValue)
+		static FORCE_INLINE UInt32 ThresholdFor(UInt32 capacity)
 		{
-			hash = PrepHash(hash);
+			// 7/8 max load
+			return capacity - (capacity / 8);
+		}
 
-			UInt32 index = hash & mMask;
-			UInt32 original = index;
-			UInt32 dist = 0;
+		static FORCE_INLINE USize HashesOffset(UInt32 capacity)
+		{
+			return capacity * sizeof(KeyValueType);
+		}
 
-			TableEntryType entry;
+		static FORCE_INLINE USize ControlOffset(UInt32 capacity)
+		{
+			return HashesOffset(capacity) + capacity * sizeof(UInt32);
+		}
 
-			while (true)
-			{
-				// Entry is empty
-				if (mTable[index].hash == 0)
-				{
-					return mTable[index];
-				}
+		static FORCE_INLINE USize BlockSize(UInt32 capacity)
+		{
+			// Control bytes are followed by an empty group so NextFull can
+			// load a whole group near the end
+			return ControlOffset(capacity) + capacity + GROUP_WIDTH;
+		}
 
-				// Found previous key entry
-				if (mTable[index].keyValue == std::forward<KeyValue>(keyValue))
-				{
-					return mTable[index];
-				}
+		void Allocate(UInt32 capacity)
+		{
+			constexpr USize align = alignof(KeyValueType) > alignof(UInt32) ? alignof(KeyValueType) : alignof(UInt32);
+			Byte* pBlock = static_cast<Byte*>(this->GetAllocator().Allocate(BlockSize(capacity), align));
 
-				UInt32 currentDist = GetDistance(mTable[index].hash, index);
+			mpSlots		= reinterpret_cast<KeyValueType*>(pBlock);
+			mpHashes	= reinterpret_cast<UInt32*>(pBlock + HashesOffset(capacity));
+			mpControl	= reinterpret_cast<TableControl*>(pBlock + ControlOffset(capacity));
 
-				if (currentDist < dist)
-				{
-					// Entry is erased
-					if (mTable[index].isDeleted)
-					{
-						return mTable[index];
-					}
+			memset(mpControl, TABLE_CONTROL_EMPTY, capacity + GROUP_WIDTH);
 
-					Swap(entry, mTable[index]);
+			mCapacity	= capacity;
+			mThreshold	= ThresholdFor(capacity);
+			mMask		= capacity - 1;
+		}
 
-					dist = currentDist;
+		void Deallocate()
+		{
+			if (mCapacity != 0)
+			{
+				for (UInt32 i = NextFull(0); i < mCapacity; i = NextFull(i + 1))
+				{
+					mpSlots[i].~KeyValueType();
 				}
 
-				index = (index + 1) & mMask;
-				++dist;
+				this->GetAllocator().Free(mpSlots, BlockSize(mCapacity));
 			}
 		}
 
-		template<typename KeyValue>
-		KeyValueType& InsertImpl(UInt32 hash, KeyValue&& keyValue)
+		void SetEmptyState()
 		{
-			hash = PrepHash(hash);
-
-			UInt32 index = hash & mMask;
-			UInt32 original = index;
-			UInt32 dist = 0;
+			mpSlots		= nullptr;
+			mpHashes	= nullptr;
+			mpControl	= const_cast<TableControl*>(TABLE_EMPTY_GROUP);
+			mSize		= 0;
+			mDeleted	= 0;
+			mCapacity	= 0;
+			mThreshold	= 0;
+			mMask		= 0;
+		}
 
-			TableEntryType entry(hash, std::forward<KeyValue>(keyValue));
+		FORCE_INLINE void SetControl(UInt32 index, TableControl value)
+		{
+			mpControl[index] = value;
+		}
 
-			while (true)
+		UInt32 NextFull(UInt32 index) const
+		{
+			while (index < mCapacity)
 			{
-				// Entry is empty
-				if (mTable[index].hash == 0)
+				UInt32 mask = TableGroup(mpControl + index).MatchFull();
+
+				if (index + GROUP_WIDTH > mCapacity)
 				{
-					++mSize;
-					Swap(entry, mTable[index]);
-					return mTable[index].keyValue;
+					// Ignore the cloned bytes past the end
+					mask &= (1U << (mCapacity - index)) - 1;
 				}
 
-				// Found previous key entry
-				if (mTable[index].keyValue == entry.keyValue)
+				if (mask != 0)
 				{
-					Swap(entry, mTable[index]);
-					return mTable[index].keyValue;
+					return index + CountTrailingZeros(mask);
 				}
 
-				UInt32 currentDist = GetDistance(mTable[index].hash, index);
+				index += GROUP_WIDTH;
+			}
 
-				if (currentDist < dist)
+			return mCapacity;
+		}
+
+		/*
+			Returns mCapacity if no entry matches. groupEmpty receives the
+			empty slots of the group the probe ended in.
+		*/
+		template<typename Lookup>
+		UInt32 FindIndex(UInt32 hash, const Lookup& lookup, UInt32& groupEmpty) const
+		{
+			const TableControl tag = HashTag(hash);
+			UInt32 position = GroupPosition(hash);
+
+#ifdef TABLE_SSE2
+			// The first slot is usually the match, load it alongside the control bytes
+			_mm_prefetch(reinterpret_cast<const char*>(mpSlots + position), _MM_HINT_T0);
+#endif
+
+			while (true)
+			{
+				TableGroup group(mpControl + position);
+
+				for (UInt32 mask = group.Match(tag); mask != 0; mask &= mask - 1)
 				{
-					// Entry is erased
-					if (mTable[index].isDeleted)
+					const UInt32 index = position + CountTrailingZeros(mask);
+
+					if (mpSlots[index] == lookup)
 					{
-						++mSize;
-						Swap(entry, mTable[index]);
-						return mTable[index].keyValue;
+						groupEmpty = group.MatchEmpty();
+						return index;
 					}
+				}
 
-					Swap(entry, mTable[index]);
+				groupEmpty = group.MatchEmpty();
 
-					dist = currentDist;
+				if (groupEmpty != 0)
+				{
+					return mCapacity;
 				}
 
-				index = (index + 1) & mMask;
-				++dist;
+				position = (position + GROUP_WIDTH) & mMask;
 			}
 		}
 
-		void ResizeRehash(UInt32 size)
+		template<typename Lookup>
+		FORCE_INLINE UInt32 FindIndex(UInt32 hash, const Lookup& lookup) const
 		{
-			TableType mNewTable(size);
+			UInt32 groupEmpty;
+			return FindIndex(hash, lookup, groupEmpty);
+		}
 
-			TableEntryType* pEntry = &mTable[0];
+		UInt32 FindEmptyIndex(UInt32 hash) const
+		{
+			UInt32 position = GroupPosition(hash);
 
-			while (!pEntry->IsLast())
+			while (true)
 			{
-				if (!pEntry->IsEmpty())
+				const UInt32 mask = TableGroup(mpControl + position).MatchEmptyOrDeleted();
+
+				if (mask != 0)
 				{
-					mNewTable.Insert(pEntry->hash, pEntry->keyValue);
+					return position + CountTrailingZeros(mask);
 				}
 
-				++pEntry;
+				position = (position + GROUP_WIDTH) & mMask;
+			}
+		}
+
+		template<typename KeyValue>
+		KeyValueType& InsertNew(UInt32 hash, KeyValue&& keyValue)
+		{
+			const UInt32 index = FindEmptyIndex(hash);
+
+			mDeleted -= mpControl[index] == TABLE_CONTROL_DELETED;
+
+			new (&mpSlots[index]) KeyValueType(std::forward<KeyValue>(keyValue));
+			mpHashes[index] = hash;
+			SetControl(index, HashTag(hash));
+			++mSize;
+
+			return mpSlots[index];
+		}
+
+		/* groupEmpty holds the empty slots of the group index is in */
+		void EraseIndex(UInt32 index, UInt32 groupEmpty)
+		{
+			mpSlots[index].~KeyValueType();
+
+			// Probes only pass over groups without an empty slot
+			if (groupEmpty != 0)
+			{
+				SetControl(index, TABLE_CONTROL_EMPTY);
+			}
+			else
+			{
+				SetControl(index, TABLE_CONTROL_DELETED);
+				++mDeleted;
 			}
 
-			if (!pEntry->IsEmpty())
+			--mSize;
+		}
+
+		void ResizeRehash(UInt32 capacity)
+		{
+			TableType newTable(this->GetAllocator());
+			newTable.Allocate(capacity);
+
+			for (UInt32 i = NextFull(0); i < mCapacity; i = NextFull(i + 1))
 			{
-				mNewTable.Insert(pEntry->hash, pEntry->keyValue);
+				newTable.InsertNew(mpHashes[i], Move(mpSlots[i]));
 			}
 
-			Swap(mNewTable, *this);
+			Swap(newTable, *this);
 		}
 
 	public:
 		Table()
-			: mTable(INITAL_SIZE, TableEntryType()), mSize(0), mCapacity(INITAL_SIZE),
-			mThreshold(INITAL_SIZE * LOAD_FACTOR), mMask(INITAL_SIZE - 1)
 		{
-			mTable[0].isFirst = true;
-			mTable[mCapacity - 1].isLast = true;
+			SetEmptyState();
+		}
+
+		explicit Table(const AllocatorType& allocator)
+			: AllocatorStorage<AllocatorType>(allocator)
+		{
+			SetEmptyState();
 		}
 
-		Table(UInt32 capacity)
-			: mTable(capacity, TableEntryType()), mSize(0), mCapacity(capacity),
-			mThreshold(capacity * LOAD_FACTOR), mMask(capacity - 1)
+		Table(UInt32 capacity, const AllocatorType& allocator = AllocatorType())
+			: AllocatorStorage<AllocatorType>(allocator)
 		{
-			mTable[0].isFirst = true;
-			mTable[mCapacity - 1].isLast = true;
+			SetEmptyState();
+			Allocate(CapacityFor(capacity));
 		}
 
 		Table(const TableType& table)
-			: mTable(table.mTable), mSize(table.mSize), mCapacity(table.mCapacity),
-			mThreshold(table.mThreshold), mMask(table.mMask) { }
+			: AllocatorStorage<AllocatorType>(table.GetAllocator())
+		{
+			SetEmptyState();
+
+			if (table.mCapacity != 0)
+			{
+				Allocate(table.mCapacity);
+
+				memcpy(mpHashes, table.mpHashes, mCapacity * sizeof(UInt32));
+				memcpy(mpControl, table.mpControl, mCapacity + GROUP_WIDTH);
+
+				for (UInt32 i = table.NextFull(0); i < mCapacity; i = table.NextFull(i + 1))
+				{
+					new (&mpSlots[i]) KeyValueType(table.mpSlots[i]);
+				}
+
+				mSize = table.mSize;
+				mDeleted = table.mDeleted;
+			}
+		}
 
 		Table(TableType&& table) noexcept
-			: Table()
 		{
+			SetEmptyState();
 			Swap(*this, table);
 		}
 
+		~Table()
+		{
+			Deallocate();
+		}
+
+		/* Inserts or replaces the entry equal to keyValue */
 		template<typename Value>
 		KeyValueType& Insert(UInt32 hash, Value&& keyValue)
 		{
-			if (mSize + 1 >= mThreshold)
+			hash = PrepHash(hash);
+
+			const UInt32 index = FindIndex(hash, keyValue);
+
+			if (index != mCapacity)
+			{
+				return mpSlots[index] = std::forward<Value>(keyValue);
+			}
+
+			if (mSize + mDeleted + 1 > mThreshold)
 			{
-				ResizeRehash(NextGreaterPowerOf2(mCapacity));
+				// Mostly deleted markers, rehashing in place drops them
+				const Bool8 grow = mSize + 1 > mThreshold / 2;
+				ResizeRehash(mCapacity == 0 ? INITAL_SIZE : (grow ? mCapacity * 2 : mCapacity));
 			}
-			
-			return InsertImpl(hash, std::forward<Value>(keyValue));
+
+			return InsertNew(hash, std::forward<Value>(keyValue));
 		}
 
-		void Remove(UInt32 hash, const KeyValueType& keyValue)
+		template<typename Lookup>
+		void Remove(UInt32 hash, const Lookup& lookup)
 		{
-			TableEntryType* pEntry = FindEntry(hash, keyValue);
+			UInt32 groupEmpty;
+			const UInt32 index = FindIndex(PrepHash(hash), lookup, groupEmpty);
 
-			if (pEntry)
+			if (index != mCapacity)
 			{
-				pEntry->hash = 0;
-				mSize--;
+				EraseIndex(index, groupEmpty);
 			}
 		}
 
-		KeyValueType* Find(UInt32 hash, const KeyValueType& keyValue)
+		template<typename Lookup>
+		KeyValueType* Find(UInt32 hash, const Lookup& lookup)
 		{
-			TableEntryType* pEntry = FindEntry(hash, keyValue);
-			return pEntry == nullptr ? nullptr : &pEntry->keyValue;
+			const UInt32 index = FindIndex(PrepHash(hash), lookup);
+			return index == mCapacity ? nullptr : &mpSlots[index];
 		}
 
 		Bool8 Reserve(UInt32 size)
@@ -404,29 +573,45 @@ namespace Quartz
 				return false;
 			}
 
-			ResizeRehash(NextPowerOf2(size));
+			const UInt32 capacity = CapacityFor(size);
+
+			if (capacity > mCapacity || (mDeleted != 0 && size + mDeleted > mThreshold))
+			{
+				ResizeRehash(capacity);
+			}
 
 			return true;
 		}
 
 		void Shrink()
 		{
-			UInt32 newSize = NextPowerOf2(mSize);
+			if (mSize == 0)
+			{
+				Deallocate();
+				SetEmptyState();
+				return;
+			}
+
+			const UInt32 capacity = CapacityFor(mSize);
 
-			if (newSize != mSize)
+			if (capacity != mCapacity || mDeleted != 0)
 			{
-				ResizeRehash(newSize);
+				ResizeRehash(capacity);
 			}
 		}
 
 		friend void Swap(TableType& table1, TableType& table2)
 		{
 			using Quartz::Swap;
-			Swap(table1.mTable, table2.mTable);
+			Swap(table1.mpSlots, table2.mpSlots);
+			Swap(table1.mpHashes, table2.mpHashes);
+			Swap(table1.mpControl, table2.mpControl);
 			Swap(table1.mSize, table2.mSize);
+			Swap(table1.mDeleted, table2.mDeleted);
 			Swap(table1.mCapacity, table2.mCapacity);
 			Swap(table1.mThreshold, table2.mThreshold);
 			Swap(table1.mMask, table2.mMask);
+			Swap(table1.GetAllocator(), table2.GetAllocator());
 		}
 
 		TableType& operator=(TableType table)
@@ -435,49 +620,41 @@ namespace Quartz
 			return *this;
 		}
 
-		Bool8 Contains(UInt32 hash, const KeyValueType& keyValue)
+		template<typename Lookup>
+		Bool8 Contains(UInt32 hash, const Lookup& lookup)
 		{
-			return Find(hash, keyValue) != nullptr;
+			return Find(hash, lookup) != nullptr;
 		}
 
 		void Clear()
 		{
-			mTable.Clear();
-			mTable.Resize(mCapacity, TableEntryType());
-			mTable[mCapacity - 1].isLast = true;
+			if (mCapacity != 0)
+			{
+				for (UInt32 i = NextFull(0); i < mCapacity; i = NextFull(i + 1))
+				{
+					mpSlots[i].~KeyValueType();
+				}
+
+				memset(mpControl, TABLE_CONTROL_EMPTY, mCapacity + GROUP_WIDTH);
+			}
+
 			mSize = 0;
+			mDeleted = 0;
 		}
 
 		Iterator begin()
 		{
-			if (mTable.IsEmpty())
-			{
-				return nullptr;
-			}
-
-			Iterator it(&mTable[0]);
-
-			if (mTable[0].IsEmpty())
-			{
-				return ++it;
-			}
-
-			return it;
+			return Iterator(this, NextFull(0));
 		}
 
 		Iterator end()
 		{
-			if (mTable.IsEmpty())
-			{
-				return nullptr;
-			}
-
-			return Iterator(mTable.Data() + mCapacity);
+			return Iterator(this, mCapacity);
 		}
 
-		TableEntryType* Data()
+		KeyValueType* Data()
 		{
-			return mTable.Data();
+			return mpSlots;
 		}
 
 		UInt32 Size() const
@@ -495,4 +672,7 @@ namespace Quartz
 			return mThreshold;
 		}
 	};
+
+	template<typename KeyValueType, typename AllocatorType>
+	struct IsTriviallyRelocatable<Table<KeyValueType, AllocatorType>> : public IsTriviallyRelocatable<AllocatorType> {};
 }
\ No newline at end of file
@@ -83,7 +83,7 @@ namespace Quartz
 	template<typename Search, USize _index, typename Type>
 	struct TupleGetIndex<Search, _index, Type>
 	{
-		constexpr static USize index = ConditionIndex<IsSameType<Search, Type>::value, _index, -1>::index;
+		constexpr static USize index = ConditionIndex<IsSameType<Search, Type>::value, _index, USize(-1)>::index;
 	};
 
 	////////////////////////////////////////////////////////////////////////
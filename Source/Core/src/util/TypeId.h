@@ -2,39 +2,158 @@
 
 #include "../Common.h"
 
+#ifdef _MSC_VER
+#define QUARTZ_FUNC_SIGNATURE __FUNCSIG__
+#else
+#define QUARTZ_FUNC_SIGNATURE __PRETTY_FUNCTION__
+#endif
+
 namespace Quartz
 {
 	typedef UInt64 TypeId;
 
+	/*
+		Compile-time type ids. Only the type name is hashed out of the
+		function signature, with whitespace and MSVC's class keys dropped,
+		so the same named type gets the same id on MSVC, GCC and Clang and
+		ids can be saved. Builtin types spelled differently by compilers
+		(eg. __int64) and types in anonymous namespaces are not portable.
+	*/
 	template<typename Type>
 	class TypeInfo
 	{
 	private:
-		constexpr static UInt64 Hash(const char* signature)
+		constexpr static Bool8 IsIdentifier(char c)
+		{
+			return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') || c == '_';
+		}
+
+		constexpr static USize Find(const char* str, USize length, const char* pattern, USize from)
+		{
+			for (USize i = from; i < length; i++)
+			{
+				USize j = 0;
+
+				while (pattern[j] != 0 && i + j < length && str[i + j] == pattern[j])
+				{
+					j++;
+				}
+
+				if (pattern[j] == 0)
+				{
+					return i;
+				}
+			}
+
+			return length;
+		}
+
+		/* Length of the class key starting name, 0 if there is none */
+		constexpr static USize ClassKeyLength(const char* name, USize length)
+		{
+			const char* keys[] = { "struct ", "class ", "union ", "enum " };
+
+			for (const char* key : keys)
+			{
+				USize keyLength = 0;
+
+				while (key[keyLength] != 0 && keyLength < length && name[keyLength] == key[keyLength])
+				{
+					keyLength++;
+				}
+
+				if (key[keyLength] == 0)
+				{
+					return keyLength;
+				}
+			}
+
+			return 0;
+		}
+
+		/* FNV-1a of the name, skipping spaces and class keys */
+		constexpr static UInt64 HashName(const char* name, USize length)
 		{
-			const char* val = signature;
 			UInt64 value = 14695981039346656037ull;
+			USize i = 0;
 
-			while (*val != 0)
+			while (i < length)
 			{
-				value = (value ^ static_cast<UInt64>(*(val++))) * 1099511628211ull;
+				if (i == 0 || !IsIdentifier(name[i - 1]))
+				{
+					const USize keyLength = ClassKeyLength(name + i, length - i);
+
+					if (keyLength > 0)
+					{
+						i += keyLength;
+						continue;
+					}
+				}
+
+				if (name[i] != ' ')
+				{
+					value = (value ^ static_cast<UInt64>(static_cast<UInt8>(name[i]))) * 1099511628211ull;
+				}
+
+				i++;
 			}
 
 			return value;
 		}
 
+		/*
+			Cuts the type name out of this function's signature:
+			MSVC:  unsigned __int64 __cdecl Quartz::TypeInfo<struct Foo>::NameHash(void)
+			GCC:   static constexpr Quartz::UInt64 Quartz::TypeInfo<Type>::NameHash() [with Type = Foo; ...]
+			Clang: static Quartz::UInt64 Quartz::TypeInfo<Foo>::NameHash() [Type = Foo]
+		*/
 		template<USize StrSize>
-		constexpr static UInt64 TypeHash(const char (&signature)[StrSize])
+		constexpr static UInt64 HashSignature(const char (&signature)[StrSize])
+		{
+			const USize length = StrSize - 1;
+
+#ifdef _MSC_VER
+			const USize begin = Find(signature, length, "TypeInfo<", 0) + 9;
+			const USize end = Find(signature, length, ">::NameHash(", begin);
+#else
+			const USize begin = Find(signature, length, "Type = ", 0) + 7;
+			const USize separator = Find(signature, length, ";", begin);
+			const USize end = separator < length ? separator : length - 1;
+#endif
+
+			return HashName(signature + begin, end - begin);
+		}
+
+		constexpr static UInt64 NameHash()
 		{
-			return Hash(signature);
+			return HashSignature(QUARTZ_FUNC_SIGNATURE);
 		}
 
 	public:
 		constexpr static TypeId Id()
 		{
-			constexpr TypeId value = static_cast<TypeId>(TypeHash(__FUNCSIG__));
+			constexpr TypeId value = static_cast<TypeId>(NameHash());
 			return value;
 		}
 	};
 
-}
\ No newline at end of file
+	/* Id of a type spelled by hand, matches TypeInfo<Type>::Id() for the same name */
+	template<USize StrSize>
+	constexpr TypeId TypeIdOf(const char (&name)[StrSize])
+	{
+		UInt64 value = 14695981039346656037ull;
+
+		for (USize i = 0; i < StrSize - 1; i++)
+		{
+			if (name[i] != ' ')
+			{
+				value = (value ^ static_cast<UInt64>(static_cast<UInt8>(name[i]))) * 1099511628211ull;
+			}
+		}
+
+		return static_cast<TypeId>(value);
+	}
+
+	struct TypeIdProbe;
+	static_assert(TypeInfo<TypeIdProbe>::Id() == TypeIdOf("Quartz::TypeIdProbe"), "Type ids are not portable on this compiler!");
+}
@@ -2,6 +2,8 @@
 
 #include "../Common.h"
 
+#include <type_traits>
+
 namespace Quartz
 {
 	//////////////////////////////////////////////////////////////
@@ -121,6 +123,59 @@ namespace Quartz
 
 	//////////////////////////////////////////////////////////////
 
+	/*
+		Types that can be moved to a new address with memcpy, leaving nothing
+		to destruct at the old address. Containers specialize this when they
+		only hold pointers into heap memory they own.
+	*/
+	template<typename Type>
+	struct IsTriviallyRelocatable : public CompileConstant<Bool8, std::is_trivially_copyable<Type>::value> {};
+
+	//////////////////////////////////////////////////////////////
+
+	/* Checks if a TypeList holds Type */
+	template<typename Type, typename List>
+	struct TypeListContains : public FalseType {};
+
+	template<typename Type, typename... Types>
+	struct TypeListContains<Type, TypeList<Types...>> : public CompileConstant<Bool8, (IsSameType<Type, Types>::value || ...)> {};
+
+	//////////////////////////////////////////////////////////////
+
+	/*
+		Parameter types of a function or functor as a TypeList. Generic
+		lambdas and overloaded functors have no single signature, their
+		Args is void.
+	*/
+	template<typename Func, typename = void>
+	struct CallableTraits
+	{
+		using Args = void;
+	};
+
+	template<typename ReturnType, typename... Params>
+	struct CallableTraits<ReturnType (*)(Params...)>
+	{
+		using Args = TypeList<Params...>;
+	};
+
+	template<typename ReturnType, typename ClassType, typename... Params>
+	struct CallableTraits<ReturnType (ClassType::*)(Params...)>
+	{
+		using Args = TypeList<Params...>;
+	};
+
+	template<typename ReturnType, typename ClassType, typename... Params>
+	struct CallableTraits<ReturnType (ClassType::*)(Params...) const>
+	{
+		using Args = TypeList<Params...>;
+	};
+
+	template<typename Func>
+	struct CallableTraits<Func, std::void_t<decltype(&Func::operator())>> : public CallableTraits<decltype(&Func::operator())> {};
+
+	//////////////////////////////////////////////////////////////
+
 	template<typename RefType>
 	struct AnyRef
 	{
@@ -1,6 +1,8 @@
 #pragma once
 #include "../Common.h"
 
+#include <cstring>
+
 #if _MSC_VER
 
 #include <intrin.h>
@@ -11,6 +13,12 @@
 #pragma intrinsic(_BitScanReverse)
 #endif
 
+#pragma intrinsic(_BitScanForward)
+
+#if defined(_M_X64)
+#pragma intrinsic(_BitScanForward64)
+#endif
+
 #endif
 
 namespace Quartz
@@ -50,6 +58,11 @@ namespace Quartz
 	}
 #endif
 
+#else
+	static FORCE_INLINE UInt64 NextPowerOf2(const UInt64 value)
+	{
+		return value <= 1 ? 1 : UInt64(1) << (64 - __builtin_clzll(value - 1));
+	}
 #endif
 
 #if _MSC_VER
@@ -71,12 +84,46 @@ namespace Quartz
 	}
 #endif
 
+#else
+	static FORCE_INLINE UInt64 NextGreaterPowerOf2(const UInt64 value)
+	{
+		return value == 0 ? 1 : UInt64(1) << (64 - __builtin_clzll(value));
+	}
 #endif
 
 	static FORCE_INLINE UInt32 CountZeroBitsRight(const UInt32 value)
 	{
 		Float32 f = (float)((Int32)value & -(Int32)value);
-		return (*(UInt32 *)&f >> 23) - 0x7f;
+		UInt32 bits;
+		memcpy(&bits, &f, sizeof(bits));
+		return (bits >> 23) - 0x7f;
+	}
+
+	/* Index of the lowest set bit. Undefined for zero. */
+	static FORCE_INLINE UInt32 CountTrailingZeros(const UInt32 value)
+	{
+#if _MSC_VER
+		unsigned long idx;
+		_BitScanForward(&idx, (unsigned long)value);
+		return (UInt32)idx;
+#else
+		return (UInt32)__builtin_ctz(value);
+#endif
+	}
+
+	/* Index of the lowest set bit. Undefined for zero. */
+	static FORCE_INLINE UInt32 CountTrailingZeros64(const UInt64 value)
+	{
+#if _MSC_VER && defined(_M_X64)
+		unsigned long idx;
+		_BitScanForward64(&idx, value);
+		return (UInt32)idx;
+#elif _MSC_VER
+		const UInt32 low = (UInt32)value;
+		return low != 0 ? CountTrailingZeros(low) : 32 + CountTrailingZeros((UInt32)(value >> 32));
+#else
+		return (UInt32)__builtin_ctzll(value);
+#endif
 	}
 
 	template<class Type>
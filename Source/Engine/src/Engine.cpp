@@ -1,6 +1,7 @@
 #include "Engine.h"
 
 #include "log/Log.h"
+#include "util/Name.h"
 
 namespace Quartz
 {
@@ -14,6 +15,10 @@ namespace Quartz
 		mpTime		= info.pPlatformModule->GetTime();
 		mTargetTPS	= info.targetTPS;
 
+		mFrameArena.Initialize(info.framesInFlight, info.frameArenaSize);
+
+		GetJobSystem().Initialize(info.workerCount);
+
 		/* Setup Internal Modules */
 
 		mpApplicationManager	= new ApplicationManager();
@@ -131,6 +136,10 @@ namespace Quartz
 
 		while (!mShutdownRequested)
 		{
+			mFrameArena.NextFrame();
+
+			GetJobSystem().RunMainThreadJobs();
+
 			accumulatedUpdates++;
 
 			currentTime			= mpTime->GetTimeNanoseconds();
@@ -222,6 +231,8 @@ namespace Quartz
 		delete mpApplicationManager;
 		delete mpEventSystem;
 		delete mpSceneManager;
+
+		GetJobSystem().Shutdown();
 	}
 
 	Engine* Engine::GetInstance()
@@ -229,5 +240,18 @@ namespace Quartz
 		static Engine* spInstance = new Engine();
 		return spInstance;
 	}
+
+	NameTable& GetNameTable()
+	{
+		// Never destroyed, static Names may outlive the engine
+		static NameTable* spNameTable = new NameTable();
+		return *spNameTable;
+	}
+
+	JobSystem& GetJobSystem()
+	{
+		static JobSystem* spJobSystem = new JobSystem();
+		return *spJobSystem;
+	}
 }
 
@@ -13,6 +13,8 @@
 #include "util/Singleton.h"
 #include "util/Array.h"
 #include "util/String.h"
+#include "memory/LinearAllocator.h"
+#include "thread/JobSystem.h"
 
 
 namespace Quartz
@@ -33,6 +35,9 @@ namespace Quartz
 		Graphics*	pGraphicsModule;
 		Platform*	pPlatformModule;
 		Float32		targetTPS;
+		UInt32		framesInFlight	= 2;			// Frame memory lifetime, at least 2 for events
+		USize		frameArenaSize	= 1024 * 1024;	// Initial size of each frame arena
+		USize		workerCount		= 0;			// Job system threads including the main thread, 0 for one per core
 	};
 
 	/* Engine */
@@ -57,6 +62,8 @@ namespace Quartz
 
 		Array<Module*>		mModules;
 
+		FrameArena			mFrameArena;
+
 		Bool8				mRunning;
 		Bool8				mShutdownRequested;
 
@@ -91,6 +98,14 @@ namespace Quartz
 		FORCE_INLINE Graphics*				GetGraphics() { return mpGraphics; }
 		FORCE_INLINE Platform*				GetPlatform() { return mpPlatform; }
 
+		/*
+			Per-frame memory, valid until framesInFlight more frames have
+			started. Main thread only, jobs must not allocate from it.
+		*/
+		FORCE_INLINE FrameArena&			GetFrameArena() { return mFrameArena; }
+		FORCE_INLINE FrameAllocator			GetFrameAllocator() { return FrameAllocator(&mFrameArena); }
+		FORCE_INLINE void*					FrameAllocate(USize size, USize align = DEFAULT_ALIGNMENT) { return mFrameArena.Allocate(size, align); }
+
 		static Engine* GetInstance();
 	};
 }
\ No newline at end of file
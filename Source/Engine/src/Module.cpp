@@ -1,5 +1,7 @@
 #include "Module.h"
 
+#include "Engine.h"
+
 namespace Quartz
 {
 	Module::Module(const ModuleInfo& info)
@@ -7,5 +9,20 @@ namespace Quartz
 	{
 		// Nothing
 	}
+
+	FrameAllocator Module::GetFrameAllocator() const
+	{
+		return Engine::GetInstance()->GetFrameAllocator();
+	}
+
+	void* Module::FrameAllocate(USize size, USize align) const
+	{
+		return Engine::GetInstance()->FrameAllocate(size, align);
+	}
+
+	JobSystem& Module::GetJobSystem() const
+	{
+		return Quartz::GetJobSystem();
+	}
 }
 
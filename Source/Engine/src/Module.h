@@ -2,6 +2,8 @@
 
 #include "Common.h"
 #include "util/String.h"
+#include "memory/LinearAllocator.h"
+#include "thread/JobSystem.h"
 
 namespace Quartz
 {
@@ -18,6 +20,13 @@ namespace Quartz
 	protected:
 		Module(const ModuleInfo& info);
 
+		/* Allocators for the engine's per-frame memory, main thread only */
+		FrameAllocator GetFrameAllocator() const;
+		void* FrameAllocate(USize size, USize align = DEFAULT_ALIGNMENT) const;
+
+		/* The engine's job system, for spreading module work across cores */
+		JobSystem& GetJobSystem() const;
+
 	public:
 		virtual Bool8 PreInit() { return true; };
 		virtual Bool8 Init() { return true; };
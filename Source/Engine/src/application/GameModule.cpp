@@ -167,14 +167,21 @@ namespace Quartz
 
 		InputSystem* pInputSystem = Engine::GetInstance()->GetInputSystem();
 
-		ActionState playerMoveForward	= pInputSystem->GetInputAction("PlayerMoveForward");
-		ActionState playerMoveBackward	= pInputSystem->GetInputAction("PlayerMoveBackward");
-		ActionState playerMoveLeft		= pInputSystem->GetInputAction("PlayerMoveLeft");
-		ActionState playerMoveRight		= pInputSystem->GetInputAction("PlayerMoveRight");
-
-		ActionState playerLook = pInputSystem->GetInputAction("PlayerLook");
+		// Interned once, the per-frame lookups only compare ids
+		static const Name playerMoveForwardName		= "PlayerMoveForward";
+		static const Name playerMoveBackwardName	= "PlayerMoveBackward";
+		static const Name playerMoveLeftName		= "PlayerMoveLeft";
+		static const Name playerMoveRightName		= "PlayerMoveRight";
+		static const Name playerLookName			= "PlayerLook";
+
+		ActionState playerMoveForward	= pInputSystem->GetInputAction(playerMoveForwardName);
+		ActionState playerMoveBackward	= pInputSystem->GetInputAction(playerMoveBackwardName);
+		ActionState playerMoveLeft		= pInputSystem->GetInputAction(playerMoveLeftName);
+		ActionState playerMoveRight		= pInputSystem->GetInputAction(playerMoveRightName);
+
+		ActionState playerLook = pInputSystem->GetInputAction(playerLookName);
 		
-		TransformComponent& transform = mpGameScene->GetWorld().GetComponent<TransformComponent>(mCamera);
+		TransformComponent& transform = mpGameScene->GetWorld().GetComponentMut<TransformComponent>(mCamera);
 		Vector3 direction = { 0.0f, 0.0f, 0.0f };
 
 		if(playerMoveForward.action & INPUT_ACTION_ANY_DOWN)
@@ -213,8 +220,11 @@ namespace Quartz
 
 		// Rotate Entity
 
-		TransformComponent& e2Transform = mpGameScene->GetWorld().GetComponent<TransformComponent>(mEntity2);
+		TransformComponent& e2Transform = mpGameScene->GetWorld().GetComponentMut<TransformComponent>(mEntity2);
 		e2Transform.rotation *= Quaternion().SetAxisAngle({ 0.0f, 1.0f, 0.0f }, -1.0f * delta);
+
+		// Propagates the moved transforms to their cached world matrices
+		mpGameScene->GetWorld().Update(delta);
 		
 	}
 
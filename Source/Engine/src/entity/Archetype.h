@@ -0,0 +1,599 @@
+#pragma once
+
+#include "Common.h"
+#include "Entity.h"
+#include "Component.h"
+#include "util/Array.h"
+#include "memory/Allocator.h"
+
+namespace Quartz
+{
+	constexpr USize ARCHETYPE_CHUNK_SIZE	= 16 * 1024;
+	constexpr USize ARCHETYPE_CHUNK_ALIGN	= 64;
+
+	/*
+		Every entity with the same set of component types. Rows live in
+		fixed-size chunks holding an array of entity handles followed by one
+		array per component type (SoA). Rows are kept dense: removing a row
+		moves the last row into its place, so every chunk but the last is
+		full.
+	*/
+	class Archetype
+	{
+	public:
+		friend class ArchetypeStorage;
+
+	private:
+		Array<USize>					mTypes;		// Sorted component type indices
+		Array<const ComponentInfo*>		mInfos;
+		Array<USize>					mOffsets;	// Column offsets from the chunk start
+		Array<Int32>					mColumns;	// Component type index to column, -1 if absent
+		Array<Byte*>					mChunks;
+		Array<Byte*>					mAllocations;	// Backing mChunks, batches share one allocation
+		Array<Archetype*>				mAddEdges;
+		Array<Archetype*>				mRemoveEdges;
+		USize							mChunkCapacity;
+		USize							mChunkBytes;
+		USize							mSize;
+
+		static FORCE_INLINE USize AlignUp(USize value, USize align)
+		{
+			return (value + (align - 1)) & ~(align - 1);
+		}
+
+		void Layout()
+		{
+			USize rowBytes = sizeof(Entity);
+
+			for (const ComponentInfo* pInfo : mInfos)
+			{
+				DEBUG_ASSERT(pInfo->align <= ARCHETYPE_CHUNK_ALIGN && "Component alignment exceeds the archetype chunk alignment!");
+				rowBytes += pInfo->size;
+			}
+
+			USize capacity = ARCHETYPE_CHUNK_SIZE / rowBytes;
+			capacity = capacity > 0 ? capacity : 1;
+
+			while (true)
+			{
+				USize offset = capacity * sizeof(Entity);
+
+				for (USize i = 0; i < mInfos.Size(); i++)
+				{
+					offset = AlignUp(offset, mInfos[i]->align);
+					mOffsets[i] = offset;
+					offset += capacity * mInfos[i]->size;
+				}
+
+				if (offset <= ARCHETYPE_CHUNK_SIZE)
+				{
+					mChunkBytes = ARCHETYPE_CHUNK_SIZE;
+					break;
+				}
+
+				if (capacity == 1)
+				{
+					// A single row larger than a chunk gets an oversized chunk
+					mChunkBytes = AlignUp(offset, ARCHETYPE_CHUNK_ALIGN);
+					break;
+				}
+
+				capacity--;
+			}
+
+			mChunkCapacity = capacity;
+		}
+
+	public:
+		/* infos must be sorted by type index */
+		explicit Archetype(const Array<const ComponentInfo*>& infos)
+			: mInfos(infos), mChunkCapacity(0), mChunkBytes(0), mSize(0)
+		{
+			mTypes.Reserve(mInfos.Size());
+			mOffsets.Resize(mInfos.Size());
+
+			for (USize i = 0; i < mInfos.Size(); i++)
+			{
+				const USize typeIndex = mInfos[i]->typeIndex;
+				mTypes.PushBack(typeIndex);
+
+				if (typeIndex >= mColumns.Size())
+				{
+					mColumns.Resize(typeIndex + 1, -1);
+				}
+
+				mColumns[typeIndex] = static_cast<Int32>(i);
+			}
+
+			Layout();
+		}
+
+		Archetype(const Archetype&) = delete;
+		Archetype& operator=(const Archetype&) = delete;
+
+		~Archetype()
+		{
+			for (USize row = 0; row < mSize; row++)
+			{
+				DestroyRow(row);
+			}
+
+			for (Byte* pAllocation : mAllocations)
+			{
+				AlignedFree(pAllocation);
+			}
+		}
+
+		/* Makes room for capacity rows, allocating the missing chunks together */
+		void Reserve(USize capacity)
+		{
+			const USize chunkCount = (capacity + mChunkCapacity - 1) / mChunkCapacity;
+
+			if (chunkCount <= mChunks.Size())
+			{
+				return;
+			}
+
+			const USize missing = chunkCount - mChunks.Size();
+			Byte* pAllocation = static_cast<Byte*>(AlignedAllocate(missing * mChunkBytes, ARCHETYPE_CHUNK_ALIGN));
+
+			mAllocations.PushBack(pAllocation);
+			mChunks.Reserve(chunkCount);
+
+			for (USize i = 0; i < missing; i++)
+			{
+				mChunks.PushBack(pAllocation + i * mChunkBytes);
+			}
+		}
+
+		/* Appends a row for entity, its components are left unconstructed */
+		USize AllocateRow(Entity entity)
+		{
+			if (mSize == mChunks.Size() * mChunkCapacity)
+			{
+				Reserve(mSize + 1);
+			}
+
+			const USize row = mSize++;
+			GetEntities(row / mChunkCapacity)[row % mChunkCapacity] = entity;
+
+			return row;
+		}
+
+		/* Appends count rows for pEntities and returns the first, components are left unconstructed */
+		USize AllocateRows(const Entity* pEntities, USize count)
+		{
+			Reserve(mSize + count);
+
+			const USize first = mSize;
+
+			for (USize done = 0; done < count;)
+			{
+				const USize row = mSize + done;
+				const USize offset = row % mChunkCapacity;
+				const USize rows = mChunkCapacity - offset < count - done ? mChunkCapacity - offset : count - done;
+
+				memcpy(GetEntities(row / mChunkCapacity) + offset, pEntities + done, rows * sizeof(Entity));
+				done += rows;
+			}
+
+			mSize += count;
+
+			return first;
+		}
+
+		/* Destroys every component in row */
+		void DestroyRow(USize row)
+		{
+			for (USize column = 0; column < mInfos.Size(); column++)
+			{
+				mInfos[column]->pDestroy(GetComponent(static_cast<Int32>(column), row));
+			}
+		}
+
+		/*
+			Removes row, whose components must already be destroyed or
+			relocated. Returns true and the entity that was moved into row
+			if row was not the last.
+		*/
+		Bool8 RemoveRow(USize row, Entity& movedEntity)
+		{
+			const USize last = --mSize;
+
+			if (row == last)
+			{
+				return false;
+			}
+
+			for (USize column = 0; column < mInfos.Size(); column++)
+			{
+				mInfos[column]->pRelocate(
+					GetComponent(static_cast<Int32>(column), row),
+					GetComponent(static_cast<Int32>(column), last));
+			}
+
+			Entity* pRowEntity = &GetEntities(row / mChunkCapacity)[row % mChunkCapacity];
+			*pRowEntity = GetEntities(last / mChunkCapacity)[last % mChunkCapacity];
+			movedEntity = *pRowEntity;
+
+			return true;
+		}
+
+		FORCE_INLINE Int32 GetColumn(USize typeIndex) const
+		{
+			return typeIndex < mColumns.Size() ? mColumns[typeIndex] : -1;
+		}
+
+		FORCE_INLINE void* GetComponent(Int32 column, USize row)
+		{
+			return GetColumnData(row / mChunkCapacity, column) + (row % mChunkCapacity) * mInfos[column]->size;
+		}
+
+		FORCE_INLINE Entity* GetEntities(USize chunk)
+		{
+			return reinterpret_cast<Entity*>(mChunks[chunk]);
+		}
+
+		FORCE_INLINE Byte* GetColumnData(USize chunk, Int32 column)
+		{
+			return mChunks[chunk] + mOffsets[column];
+		}
+
+		/* Number of rows in chunk */
+		FORCE_INLINE USize GetChunkSize(USize chunk) const
+		{
+			const USize start = chunk * mChunkCapacity;
+			return mSize - start < mChunkCapacity ? mSize - start : mChunkCapacity;
+		}
+
+		FORCE_INLINE USize GetChunkCount() const
+		{
+			return (mSize + mChunkCapacity - 1) / mChunkCapacity;
+		}
+
+		/* True if every type index in pTypes has a column */
+		Bool8 Contains(const USize* pTypes, USize count) const
+		{
+			for (USize i = 0; i < count; i++)
+			{
+				if (GetColumn(pTypes[i]) < 0)
+				{
+					return false;
+				}
+			}
+
+			return true;
+		}
+
+		FORCE_INLINE const Array<USize>& GetTypes() const { return mTypes; }
+		FORCE_INLINE USize GetChunkCapacity() const { return mChunkCapacity; }
+		FORCE_INLINE USize Size() const { return mSize; }
+	};
+
+	/*
+		Archetype backend of an EntityWorld. Tracks the archetype and row of
+		every entity and moves rows between archetypes as components are
+		added and removed. Transitions are cached as edges on each archetype,
+		so a structural change only searches for its target archetype once.
+	*/
+	class ArchetypeStorage
+	{
+	private:
+		struct EntityLocation
+		{
+			Archetype*	pArchetype;
+			USize		row;
+		};
+
+		Array<Archetype*>		mArchetypes;
+		Array<EntityLocation>	mLocations;
+		Archetype*				mpRoot;
+
+		Archetype* FindOrCreate(const Array<const ComponentInfo*>& infos)
+		{
+			for (Archetype* pArchetype : mArchetypes)
+			{
+				if (pArchetype->mInfos.Size() != infos.Size())
+				{
+					continue;
+				}
+
+				Bool8 equal = true;
+
+				for (USize i = 0; i < infos.Size() && equal; i++)
+				{
+					equal = pArchetype->mInfos[i] == infos[i];
+				}
+
+				if (equal)
+				{
+					return pArchetype;
+				}
+			}
+
+			Archetype* pArchetype = new Archetype(infos);
+			mArchetypes.PushBack(pArchetype);
+
+			return pArchetype;
+		}
+
+		static void SetEdge(Array<Archetype*>& edges, USize typeIndex, Archetype* pArchetype)
+		{
+			if (typeIndex >= edges.Size())
+			{
+				edges.Resize(typeIndex + 1, nullptr);
+			}
+
+			edges[typeIndex] = pArchetype;
+		}
+
+		Archetype* GetAddEdge(Archetype* pArchetype, const ComponentInfo* pInfo)
+		{
+			const USize typeIndex = pInfo->typeIndex;
+
+			if (pArchetype->GetColumn(typeIndex) >= 0)
+			{
+				return pArchetype;
+			}
+
+			if (typeIndex < pArchetype->mAddEdges.Size() && pArchetype->mAddEdges[typeIndex] != nullptr)
+			{
+				return pArchetype->mAddEdges[typeIndex];
+			}
+
+			Array<const ComponentInfo*> infos;
+			infos.Reserve(pArchetype->mInfos.Size() + 1);
+
+			for (const ComponentInfo* pExisting : pArchetype->mInfos)
+			{
+				if (pInfo != nullptr && pExisting->typeIndex > typeIndex)
+				{
+					infos.PushBack(pInfo);
+					pInfo = nullptr;
+				}
+
+				infos.PushBack(pExisting);
+			}
+
+			if (pInfo != nullptr)
+			{
+				infos.PushBack(pInfo);
+			}
+
+			Archetype* pTarget = FindOrCreate(infos);
+			SetEdge(pArchetype->mAddEdges, typeIndex, pTarget);
+			SetEdge(pTarget->mRemoveEdges, typeIndex, pArchetype);
+
+			return pTarget;
+		}
+
+		Archetype* GetRemoveEdge(Archetype* pArchetype, USize typeIndex)
+		{
+			if (pArchetype->GetColumn(typeIndex) < 0)
+			{
+				return pArchetype;
+			}
+
+			if (typeIndex < pArchetype->mRemoveEdges.Size() && pArchetype->mRemoveEdges[typeIndex] != nullptr)
+			{
+				return pArchetype->mRemoveEdges[typeIndex];
+			}
+
+			Array<const ComponentInfo*> infos;
+			infos.Reserve(pArchetype->mInfos.Size());
+
+			for (const ComponentInfo* pExisting : pArchetype->mInfos)
+			{
+				if (pExisting->typeIndex != typeIndex)
+				{
+					infos.PushBack(pExisting);
+				}
+			}
+
+			Archetype* pTarget = FindOrCreate(infos);
+			SetEdge(pArchetype->mRemoveEdges, typeIndex, pTarget);
+			SetEdge(pTarget->mAddEdges, typeIndex, pArchetype);
+
+			return pTarget;
+		}
+
+		/* Moves entity's row to pTarget, relocating shared components and destroying the rest */
+		void Move(Entity entity, Archetype* pTarget)
+		{
+			EntityLocation& location = mLocations[entity.index];
+			Archetype* pSource = location.pArchetype;
+			const USize sourceRow = location.row;
+
+			if (pSource == pTarget)
+			{
+				return;
+			}
+
+			const USize row = pTarget->AllocateRow(entity);
+
+			for (USize column = 0; column < pSource->mInfos.Size(); column++)
+			{
+				const ComponentInfo* pInfo = pSource->mInfos[column];
+				const Int32 targetColumn = pTarget->GetColumn(pInfo->typeIndex);
+				void* pComponent = pSource->GetComponent(static_cast<Int32>(column), sourceRow);
+
+				if (targetColumn >= 0)
+				{
+					pInfo->pRelocate(pTarget->GetComponent(targetColumn, row), pComponent);
+				}
+				else
+				{
+					pInfo->pDestroy(pComponent);
+				}
+			}
+
+			Entity movedEntity;
+
+			if (pSource->RemoveRow(sourceRow, movedEntity))
+			{
+				mLocations[movedEntity.index].row = sourceRow;
+			}
+
+			location.pArchetype = pTarget;
+			location.row = row;
+		}
+
+		template<typename Component>
+		FORCE_INLINE Component* GetPointer(Archetype* pArchetype, USize row)
+		{
+			const Int32 column = pArchetype->GetColumn(ComponentTypeIndex<Component>::Value());
+			return static_cast<Component*>(pArchetype->GetComponent(column, row));
+		}
+
+		template<typename Component>
+		static void FillColumn(Archetype* pArchetype, USize chunk, USize offset, USize count, const Component& prototype)
+		{
+			const Int32 column = pArchetype->GetColumn(ComponentTypeIndex<Component>::Value());
+			Component* pColumn = reinterpret_cast<Component*>(pArchetype->GetColumnData(chunk, column)) + offset;
+
+			for (USize i = 0; i < count; i++)
+			{
+				new (&pColumn[i]) Component(prototype);
+			}
+		}
+
+	public:
+		ArchetypeStorage()
+			: mpRoot(nullptr)
+		{
+			mpRoot = FindOrCreate(Array<const ComponentInfo*>());
+		}
+
+		ArchetypeStorage(const ArchetypeStorage&) = delete;
+		ArchetypeStorage& operator=(const ArchetypeStorage&) = delete;
+
+		~ArchetypeStorage()
+		{
+			for (Archetype* pArchetype : mArchetypes)
+			{
+				delete pArchetype;
+			}
+		}
+
+		/* Places a new entity directly in the archetype of its components */
+		template<typename... Component>
+		void Insert(Entity entity, Component&&... components)
+		{
+			Archetype* pTarget = mpRoot;
+			((pTarget = GetAddEdge(pTarget, ComponentInfo::Of<std::decay_t<Component>>())), ...);
+
+			const USize row = pTarget->AllocateRow(entity);
+			(new (GetPointer<std::decay_t<Component>>(pTarget, row))
+				std::decay_t<Component>(std::forward<Component>(components)), ...);
+
+			if (entity.index >= mLocations.Size())
+			{
+				mLocations.Resize(entity.index + 1, EntityLocation{ nullptr, 0 });
+			}
+
+			mLocations[entity.index] = { pTarget, row };
+		}
+
+		/* Places count new entities in the archetype of their components, each with a copy of prototype */
+		template<typename... Component>
+		void InsertRange(const Entity* pEntities, USize count, const Component&... prototype)
+		{
+			Archetype* pTarget = mpRoot;
+			((pTarget = GetAddEdge(pTarget, ComponentInfo::Of<Component>())), ...);
+
+			const USize first = pTarget->AllocateRows(pEntities, count);
+			const USize chunkCapacity = pTarget->GetChunkCapacity();
+
+			// Components are constructed a chunk column at a time
+			for (USize done = 0; done < count;)
+			{
+				const USize row = first + done;
+				const USize chunk = row / chunkCapacity;
+				const USize offset = row % chunkCapacity;
+				const USize rows = chunkCapacity - offset < count - done ? chunkCapacity - offset : count - done;
+
+				(FillColumn(pTarget, chunk, offset, rows, prototype), ...);
+				done += rows;
+			}
+
+			Entity::HandleIntType maxIndex = 0;
+
+			for (USize i = 0; i < count; i++)
+			{
+				maxIndex = pEntities[i].index > maxIndex ? pEntities[i].index : maxIndex;
+			}
+
+			if (count > 0 && maxIndex >= mLocations.Size())
+			{
+				mLocations.Resize(maxIndex + 1, EntityLocation{ nullptr, 0 });
+			}
+
+			for (USize i = 0; i < count; i++)
+			{
+				mLocations[pEntities[i].index] = { pTarget, first + i };
+			}
+		}
+
+		/* Destroys every component of entity and removes its row */
+		void Destroy(Entity entity)
+		{
+			EntityLocation& location = mLocations[entity.index];
+			Archetype* pArchetype = location.pArchetype;
+			const USize row = location.row;
+
+			pArchetype->DestroyRow(row);
+
+			Entity movedEntity;
+
+			if (pArchetype->RemoveRow(row, movedEntity))
+			{
+				mLocations[movedEntity.index].row = row;
+			}
+
+			location.pArchetype = nullptr;
+			location.row = 0;
+		}
+
+		/* Adds or overwrites a component, moving the entity to a new archetype if needed */
+		template<typename Component>
+		void Add(Entity entity, Component&& component)
+		{
+			using ComponentType = std::decay_t<Component>;
+
+			EntityLocation& location = mLocations[entity.index];
+			const Int32 column = location.pArchetype->GetColumn(ComponentTypeIndex<ComponentType>::Value());
+
+			if (column >= 0)
+			{
+				*static_cast<ComponentType*>(location.pArchetype->GetComponent(column, location.row)) =
+					std::forward<Component>(component);
+				return;
+			}
+
+			Move(entity, GetAddEdge(location.pArchetype, ComponentInfo::Of<ComponentType>()));
+			new (GetPointer<ComponentType>(location.pArchetype, location.row)) ComponentType(std::forward<Component>(component));
+		}
+
+		template<typename Component>
+		void Remove(Entity entity)
+		{
+			Archetype* pArchetype = mLocations[entity.index].pArchetype;
+			Move(entity, GetRemoveEdge(pArchetype, ComponentTypeIndex<Component>::Value()));
+		}
+
+		template<typename Component>
+		Bool8 Has(Entity entity) const
+		{
+			return mLocations[entity.index].pArchetype->GetColumn(ComponentTypeIndex<Component>::Value()) >= 0;
+		}
+
+		template<typename Component>
+		Component& Get(Entity entity)
+		{
+			const EntityLocation& location = mLocations[entity.index];
+			return *GetPointer<Component>(location.pArchetype, location.row);
+		}
+
+		FORCE_INLINE const Array<Archetype*>& GetArchetypes() const { return mArchetypes; }
+	};
+}
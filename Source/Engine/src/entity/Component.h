@@ -0,0 +1,100 @@
+#pragma once
+
+#include "Common.h"
+#include "util/Utility.h"
+
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace Quartz
+{
+	struct ComponentTypeCounter
+	{
+		static USize Next()
+		{
+			static USize index = 0;
+			return index++;
+		}
+	};
+
+	/*
+		Dense index of a component type, used to subscript the world's
+		storage arrays. The index is a runtime counter, assigned on first
+		use, and may differ between builds, persistent data uses TypeInfo
+		ids instead. A copy is cached while static objects are initialized
+		so that later reads are a plain load, reads before that take the
+		guarded path and get the same index.
+	*/
+	template<typename ComponentType>
+	struct ComponentTypeIndex
+	{
+	private:
+		static USize Assign()
+		{
+			static const USize index = ComponentTypeCounter::Next();
+			return index;
+		}
+
+		// Index + 1, zero until this is dynamically initialized
+		static inline const USize sCached = Assign() + 1;
+
+	public:
+		FORCE_INLINE static USize Value()
+		{
+			const USize cached = sCached;
+			return cached != 0 ? cached - 1 : Assign();
+		}
+	};
+
+	/*
+		False if func, called as func(Entity, Component&...), takes
+		ComponentType by const reference or by value, so iterating with it
+		does not mark ComponentType changed. Callables without a single
+		signature, such as generic lambdas, count as writing everything.
+	*/
+	template<typename Func, typename ComponentType>
+	struct WritesComponent : public CompileConstant<Bool8,
+		!TypeListContains<const ComponentType&, typename CallableTraits<std::decay_t<Func>>::Args>::value &&
+		!TypeListContains<ComponentType, typename CallableTraits<std::decay_t<Func>>::Args>::value> {};
+
+	/*
+		Type-erased description of a component type, enough to move and
+		destroy components stored as raw bytes.
+	*/
+	struct ComponentInfo
+	{
+		USize	typeIndex;
+		USize	size;
+		USize	align;
+
+		/* Move-constructs pDest from pSource, then destroys pSource */
+		void	(*pRelocate)(void* pDest, void* pSource);
+		void	(*pDestroy)(void* pValue);
+
+		template<typename ComponentType>
+		static const ComponentInfo* Of()
+		{
+			static const ComponentInfo info =
+			{
+				ComponentTypeIndex<ComponentType>::Value(),
+				sizeof(ComponentType),
+				alignof(ComponentType),
+
+				[](void* pDest, void* pSource)
+				{
+					ComponentType* pValue = static_cast<ComponentType*>(pSource);
+					new (pDest) ComponentType(std::move(*pValue));
+					pValue->~ComponentType();
+				},
+
+				[](void* pValue)
+				{
+					static_cast<ComponentType*>(pValue)->~ComponentType();
+				}
+			};
+
+			return &info;
+		}
+	};
+}
@@ -0,0 +1,240 @@
+#pragma once
+
+#include "Common.h"
+#include "Entity.h"
+#include "Component.h"
+#include "util/Array.h"
+#include "memory/LinearAllocator.h"
+#include "thread/JobSystem.h"
+
+#include <mutex>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace Quartz
+{
+	class EntityWorld;
+
+	/* An entity created by an EntityCommandBuffer, resolved to an Entity on playback */
+	struct DeferredEntity
+	{
+		UInt32 stream;
+		UInt32 index;
+	};
+
+	/* Applies recorded component commands, defined in EntityCommandBufferImpl.h */
+	template<typename ComponentType>
+	struct ComponentCommands
+	{
+		static void Add(EntityWorld& world, Entity entity, void* pComponent);
+		static void Remove(EntityWorld& world, Entity entity, void* pComponent);
+
+		static void Discard(void* pComponent)
+		{
+			static_cast<ComponentType*>(pComponent)->~ComponentType();
+		}
+	};
+
+	/*
+		Records structural changes to apply to an EntityWorld later, so
+		systems iterating views can create and destroy entities or add and
+		remove components without invalidating them.
+
+		Each job system worker records into its own stream without locking,
+		other threads share a locked stream. Playback creates entities first,
+		then applies component commands sorted by component type and entity
+		so each storage is visited once, and destroys entities last. Commands
+		on entities that are no longer alive are dropped.
+	*/
+	class EntityCommandBuffer
+	{
+	public:
+		friend class EntityWorld;
+
+	private:
+		constexpr static UInt32 NO_DEFERRED = UInt32(-1);
+
+		enum CommandType : UInt32
+		{
+			COMMAND_COMPONENT,
+			COMMAND_DESTROY
+		};
+
+		struct Command
+		{
+			CommandType		type;
+			UInt32			typeIndex;
+			Entity			entity;
+			DeferredEntity	deferred;	// Used instead of entity when deferred.index is not NO_DEFERRED
+			void*			pComponent;
+			void			(*pApply)(EntityWorld& world, Entity entity, void* pComponent);
+			void			(*pDiscard)(void* pComponent);
+		};
+
+		struct alignas(64) CommandStream
+		{
+			Array<Command>	commands;
+			Array<Entity>	created;
+			UInt32			createCount = 0;
+		};
+
+		/* A command in playback order */
+		struct SortEntry
+		{
+			UInt32		type;
+			UInt32		typeIndex;
+			UInt32		entityIndex;
+			UInt32		stream;
+			UInt32		sequence;
+			Entity		entity;
+			Command*	pCommand;
+		};
+
+		using StreamArray = Array<CommandStream, AlignedHeapAllocator>;
+
+		StreamArray				mStreams;		// Stream 0 is shared by non-worker threads
+		std::mutex				mSharedLock;
+		LinearArena				mPayloads;
+
+	private:
+		FORCE_INLINE UInt32 StreamIndex() const
+		{
+			const Int32 workerIndex = GetJobSystem().GetWorkerIndex();
+			const UInt32 stream = static_cast<UInt32>(workerIndex + 1);
+
+			return stream < mStreams.Size() ? stream : 0;
+		}
+
+		void Record(const Command& command)
+		{
+			const UInt32 stream = StreamIndex();
+
+			if (stream == 0)
+			{
+				std::lock_guard<std::mutex> guard(mSharedLock);
+				mStreams[0].commands.PushBack(command);
+			}
+			else
+			{
+				mStreams[stream].commands.PushBack(command);
+			}
+		}
+
+		template<typename Component>
+		void RecordAdd(Entity entity, DeferredEntity deferred, Component&& component)
+		{
+			using ComponentType = std::decay_t<Component>;
+
+			void* pComponent = mPayloads.Allocate(sizeof(ComponentType), alignof(ComponentType));
+			new (pComponent) ComponentType(std::forward<Component>(component));
+
+			Record({ COMMAND_COMPONENT, static_cast<UInt32>(ComponentTypeIndex<ComponentType>::Value()), entity, deferred,
+				pComponent, &ComponentCommands<ComponentType>::Add, &ComponentCommands<ComponentType>::Discard });
+		}
+
+		template<typename Component>
+		void RecordRemove(Entity entity, DeferredEntity deferred)
+		{
+			using ComponentType = std::decay_t<Component>;
+
+			Record({ COMMAND_COMPONENT, static_cast<UInt32>(ComponentTypeIndex<ComponentType>::Value()), entity, deferred,
+				nullptr, &ComponentCommands<ComponentType>::Remove, nullptr });
+		}
+
+	public:
+		/* Streams are sized for the job system's workers at construction */
+		EntityCommandBuffer()
+			: mPayloads(64 * 1024)
+		{
+			mStreams.Resize(GetJobSystem().GetWorkerCount() + 1);
+		}
+
+		EntityCommandBuffer(const EntityCommandBuffer&) = delete;
+		EntityCommandBuffer& operator=(const EntityCommandBuffer&) = delete;
+
+		~EntityCommandBuffer()
+		{
+			Clear();
+		}
+
+		/* Reserves an entity to be created on playback */
+		DeferredEntity CreateEntity()
+		{
+			const UInt32 stream = StreamIndex();
+
+			if (stream == 0)
+			{
+				std::lock_guard<std::mutex> guard(mSharedLock);
+				return { 0, mStreams[0].createCount++ };
+			}
+
+			return { stream, mStreams[stream].createCount++ };
+		}
+
+		void DestroyEntity(Entity entity)
+		{
+			Record({ COMMAND_DESTROY, 0, entity, { 0, NO_DEFERRED }, nullptr, nullptr, nullptr });
+		}
+
+		template<typename... Component>
+		void AddComponent(Entity entity, Component&&... component)
+		{
+			(RecordAdd<Component>(entity, { 0, NO_DEFERRED }, std::forward<Component>(component)), ...);
+		}
+
+		template<typename... Component>
+		void AddComponent(DeferredEntity entity, Component&&... component)
+		{
+			(RecordAdd<Component>(NullEntity, entity, std::forward<Component>(component)), ...);
+		}
+
+		template<typename... Component>
+		void RemoveComponent(Entity entity)
+		{
+			(RecordRemove<Component>(entity, { 0, NO_DEFERRED }), ...);
+		}
+
+		/* Applies every recorded command to world and clears the buffer */
+		void Playback(EntityWorld& world);
+
+		/* The entity created for deferred by the last Playback */
+		FORCE_INLINE Entity GetCreatedEntity(DeferredEntity deferred) const
+		{
+			return mStreams[deferred.stream].created[deferred.index];
+		}
+
+		/* Drops every recorded command without applying it */
+		void Clear()
+		{
+			for (CommandStream& stream : mStreams)
+			{
+				for (Command& command : stream.commands)
+				{
+					if (command.pDiscard != nullptr)
+					{
+						command.pDiscard(command.pComponent);
+					}
+				}
+
+				stream.commands.Clear();
+				stream.createCount = 0;
+			}
+
+			mPayloads.Reset();
+		}
+
+		Bool8 IsEmpty() const
+		{
+			for (const CommandStream& stream : mStreams)
+			{
+				if (stream.commands.Size() > 0 || stream.createCount > 0)
+				{
+					return false;
+				}
+			}
+
+			return true;
+		}
+	};
+}
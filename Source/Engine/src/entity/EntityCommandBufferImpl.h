@@ -0,0 +1,107 @@
+#pragma once
+
+//////////////////////////////////////////////////////////////
+// EntityCommandBuffer Implementation
+//////////////////////////////////////////////////////////////
+
+#include "EntityCommandBuffer.h"
+#include "World.h"
+
+#include <algorithm>
+
+namespace Quartz
+{
+	template<typename ComponentType>
+	void ComponentCommands<ComponentType>::Add(EntityWorld& world, Entity entity, void* pComponent)
+	{
+		ComponentType& component = *static_cast<ComponentType*>(pComponent);
+		world.AddComponent(entity, std::move(component));
+		component.~ComponentType();
+	}
+
+	template<typename ComponentType>
+	void ComponentCommands<ComponentType>::Remove(EntityWorld& world, Entity entity, void* pComponent)
+	{
+		if (world.HasComponent<ComponentType>(entity))
+		{
+			world.RemoveComponent<ComponentType>(entity);
+		}
+	}
+
+	inline void EntityCommandBuffer::Playback(EntityWorld& world)
+	{
+		USize commandCount = 0;
+
+		for (CommandStream& stream : mStreams)
+		{
+			stream.created.Clear();
+
+			for (UInt32 i = 0; i < stream.createCount; i++)
+			{
+				stream.created.PushBack(world.CreateEntity());
+			}
+
+			commandCount += stream.commands.Size();
+		}
+
+		Array<SortEntry> entries;
+		entries.Reserve(commandCount);
+
+		for (UInt32 streamIndex = 0; streamIndex < mStreams.Size(); streamIndex++)
+		{
+			Array<Command>& commands = mStreams[streamIndex].commands;
+
+			for (UInt32 sequence = 0; sequence < commands.Size(); sequence++)
+			{
+				Command& command = commands[sequence];
+				const Entity entity = command.deferred.index != NO_DEFERRED ?
+					mStreams[command.deferred.stream].created[command.deferred.index] : command.entity;
+
+				entries.PushBack({ command.type, command.typeIndex, entity.index, streamIndex, sequence, entity, &command });
+			}
+		}
+
+		// Component commands grouped by type then entity, destroys last.
+		// Stream and sequence keep each thread's commands in recorded order
+		std::sort(entries.Data(), entries.Data() + entries.Size(), [](const SortEntry& entry1, const SortEntry& entry2)
+		{
+			if (entry1.type != entry2.type) return entry1.type < entry2.type;
+			if (entry1.typeIndex != entry2.typeIndex) return entry1.typeIndex < entry2.typeIndex;
+			if (entry1.entityIndex != entry2.entityIndex) return entry1.entityIndex < entry2.entityIndex;
+			if (entry1.stream != entry2.stream) return entry1.stream < entry2.stream;
+			return entry1.sequence < entry2.sequence;
+		});
+
+		for (const SortEntry& entry : entries)
+		{
+			Command& command = *entry.pCommand;
+
+			if (!world.IsAlive(entry.entity))
+			{
+				if (command.pDiscard != nullptr)
+				{
+					command.pDiscard(command.pComponent);
+				}
+
+				continue;
+			}
+
+			if (command.type == COMMAND_DESTROY)
+			{
+				world.DestroyEntity(entry.entity);
+			}
+			else
+			{
+				command.pApply(world, entry.entity, command.pComponent);
+			}
+		}
+
+		for (CommandStream& stream : mStreams)
+		{
+			stream.commands.Clear();
+			stream.createCount = 0;
+		}
+
+		mPayloads.Reset();
+	}
+}
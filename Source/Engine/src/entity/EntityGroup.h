@@ -0,0 +1,201 @@
+#pragma once
+
+#include "Common.h"
+#include "Entity.h"
+#include "Component.h"
+#include "util/Tuple.h"
+#include "util/Storage.h"
+#include "thread/JobSystem.h"
+
+#include <atomic>
+
+namespace Quartz
+{
+	/* Notified by EntityWorld whenever an owned component is added or removed */
+	class EntityGroupBase
+	{
+	public:
+		friend class EntityWorld;
+
+	protected:
+		/* Called after a component owned by the group is added to entity */
+		virtual void OnAdd(Entity entity) = 0;
+
+		/* Called before a component owned by the group is removed from entity */
+		virtual void OnRemove(Entity entity) = 0;
+
+		/* Called after owned storages were cleared or reloaded in bulk */
+		virtual void Refresh() = 0;
+
+	public:
+		virtual ~EntityGroupBase() = default;
+	};
+
+	/*
+		An owning group over sparse component storages. Entities holding
+		every component of the group are kept packed at the front of each
+		owned storage, in the same order, so the group can be iterated as
+		parallel arrays without any lookups. A storage can only be owned by
+		a single group.
+	*/
+	template<typename... Component>
+	class EntityGroup : public EntityGroupBase
+	{
+	public:
+
+		template<typename ComponentType>
+		using ComponentStorage = Storage<ComponentType, Entity, Entity::HandleIntType>;
+		using EntitySet = SparseSet<Entity, Entity::HandleIntType>;
+
+	private:
+		Tuple<ComponentStorage<Component>*...>	mStorages;
+		EntitySet*								mpLead;
+		const std::atomic<UInt32>*				mpChangeTick;
+		USize									mSize;
+
+	private:
+		template<typename First, typename... Rest>
+		static EntitySet* Lead(First* pFirst, Rest*...)
+		{
+			return pFirst;
+		}
+
+		template<typename ComponentType>
+		FORCE_INLINE ComponentStorage<ComponentType>* GetStorage()
+		{
+			return mStorages.template Get<ComponentStorage<ComponentType>*>();
+		}
+
+		FORCE_INLINE Bool8 HasAll(Entity entity)
+		{
+			return (GetStorage<Component>()->Contains(entity) && ...);
+		}
+
+		template<typename ComponentType>
+		FORCE_INLINE void SwapInto(Entity entity, USize index)
+		{
+			ComponentStorage<ComponentType>* pStorage = GetStorage<ComponentType>();
+			pStorage->SwapDense(pStorage->Index(entity), static_cast<Entity::HandleIntType>(index));
+		}
+
+		/* Marks the group's range of ComponentType changed at tick if func may write it */
+		template<typename Func, typename ComponentType>
+		FORCE_INLINE void MarkWritten(USize begin, USize end, UInt32 tick)
+		{
+			if constexpr (WritesComponent<Func, ComponentType>::value)
+			{
+				GetStorage<ComponentType>()->MarkChanged(static_cast<Entity::HandleIntType>(begin),
+					static_cast<Entity::HandleIntType>(end), tick);
+			}
+		}
+
+		/* Columns are raw pointers, or the PagedArray of paged storages */
+		template<typename Func, typename... Columns>
+		FORCE_INLINE void ForEachColumns(USize begin, USize end, Func& func, UInt32 tick, Columns&&... columns)
+		{
+			Entity* pEntities = mpLead->Data();
+
+			for (USize i = begin; i < end; i++)
+			{
+				func(pEntities[i], columns[i]...);
+			}
+
+			(MarkWritten<Func, Component>(begin, end, tick), ...);
+		}
+
+	protected:
+		void OnAdd(Entity entity) override
+		{
+			if (!HasAll(entity) || mpLead->Index(entity) < mSize)
+			{
+				return;
+			}
+
+			(SwapInto<Component>(entity, mSize), ...);
+			mSize++;
+		}
+
+		void OnRemove(Entity entity) override
+		{
+			if (!HasAll(entity) || mpLead->Index(entity) >= mSize)
+			{
+				return;
+			}
+
+			mSize--;
+			(SwapInto<Component>(entity, mSize), ...);
+		}
+
+		void Refresh() override
+		{
+			mSize = 0;
+
+			for (USize i = 0; i < mpLead->Size(); i++)
+			{
+				OnAdd(mpLead->Data()[i]);
+			}
+		}
+
+	public:
+		/*
+			Packs every entity already holding all components. Components
+			changed through ForEach are stamped with the current *pChangeTick.
+		*/
+		EntityGroup(const std::atomic<UInt32>* pChangeTick, ComponentStorage<Component>*... pStorages)
+			: mStorages(static_cast<ComponentStorage<Component>*>(pStorages)...), mpLead(Lead(pStorages...)),
+			mpChangeTick(pChangeTick), mSize(0)
+		{
+			Refresh();
+		}
+
+		FORCE_INLINE Bool8 Contains(Entity entity)
+		{
+			return mpLead->Contains(entity) && mpLead->Index(entity) < mSize;
+		}
+
+		/* Entities of the group, parallel to GetComponents() */
+		FORCE_INLINE Entity* GetEntities()
+		{
+			return mpLead->Data();
+		}
+
+		/* Not available for paged component types */
+		template<typename ComponentType>
+		FORCE_INLINE ComponentType* GetComponents()
+		{
+			return GetStorage<ComponentType>()->GetDenseData();
+		}
+
+		/*
+			Calls func(Entity, Component&...) for every entity in the group.
+			Tracked components func takes by non-const reference are marked
+			changed, as with GetComponentMut.
+		*/
+		template<typename Func>
+		void ForEach(Func&& func)
+		{
+			const UInt32 tick = mpChangeTick->load(std::memory_order_relaxed);
+			ForEachColumns(0, mSize, func, tick, GetStorage<Component>()->GetColumn()...);
+		}
+
+		/*
+			Calls func(Entity, Component&...) for every entity in the group,
+			split into ranges across the job system's workers. func must be
+			safe to call concurrently for different entities and may not add
+			or remove components.
+		*/
+		template<typename Func>
+		void ParallelForEach(Func&& func, USize minBatch = 64)
+		{
+			const UInt32 tick = mpChangeTick->load(std::memory_order_relaxed);
+
+			GetJobSystem().ParallelFor(mSize, [this, &func, tick](USize begin, USize end)
+			{
+				ForEachColumns(begin, end, func, tick, GetStorage<Component>()->GetColumn()...);
+			},
+			minBatch);
+		}
+
+		FORCE_INLINE USize Size() const { return mSize; }
+	};
+}
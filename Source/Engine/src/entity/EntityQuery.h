@@ -0,0 +1,386 @@
+#pragma once
+
+#include "Common.h"
+#include "Entity.h"
+#include "Component.h"
+#include "Archetype.h"
+#include "util/Array.h"
+#include "util/Tuple.h"
+#include "util/Storage.h"
+#include "thread/JobSystem.h"
+
+#include <atomic>
+#include <cstring>
+
+namespace Quartz
+{
+	/* Notified by EntityWorld whenever a component a query reads is added or removed */
+	class EntityQueryBase
+	{
+	public:
+		friend class EntityWorld;
+
+	protected:
+		/* Called after a component of the query is added to entity */
+		virtual void OnAdd(Entity entity) = 0;
+
+		/* Called before a component of the query is removed from entity */
+		virtual void OnRemove(Entity entity) = 0;
+
+		/* Rebuilds the matches after storages were cleared or reloaded in bulk */
+		virtual void Refresh() = 0;
+
+		/* Brings cached dense indices up to date, called before systems run */
+		virtual void UpdateDenseIndices() = 0;
+
+	public:
+		virtual ~EntityQueryBase() = default;
+	};
+
+	/*
+		A persistent view over every entity holding all of Component.
+		Sparse queries keep the set of matching entities up to date as
+		components are added and removed, so iterating them needs neither
+		the smallest set search nor the membership checks of an EntityView.
+		They also cache each match's dense index in every storage, rebuilt
+		only after a storage moved stored values, so a structurally stable
+		world iterates without sparse lookups.
+		Archetype queries keep their matching archetypes and only test the
+		ones created since the last refresh. Unlike groups, queries do not
+		reorder storages and any number of them can share component types.
+	*/
+	template<typename... Component>
+	class EntityQuery : public EntityQueryBase
+	{
+	public:
+
+		template<typename ComponentType>
+		using ComponentStorage = Storage<ComponentType, Entity, Entity::HandleIntType>;
+		using EntitySet = SparseSet<Entity, Entity::HandleIntType>;
+		using IndexType = Entity::HandleIntType;
+
+		constexpr static USize COMPONENT_COUNT = sizeof...(Component);
+
+	private:
+		Tuple<ComponentStorage<Component>*...>	mStorages;
+		EntitySet								mMatches;
+		const std::atomic<UInt32>*				mpChangeTick;
+
+		Array<IndexType>						mDenseIndices;	// COMPONENT_COUNT per match, in match order
+		UInt32									mLayoutVersions[COMPONENT_COUNT];
+		Bool8									mIndicesValid;
+
+		const ArchetypeStorage*					mpArchetypes;
+		Array<Archetype*>						mMatchedArchetypes;
+		USize									mCheckedArchetypes;
+
+	private:
+		template<typename ComponentType>
+		FORCE_INLINE ComponentStorage<ComponentType>* GetStorage()
+		{
+			return mStorages.template Get<ComponentStorage<ComponentType>*>();
+		}
+
+		FORCE_INLINE Bool8 HasAll(Entity entity)
+		{
+			return (GetStorage<Component>()->Contains(entity) && ...);
+		}
+
+		FORCE_INLINE void PushDenseIndices(Entity entity)
+		{
+			(mDenseIndices.PushBack(GetStorage<Component>()->Index(entity)), ...);
+		}
+
+		/* Components func may write are marked changed at tick */
+		template<typename Func, typename ComponentType>
+		FORCE_INLINE static ComponentType& Fetch(ComponentStorage<ComponentType>* pStorage, const IndexType* pRow, UInt32 tick)
+		{
+			const IndexType index = pRow[TupleGetIndex<ComponentType, 0, Component...>::index];
+
+			if constexpr (WritesComponent<Func, ComponentType>::value)
+			{
+				return pStorage->GetDenseMut(index, tick);
+			}
+			else
+			{
+				return pStorage->GetDense(index);
+			}
+		}
+
+		/* Dense indices must be up to date */
+		template<typename Func>
+		FORCE_INLINE void ForEachMatch(USize begin, USize end, Func& func, UInt32 tick, ComponentStorage<Component>*... pStorages)
+		{
+			Entity* pEntities = mMatches.Data();
+			const IndexType* pIndices = mDenseIndices.Data();
+
+			for (USize i = begin; i < end; i++)
+			{
+				const IndexType* pRow = pIndices + i * COMPONENT_COUNT;
+				func(pEntities[i], Fetch<Func>(pStorages, pRow, tick)...);
+			}
+		}
+
+		template<typename Func>
+		FORCE_INLINE void ForEachRow(Entity* pEntities, USize count, Func& func, Component*... pColumns)
+		{
+			for (USize i = 0; i < count; i++)
+			{
+				func(pEntities[i], pColumns[i]...);
+			}
+		}
+
+		template<typename ComponentType>
+		FORCE_INLINE static ComponentType* GetColumn(Archetype* pArchetype, USize chunk)
+		{
+			const Int32 column = pArchetype->GetColumn(ComponentTypeIndex<ComponentType>::Value());
+			return reinterpret_cast<ComponentType*>(pArchetype->GetColumnData(chunk, column));
+		}
+
+		template<typename Func>
+		FORCE_INLINE void ForEachInChunk(Archetype* pArchetype, USize chunk, Func& func)
+		{
+			ForEachRow(pArchetype->GetEntities(chunk), pArchetype->GetChunkSize(chunk), func,
+				GetColumn<Component>(pArchetype, chunk)...);
+		}
+
+	protected:
+		void OnAdd(Entity entity) override
+		{
+			if (!mMatches.Contains(entity) && HasAll(entity))
+			{
+				mMatches.Insert(entity);
+
+				if (mIndicesValid)
+				{
+					PushDenseIndices(entity);
+				}
+			}
+		}
+
+		void OnRemove(Entity entity) override
+		{
+			if (mMatches.Contains(entity))
+			{
+				if (mIndicesValid)
+				{
+					// Mirror the swap with the last match in mMatches
+					const USize row = mMatches.Index(entity) * COMPONENT_COUNT;
+					const USize lastRow = mDenseIndices.Size() - COMPONENT_COUNT;
+
+					for (USize i = 0; i < COMPONENT_COUNT; i++)
+					{
+						mDenseIndices[row + i] = mDenseIndices[lastRow + i];
+					}
+
+					mDenseIndices.Resize(lastRow);
+				}
+
+				mMatches.Remove(entity);
+			}
+		}
+
+		void Refresh() override
+		{
+			if (mpArchetypes != nullptr)
+			{
+				// Archetypes are never destroyed, only new ones need testing
+				const Array<Archetype*>& archetypes = mpArchetypes->GetArchetypes();
+				const USize types[] = { ComponentTypeIndex<Component>::Value()... };
+
+				for (; mCheckedArchetypes < archetypes.Size(); mCheckedArchetypes++)
+				{
+					Archetype* pArchetype = archetypes[mCheckedArchetypes];
+
+					if (pArchetype->Contains(types, sizeof...(Component)))
+					{
+						mMatchedArchetypes.PushBack(pArchetype);
+					}
+				}
+
+				return;
+			}
+
+			mMatches.Clear();
+			mIndicesValid = false;
+
+			EntitySet* pSets[] = { static_cast<EntitySet*>(GetStorage<Component>())... };
+			EntitySet* pSmallest = pSets[0];
+
+			for (EntitySet* pSet : pSets)
+			{
+				pSmallest = pSet->Size() < pSmallest->Size() ? pSet : pSmallest;
+			}
+
+			for (USize i = 0; i < pSmallest->Size(); i++)
+			{
+				OnAdd(pSmallest->Data()[i]);
+			}
+
+			UpdateDenseIndices();
+		}
+
+		void UpdateDenseIndices() override
+		{
+			if (mpArchetypes != nullptr)
+			{
+				return;
+			}
+
+			const UInt32 versions[] = { GetStorage<Component>()->GetLayoutVersion()... };
+
+			if (mIndicesValid && memcmp(versions, mLayoutVersions, sizeof(versions)) == 0)
+			{
+				return;
+			}
+
+			mDenseIndices.Clear();
+			mDenseIndices.Reserve(mMatches.Size() * COMPONENT_COUNT);
+
+			for (USize i = 0; i < mMatches.Size(); i++)
+			{
+				PushDenseIndices(mMatches.Data()[i]);
+			}
+
+			memcpy(mLayoutVersions, versions, sizeof(versions));
+			mIndicesValid = true;
+		}
+
+	public:
+		/*
+			Matches every entity already holding all components. Components
+			changed through ForEach are stamped with the current *pChangeTick.
+		*/
+		EntityQuery(const std::atomic<UInt32>* pChangeTick, ComponentStorage<Component>*... pStorages)
+			: mStorages(static_cast<ComponentStorage<Component>*>(pStorages)...), mpChangeTick(pChangeTick),
+			mLayoutVersions(), mIndicesValid(false), mpArchetypes(nullptr), mCheckedArchetypes(0)
+		{
+			Refresh();
+		}
+
+		EntityQuery(const ArchetypeStorage& storage)
+			: mStorages(), mpChangeTick(nullptr), mLayoutVersions(), mIndicesValid(false),
+			mpArchetypes(&storage), mCheckedArchetypes(0)
+		{
+			Refresh();
+		}
+
+		EntityQuery(const EntityQuery&) = delete;
+		EntityQuery& operator=(const EntityQuery&) = delete;
+
+		/*
+			Calls func(Entity, Component&...) for every matching entity.
+			Tracked components func takes by non-const reference are marked
+			changed, as with GetComponentMut. Rebuilds the cached dense
+			indices first if a storage moved values since the last call.
+		*/
+		template<typename Func>
+		void ForEach(Func&& func)
+		{
+			if (mpArchetypes == nullptr)
+			{
+				UpdateDenseIndices();
+
+				const UInt32 tick = mpChangeTick->load(std::memory_order_relaxed);
+				ForEachMatch(0, mMatches.Size(), func, tick, GetStorage<Component>()...);
+				return;
+			}
+
+			for (Archetype* pArchetype : mMatchedArchetypes)
+			{
+				for (USize chunk = 0; chunk < pArchetype->GetChunkCount(); chunk++)
+				{
+					ForEachInChunk(pArchetype, chunk, func);
+				}
+			}
+		}
+
+		/* Calls func(Entity) for every matching entity, without fetching components */
+		template<typename Func>
+		void ForEachEntity(Func&& func)
+		{
+			if (mpArchetypes == nullptr)
+			{
+				for (USize i = 0; i < mMatches.Size(); i++)
+				{
+					func(mMatches.Data()[i]);
+				}
+
+				return;
+			}
+
+			for (Archetype* pArchetype : mMatchedArchetypes)
+			{
+				for (USize chunk = 0; chunk < pArchetype->GetChunkCount(); chunk++)
+				{
+					Entity* pEntities = pArchetype->GetEntities(chunk);
+
+					for (USize i = 0; i < pArchetype->GetChunkSize(chunk); i++)
+					{
+						func(pEntities[i]);
+					}
+				}
+			}
+		}
+
+		/*
+			Calls func(Entity, Component&...) for every matching entity, split
+			across the job system's workers. func must be safe to call
+			concurrently for different entities and may not add or remove
+			components. Archetype queries split each archetype by chunk.
+		*/
+		template<typename Func>
+		void ParallelForEach(Func&& func, USize minBatch = 64)
+		{
+			if (mpArchetypes == nullptr)
+			{
+				UpdateDenseIndices();
+
+				const UInt32 tick = mpChangeTick->load(std::memory_order_relaxed);
+
+				GetJobSystem().ParallelFor(mMatches.Size(), [this, &func, tick](USize begin, USize end)
+				{
+					ForEachMatch(begin, end, func, tick, GetStorage<Component>()...);
+				},
+				minBatch);
+
+				return;
+			}
+
+			for (Archetype* pArchetype : mMatchedArchetypes)
+			{
+				GetJobSystem().ParallelFor(pArchetype->GetChunkCount(), [this, &func, pArchetype](USize begin, USize end)
+				{
+					for (USize chunk = begin; chunk < end; chunk++)
+					{
+						ForEachInChunk(pArchetype, chunk, func);
+					}
+				},
+				1);
+			}
+		}
+
+		/* Matching entities of a sparse query, in no particular order */
+		FORCE_INLINE Entity* GetEntities()
+		{
+			return mMatches.Data();
+		}
+
+		USize Size() const
+		{
+			if (mpArchetypes == nullptr)
+			{
+				return mMatches.Size();
+			}
+
+			USize size = 0;
+
+			for (const Archetype* pArchetype : mMatchedArchetypes)
+			{
+				size += pArchetype->Size();
+			}
+
+			return size;
+		}
+	};
+}
@@ -2,12 +2,31 @@
 
 #include "Common.h"
 #include "Entity.h"
+#include "Component.h"
+#include "Archetype.h"
 #include "util/Tuple.h"
 #include "util/Storage.h"
 #include "util/Utility.h"
+#include "util/InlineArray.h"
+#include "thread/JobSystem.h"
+
+#include <atomic>
 
 namespace Quartz
 {
+	/*
+		A run of entities in a view. Sparse views have a single span over
+		the smallest component set. Archetype views have one span per
+		matching archetype, whose chunks are walked while iterating, and
+		pEntities is null.
+	*/
+	struct EntitySpan
+	{
+		Entity*		pEntities;
+		USize		count;
+		Archetype*	pArchetype;
+	};
+
 	template<typename... Component>
 	class EntityView
 	{
@@ -16,91 +35,129 @@ namespace Quartz
 		template<typename ComponentType>
 		using ComponentStorage = Storage<ComponentType, Entity, Entity::HandleIntType>;
 		using EntitySet = SparseSet<Entity, Entity::HandleIntType>;
+		using SpanArray = InlineArray<EntitySpan, 8>;
+
+		/* Passes entities whose component tick is newer than since */
+		struct TickFilter
+		{
+			EntitySet*	pSet;
+			UInt32		(*pGetTick)(const EntitySet* pSet, Entity entity);
+			UInt32		since;
+		};
 
 		class Iterator
 		{
 		private:
-			EntitySet::Iterator itr;
-			EntityView<Component...>* pView;
-		public:
-			Iterator()
-				: itr(EntitySet::Iterator(nullptr)) { }
-
-			Iterator(EntitySet::Iterator itr, EntityView<Component...>* pView)
-				: itr(itr), pView(pView) { }
+			EntityView<Component...>*	pView;
+			Entity*						pEntity;
+			Entity*						pSpanEnd;
+			USize						spanIndex;
+			USize						chunk;
 
-			Iterator(const Iterator& it)
-				: itr(it.itr), pView(it.pView) { }
-
-			Iterator& operator++()
+		private:
+			void LoadSpan(USize index)
 			{
-				if constexpr (sizeof...(Component) == 1)
+				const EntitySpan& span = pView->mSpans[index];
+				spanIndex = index;
+				chunk = 0;
+
+				if (span.pArchetype != nullptr)
 				{
-					++itr;
-					return *this;
+					LoadChunk(span.pArchetype);
+					return;
 				}
-				else
+
+				pEntity = span.pEntities;
+				pSpanEnd = span.pEntities + span.count;
+			}
+
+			void LoadChunk(Archetype* pArchetype)
+			{
+				pEntity = pArchetype->GetEntities(chunk);
+				pSpanEnd = pEntity + pArchetype->GetChunkSize(chunk);
+			}
+
+			/* Advances to the next entity in the view, or to the end */
+			void Settle()
+			{
+				while (true)
 				{
-					while (true)
+					if (pEntity == pSpanEnd)
 					{
-						++itr;
+						Archetype* pArchetype = pView->mSpans[spanIndex].pArchetype;
 
-						if (*this == pView->end() || 
-							(pView->mStorages.Get<ComponentStorage<Component>*>()->Contains(itr->index) && ...))
+						if (pArchetype != nullptr && chunk + 1 < pArchetype->GetChunkCount())
 						{
-							return *this;
+							chunk++;
+							LoadChunk(pArchetype);
+							continue;
 						}
+
+						if (spanIndex + 1 >= pView->mSpans.Size())
+						{
+							pEntity = nullptr;
+							return;
+						}
+
+						LoadSpan(spanIndex + 1);
+						continue;
 					}
 
-					return *this;
-				}
-			}
+					if (pView->Accept(*pEntity))
+					{
+						return;
+					}
 
-			Iterator operator++(int)
-			{
-				Iterator temp(*this);
-				(*this)++;
-				return *temp;
+					++pEntity;
+				}
 			}
 
-			Bool8 operator==(const Iterator& it) const
-			{
-				return itr == it.itr;
-			}
+		public:
+			Iterator()
+				: pView(nullptr), pEntity(nullptr), pSpanEnd(nullptr), spanIndex(0), chunk(0) { }
 
-			Bool8 operator!=(const Iterator& it) const
+			explicit Iterator(EntityView<Component...>* pView)
+				: pView(pView), pEntity(nullptr), pSpanEnd(nullptr), spanIndex(0), chunk(0)
 			{
-				return itr != it.itr;
+				if (pView->mSpans.Size() > 0)
+				{
+					LoadSpan(0);
+					Settle();
+				}
 			}
 
-			Bool8 operator>=(const Iterator& it) const
+			Iterator& operator++()
 			{
-				return itr >= it.itr;
+				++pEntity;
+				Settle();
+				return *this;
 			}
 
-			Bool8 operator<=(const Iterator& it) const
+			Iterator operator++(int)
 			{
-				return itr <= it.itr;
+				Iterator temp(*this);
+				++(*this);
+				return temp;
 			}
 
-			Bool8 operator>(const Iterator& it) const
+			Bool8 operator==(const Iterator& it) const
 			{
-				return itr > it.itr;
+				return pEntity == it.pEntity;
 			}
 
-			Bool8 operator<(const Iterator& it) const
+			Bool8 operator!=(const Iterator& it) const
 			{
-				return itr < it.itr;
+				return pEntity != it.pEntity;
 			}
 
 			Entity& operator*()
 			{
-				return *itr;
+				return *pEntity;
 			}
 
 			Entity* operator->()
 			{
-				return itr;
+				return pEntity;
 			}
 		};
 
@@ -109,9 +166,13 @@ namespace Quartz
 	private:
 		Tuple<ComponentStorage<Component>*...>	mStorages;
 		EntitySet*								mPrimarySet;
-		
+		const std::atomic<UInt32>*				mpChangeTick;
+		SpanArray								mSpans;
+		InlineArray<TickFilter, 2>				mTickFilters;
+		Bool8									mFiltered;
+
 	private:
-		SparseSet<Entity>* FindSmallest()
+		EntitySet* FindSmallest()
 		{
 			return FoldCompare
 			(
@@ -120,26 +181,259 @@ namespace Quartz
 					return set1->Size() < set2->Size();
 				},
 
-				static_cast<EntitySet*>(mStorages.Get<ComponentStorage<Component>*>())...
+				static_cast<EntitySet*>(mStorages.template Get<ComponentStorage<Component>*>())...
 			);
 		}
 
+		/* Sparse spans may hold entities missing the other components */
+		FORCE_INLINE Bool8 Accept(Entity entity)
+		{
+			if constexpr (sizeof...(Component) > 1)
+			{
+				if (mFiltered &&
+					!(mStorages.template Get<ComponentStorage<Component>*>()->Contains(entity.index) && ...))
+				{
+					return false;
+				}
+			}
+
+			for (const TickFilter& filter : mTickFilters)
+			{
+				if (filter.pGetTick(filter.pSet, entity) <= filter.since)
+				{
+					return false;
+				}
+			}
+
+			return true;
+		}
+
+		template<typename ComponentType>
+		void AddTickFilter(UInt32 (*pGetTick)(const EntitySet* pSet, Entity entity), UInt32 since)
+		{
+			ComponentStorage<ComponentType>* pStorage = mStorages.template Get<ComponentStorage<ComponentType>*>();
+
+			// Untracked storages and archetype views pass everything
+			if (pStorage != nullptr && pStorage->IsTracked())
+			{
+				mTickFilters.PushBack({ pStorage, pGetTick, since });
+			}
+		}
+
+		template<typename ComponentType>
+		FORCE_INLINE static ComponentType* GetColumn(Archetype* pArchetype, USize chunk)
+		{
+			const Int32 column = pArchetype->GetColumn(ComponentTypeIndex<ComponentType>::Value());
+			return reinterpret_cast<ComponentType*>(pArchetype->GetColumnData(chunk, column));
+		}
+
+		/*
+			The primary storage is indexed directly, the others need a sparse
+			lookup. Components func may write are marked changed at tick.
+		*/
+		template<typename Func, typename ComponentType>
+		FORCE_INLINE ComponentType& GetSparse(USize denseIndex, Entity entity, UInt32 tick)
+		{
+			ComponentStorage<ComponentType>* pStorage = mStorages.template Get<ComponentStorage<ComponentType>*>();
+			const Bool8 primary = static_cast<EntitySet*>(pStorage) == mPrimarySet;
+
+			if constexpr (WritesComponent<Func, ComponentType>::value)
+			{
+				return primary ? pStorage->GetDenseMut(static_cast<Entity::HandleIntType>(denseIndex), tick) :
+					pStorage->GetMut(entity.index, tick);
+			}
+			else
+			{
+				return primary ? pStorage->GetDense(static_cast<Entity::HandleIntType>(denseIndex)) :
+					pStorage->Get(entity.index);
+			}
+		}
+
+		FORCE_INLINE UInt32 GetChangeTick() const
+		{
+			return mpChangeTick != nullptr ? mpChangeTick->load(std::memory_order_relaxed) : 0;
+		}
+
+		template<typename Func>
+		FORCE_INLINE void ForEachRow(Entity* pEntities, USize count, Func& func, Component*... pColumns)
+		{
+			for (USize i = 0; i < count; i++)
+			{
+				func(pEntities[i], pColumns[i]...);
+			}
+		}
+
+		template<typename Func>
+		FORCE_INLINE void ForEachInChunk(Archetype* pArchetype, USize chunk, Func& func)
+		{
+			ForEachRow(pArchetype->GetEntities(chunk), pArchetype->GetChunkSize(chunk), func,
+				GetColumn<Component>(pArchetype, chunk)...);
+		}
+
+		/* Calls func for entities [begin, end) of a sparse span */
+		template<typename Func>
+		void ForEachInSpan(const EntitySpan& span, USize begin, USize end, Func& func, UInt32 tick)
+		{
+			for (USize i = begin; i < end; i++)
+			{
+				const Entity entity = span.pEntities[i];
+
+				if (Accept(entity))
+				{
+					func(entity, GetSparse<Func, Component>(i, entity, tick)...);
+				}
+			}
+		}
+
 	public:
 		EntityView()
-			: mStorages(), mPrimarySet(nullptr) { }
+			: mStorages(), mPrimarySet(nullptr), mpChangeTick(nullptr), mFiltered(false) { }
 
-		EntityView(ComponentStorage<Component>*... sets)
+		/* Components changed through ForEach are stamped with the current *pChangeTick */
+		EntityView(const std::atomic<UInt32>* pChangeTick, ComponentStorage<Component>*... sets)
 			: mStorages(static_cast<ComponentStorage<Component>*>(sets)...),
-			mPrimarySet(FindSmallest()) { }
+			mPrimarySet(FindSmallest()), mpChangeTick(pChangeTick), mFiltered(true)
+		{
+			if (mPrimarySet->Size() > 0)
+			{
+				mSpans.PushBack({ mPrimarySet->Data(), mPrimarySet->Size(), nullptr });
+			}
+		}
+
+		EntityView(const ArchetypeStorage& storage)
+			: mStorages(), mPrimarySet(nullptr), mpChangeTick(nullptr), mFiltered(false)
+		{
+			const USize types[] = { ComponentTypeIndex<Component>::Value()... };
+
+			for (Archetype* pArchetype : storage.GetArchetypes())
+			{
+				if (pArchetype->Size() == 0 || !pArchetype->Contains(types, sizeof...(Component)))
+				{
+					continue;
+				}
+
+				mSpans.PushBack({ nullptr, pArchetype->Size(), pArchetype });
+			}
+		}
+
+		/*
+			Filters the view to entities whose ComponentType was changed after
+			tick since, such as a system's last run tick. Requires change
+			tracking on ComponentType, see EntityWorld::TrackChanges.
+		*/
+		template<typename ComponentType>
+		EntityView& Changed(UInt32 since) &
+		{
+			AddTickFilter<ComponentType>([](const EntitySet* pSet, Entity entity)
+			{
+				return static_cast<const ComponentStorage<ComponentType>*>(pSet)->GetChangedTick(entity);
+			},
+			since);
+
+			return *this;
+		}
+
+		/* Returns a copy so filtered temporaries can be iterated with range-for */
+		template<typename ComponentType>
+		EntityView Changed(UInt32 since) &&
+		{
+			Changed<ComponentType>(since);
+			return *this;
+		}
+
+		/* Filters the view to entities whose ComponentType was added after tick since */
+		template<typename ComponentType>
+		EntityView& Added(UInt32 since) &
+		{
+			AddTickFilter<ComponentType>([](const EntitySet* pSet, Entity entity)
+			{
+				return static_cast<const ComponentStorage<ComponentType>*>(pSet)->GetAddedTick(entity);
+			},
+			since);
+
+			return *this;
+		}
+
+		template<typename ComponentType>
+		EntityView Added(UInt32 since) &&
+		{
+			Added<ComponentType>(since);
+			return *this;
+		}
 
 		Iterator begin()
 		{
-			return mPrimarySet != nullptr ? Iterator(mPrimarySet->begin(), this) : Iterator();
+			return Iterator(this);
 		}
 
 		Iterator end()
 		{
-			return  mPrimarySet != nullptr ? Iterator(mPrimarySet->end(), this) : Iterator();
+			return Iterator();
 		}
+
+		/*
+			Calls func(Entity, Component&...) for every entity in the view.
+			Tracked components func takes by non-const reference are marked
+			changed, as with GetComponentMut.
+		*/
+		template<typename Func>
+		void ForEach(Func&& func)
+		{
+			const UInt32 tick = GetChangeTick();
+
+			for (const EntitySpan& span : mSpans)
+			{
+				if (span.pArchetype == nullptr)
+				{
+					ForEachInSpan(span, 0, span.count, func, tick);
+					continue;
+				}
+
+				for (USize chunk = 0; chunk < span.pArchetype->GetChunkCount(); chunk++)
+				{
+					ForEachInChunk(span.pArchetype, chunk, func);
+				}
+			}
+		}
+
+		/*
+			Calls func(Entity, Component&...) for every entity in the view,
+			split across the job system's workers. func must be safe to call
+			concurrently for different entities and may not add or remove
+			components. Sparse views are split into ranges of entities,
+			archetype views split each archetype by chunk.
+		*/
+		template<typename Func>
+		void ParallelForEach(Func&& func, USize minBatch = 64)
+		{
+			const UInt32 tick = GetChangeTick();
+
+			for (const EntitySpan& span : mSpans)
+			{
+				if (span.pArchetype == nullptr)
+				{
+					GetJobSystem().ParallelFor(span.count, [this, &func, &span, tick](USize begin, USize end)
+					{
+						ForEachInSpan(span, begin, end, func, tick);
+					},
+					minBatch);
+
+					continue;
+				}
+
+				Archetype* pArchetype = span.pArchetype;
+
+				GetJobSystem().ParallelFor(pArchetype->GetChunkCount(), [this, &func, pArchetype](USize begin, USize end)
+				{
+					for (USize chunk = begin; chunk < end; chunk++)
+					{
+						ForEachInChunk(pArchetype, chunk, func);
+					}
+				},
+				1);
+			}
+		}
+
+		FORCE_INLINE const SpanArray& GetSpans() const { return mSpans; }
 	};
-}
\ No newline at end of file
+}
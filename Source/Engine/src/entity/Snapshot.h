@@ -0,0 +1,143 @@
+#pragma once
+
+#include "Common.h"
+#include "util/Array.h"
+#include "memory/Allocator.h"
+
+#include <cstring>
+
+namespace Quartz
+{
+	constexpr UInt32 SNAPSHOT_MAGIC		= 0x4E535751; // "QWSN"
+	constexpr UInt32 SNAPSHOT_VERSION	= 2; // 2: portable type ids
+
+	/* Appends raw bytes to a snapshot blob */
+	class SnapshotWriter
+	{
+	private:
+		Array<Byte>& mData;
+
+	public:
+		explicit SnapshotWriter(Array<Byte>& data)
+			: mData(data) {}
+
+		void Write(const void* pData, USize size)
+		{
+			const USize offset = mData.Size();
+
+			if (offset + size > mData.Capacity())
+			{
+				const USize grown = mData.Capacity() * 2;
+				mData.Reserve(grown > offset + size ? grown : offset + size);
+			}
+
+			mData.ResizeNoInit(offset + size);
+
+			if (size > 0)
+			{
+				memcpy(mData.Data() + offset, pData, size);
+			}
+		}
+
+		template<typename Type>
+		void Write(const Type& value)
+		{
+			static_assert(std::is_trivially_copyable<Type>::value, "Only trivially copyable values can be written directly!");
+			Write(&value, sizeof(Type));
+		}
+
+		/* Overwrites bytes already written, eg. a size only known afterwards */
+		void WriteAt(USize offset, const void* pData, USize size)
+		{
+			DEBUG_ASSERT(offset + size <= mData.Size() && "Writing past the end of the snapshot!");
+			memcpy(mData.Data() + offset, pData, size);
+		}
+
+		/* Pads with zeros until the next write is aligned to alignment */
+		void Align(USize alignment)
+		{
+			static const Byte zeros[DEFAULT_ALIGNMENT] = {};
+
+			const USize padding = (alignment - (mData.Size() & (alignment - 1))) & (alignment - 1);
+			Write(zeros, padding);
+		}
+
+		FORCE_INLINE USize GetOffset() const { return mData.Size(); }
+	};
+
+	/* Reads a snapshot blob back, every read fails once the blob is exhausted */
+	class SnapshotReader
+	{
+	private:
+		const Byte*	mpData;
+		USize		mSize;
+		USize		mOffset;
+		Bool8		mFailed;
+
+	public:
+		SnapshotReader(const Byte* pData, USize size)
+			: mpData(pData), mSize(size), mOffset(0), mFailed(false) {}
+
+		/* Returns the next size bytes in place, nullptr if the blob is too short */
+		const Byte* ReadBytes(USize size)
+		{
+			if (mFailed || size > mSize - mOffset)
+			{
+				mFailed = true;
+				return nullptr;
+			}
+
+			const Byte* pBytes = mpData + mOffset;
+			mOffset += size;
+
+			return pBytes;
+		}
+
+		Bool8 Read(void* pData, USize size)
+		{
+			const Byte* pBytes = ReadBytes(size);
+
+			if (pBytes == nullptr)
+			{
+				return false;
+			}
+
+			if (size > 0)
+			{
+				memcpy(pData, pBytes, size);
+			}
+
+			return true;
+		}
+
+		template<typename Type>
+		Bool8 Read(Type& value)
+		{
+			static_assert(std::is_trivially_copyable<Type>::value, "Only trivially copyable values can be read directly!");
+			return Read(&value, sizeof(Type));
+		}
+
+		/* Skips the padding written by SnapshotWriter::Align */
+		Bool8 Align(USize alignment)
+		{
+			const USize padding = (alignment - (mOffset & (alignment - 1))) & (alignment - 1);
+			return ReadBytes(padding) != nullptr;
+		}
+
+		FORCE_INLINE Bool8 IsFailed() const { return mFailed; }
+		FORCE_INLINE USize GetOffset() const { return mOffset; }
+		FORCE_INLINE USize GetRemaining() const { return mSize - mOffset; }
+	};
+
+	/*
+		Writes and reads a component type that cannot be copied as raw
+		bytes. Read should report a short blob through SnapshotReader,
+		whatever it returns then is discarded.
+	*/
+	template<typename ComponentType>
+	struct SnapshotSerializer
+	{
+		using WriteFunc	= void (*)(SnapshotWriter& writer, const ComponentType& component);
+		using ReadFunc	= ComponentType (*)(SnapshotReader& reader);
+	};
+}
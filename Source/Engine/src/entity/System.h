@@ -5,36 +5,72 @@
 
 namespace Quartz
 {
+	/*
+		A system run for every entity with all of Component. Const components
+		are declared as read and others as written, so systems that only
+		share const components can run in parallel.
+	*/
 	template<typename... Component>
 	class System : public SystemBase
 	{
 	private:
+		/* Cached on registration, so concurrent systems never create queries */
+		EntityQuery<std::remove_const_t<Component>...>* mpQuery = nullptr;
+
+	private:
+		void DeclareAccess(SystemAccess& access) override
+		{
+			(access.Declare<Component>(), ...);
+			OnDeclareAccess(access);
+		}
+
+		void InitAll(EntityWorld& world) override
+		{
+			mpQuery = &world.Query<std::remove_const_t<Component>...>();
+			OnInit(world);
+		}
+
 		void UpdateAll(EntityWorld& world, Float32 deltaTime) override
 		{
-			for (Entity entity : world.CreateView<Component...>())
+			mpQuery->ForEachEntity([this, &world, deltaTime](Entity entity)
 			{
 				OnUpdate(world, entity, deltaTime);
-			}
+			});
 		}
 
 		void TickAll(EntityWorld& world, Float32 deltaTime) override
 		{
-			for (Entity entity : world.CreateView<Component...>())
+			mpQuery->ForEachEntity([this, &world, deltaTime](Entity entity)
 			{
 				OnTick(world, entity, deltaTime);
-			}
+			});
 		}
 
 	public:
+		/* Declare components accessed outside of the iterated ones */
+		virtual void OnDeclareAccess(SystemAccess& access) {};
+
 		virtual void OnInit(EntityWorld& world) {};
 		virtual void OnUpdate(EntityWorld& world, Entity entity, Float32 deltaTime) {};
 		virtual void OnTick(EntityWorld& world, Entity entity, Float32 deltaTime) {};
 		virtual void OnDestroy(EntityWorld& world) {};
 	};
 
+	/* A system run once per update. Exclusive unless OnDeclareAccess says otherwise */
 	class SingletonSystem : public SystemBase
 	{
 	private:
+		void DeclareAccess(SystemAccess& access) override
+		{
+			access.exclusive = true;
+			OnDeclareAccess(access);
+		}
+
+		FORCE_INLINE void InitAll(EntityWorld& world) override
+		{
+			OnInit(world);
+		}
+
 		FORCE_INLINE void UpdateAll(EntityWorld& world, Float32 deltaTime) override
 		{
 			OnUpdate(world, deltaTime);
@@ -46,6 +82,8 @@ namespace Quartz
 		}
 
 	public:
+		virtual void OnDeclareAccess(SystemAccess& access) {};
+
 		virtual void OnInit(EntityWorld& world) {};
 		virtual void OnUpdate(EntityWorld& world, Float32 deltaTime) {};
 		virtual void OnTick(EntityWorld& world, Float32 deltaTime) {};
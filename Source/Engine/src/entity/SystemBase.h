@@ -2,23 +2,113 @@
 
 #include "Common.h"
 #include "Entity.h"
+#include "Component.h"
+#include "util/Array.h"
+
+#include <type_traits>
 
 namespace Quartz
 {
 	class EntityWorld;
 
+	/*
+		The components a system reads and writes. The scheduler runs systems
+		whose access does not conflict at the same time. Exclusive systems,
+		such as ones creating or destroying entities, conflict with every
+		other system.
+	*/
+	struct SystemAccess
+	{
+		Array<USize>	reads;
+		Array<USize>	writes;
+		Bool8			exclusive	= false;
+		Bool8			mainThread	= false;	// Always run on the main thread
+
+		template<typename Component>
+		void Read()
+		{
+			reads.PushBack(ComponentTypeIndex<std::remove_const_t<Component>>::Value());
+		}
+
+		template<typename Component>
+		void Write()
+		{
+			writes.PushBack(ComponentTypeIndex<std::remove_const_t<Component>>::Value());
+		}
+
+		/* Const components are read, others are written */
+		template<typename Component>
+		void Declare()
+		{
+			if constexpr (std::is_const_v<Component>)
+			{
+				Read<Component>();
+			}
+			else
+			{
+				Write<Component>();
+			}
+		}
+
+		Bool8 ConflictsWith(const SystemAccess& access) const
+		{
+			if (exclusive || access.exclusive)
+			{
+				return true;
+			}
+
+			for (USize write : writes)
+			{
+				if (access.reads.Contains(write) || access.writes.Contains(write))
+				{
+					return true;
+				}
+			}
+
+			for (USize read : reads)
+			{
+				if (access.writes.Contains(read))
+				{
+					return true;
+				}
+			}
+
+			return false;
+		}
+	};
+
 	class SystemBase
 	{
 	public:
 		friend class EntityWorld;
+		friend class SystemScheduler;
+
+	private:
+		UInt32 mLastRunTick = 0;
 
 	protected:
+		/*
+			The world's change tick when this system last finished, pass it to
+			EntityView::Changed or Added to visit only what changed since. The
+			system's own writes in that run are not newer than it.
+		*/
+		FORCE_INLINE UInt32 GetLastRunTick() const { return mLastRunTick; }
+
 		virtual void OnInit(EntityWorld& world) = 0;
 
+		/* Prepares the system's own state and calls OnInit, once on registration */
+		virtual void InitAll(EntityWorld& world) = 0;
+
+		/* Fills access before OnInit, called once on registration */
+		virtual void DeclareAccess(SystemAccess& access) = 0;
+
 		virtual void UpdateAll(EntityWorld& world, Float32 deltaTime) = 0;
 		virtual void TickAll(EntityWorld& world, Float32 deltaTime) = 0;
 
 		virtual void OnDestroy(EntityWorld& world) = 0;
+
+	public:
+		virtual ~SystemBase() = default;
 	};
 
-}
\ No newline at end of file
+}
@@ -0,0 +1,196 @@
+#pragma once
+
+#include "Common.h"
+#include "SystemBase.h"
+#include "util/Array.h"
+#include "thread/JobSystem.h"
+
+#include <atomic>
+
+namespace Quartz
+{
+	enum SystemPhase
+	{
+		SYSTEM_PHASE_UPDATE,
+		SYSTEM_PHASE_TICK
+	};
+
+	/*
+		Runs the systems of a world on the job system. Each system depends on
+		every earlier registered system whose access conflicts with its own,
+		so conflicting systems always run in registration order while the
+		rest run concurrently. The graph is rebuilt only when systems are
+		added or removed.
+
+		Systems flagged mainThread only run while the main thread waits, so
+		a world with such systems must be updated from the main thread.
+	*/
+	class SystemScheduler
+	{
+	private:
+		struct SystemNode
+		{
+			SystemBase*		pSystem;
+			SystemAccess	access;
+			Array<UInt32>	successors;
+			UInt32			dependencies;
+		};
+
+		Array<SystemNode>		mNodes;
+		Array<UInt32>			mRoots;
+		std::atomic<UInt32>*	mpRemaining;
+		Bool8					mDirty;
+
+	private:
+		void Build()
+		{
+			for (SystemNode& node : mNodes)
+			{
+				node.successors.Clear();
+				node.dependencies = 0;
+			}
+
+			mRoots.Clear();
+
+			for (UInt32 i = 0; i < mNodes.Size(); i++)
+			{
+				for (UInt32 j = 0; j < i; j++)
+				{
+					if (mNodes[i].access.ConflictsWith(mNodes[j].access))
+					{
+						mNodes[j].successors.PushBack(i);
+						mNodes[i].dependencies++;
+					}
+				}
+
+				if (mNodes[i].dependencies == 0)
+				{
+					mRoots.PushBack(i);
+				}
+			}
+
+			delete[] mpRemaining;
+			mpRemaining = mNodes.Size() > 0 ? new std::atomic<UInt32>[mNodes.Size()] : nullptr;
+
+			mDirty = false;
+		}
+
+		/*
+			Advances the world's change tick before and after the run. The last
+			run tick is the newest tick the system's own writes can be stamped
+			with, so Changed<T>(GetLastRunTick()) excludes them while every
+			later change is newer.
+		*/
+		static FORCE_INLINE void RunSystem(SystemBase* pSystem, EntityWorld& world, std::atomic<UInt32>& changeTick,
+			SystemPhase phase, Float32 deltaTime)
+		{
+			changeTick.fetch_add(1, std::memory_order_relaxed);
+
+			if (phase == SYSTEM_PHASE_UPDATE)
+			{
+				pSystem->UpdateAll(world, deltaTime);
+			}
+			else
+			{
+				pSystem->TickAll(world, deltaTime);
+			}
+
+			pSystem->mLastRunTick = changeTick.fetch_add(1, std::memory_order_relaxed);
+		}
+
+		void SubmitNode(JobSystem& jobs, UInt32 index, EntityWorld* pWorld, std::atomic<UInt32>* pChangeTick,
+			SystemPhase phase, Float32 deltaTime, JobCounter* pCounter)
+		{
+			const JobAffinity affinity = mNodes[index].access.mainThread ? JOB_AFFINITY_MAIN : JOB_AFFINITY_ANY;
+
+			jobs.Submit([this, &jobs, index, pWorld, pChangeTick, phase, deltaTime, pCounter]()
+			{
+				RunSystem(mNodes[index].pSystem, *pWorld, *pChangeTick, phase, deltaTime);
+
+				// Release successors whose last dependency this was
+				for (UInt32 successor : mNodes[index].successors)
+				{
+					if (mpRemaining[successor].fetch_sub(1, std::memory_order_acq_rel) == 1)
+					{
+						SubmitNode(jobs, successor, pWorld, pChangeTick, phase, deltaTime, pCounter);
+					}
+				}
+			},
+			pCounter, nullptr, affinity);
+		}
+
+	public:
+		SystemScheduler()
+			: mpRemaining(nullptr), mDirty(false) { }
+
+		SystemScheduler(const SystemScheduler&) = delete;
+		SystemScheduler& operator=(const SystemScheduler&) = delete;
+
+		~SystemScheduler()
+		{
+			delete[] mpRemaining;
+		}
+
+		/* Appends pSystem to the schedule, reading its declared access */
+		void Add(SystemBase* pSystem)
+		{
+			SystemNode node;
+			node.pSystem = pSystem;
+			node.dependencies = 0;
+			pSystem->DeclareAccess(node.access);
+
+			mNodes.PushBack(Move(node));
+			mDirty = true;
+		}
+
+		void Remove(SystemBase* pSystem)
+		{
+			for (USize i = 0; i < mNodes.Size(); i++)
+			{
+				if (mNodes[i].pSystem == pSystem)
+				{
+					mNodes.Remove(i);
+					mDirty = true;
+					return;
+				}
+			}
+		}
+
+		/* Runs every system once and returns when all have finished */
+		void Run(EntityWorld& world, std::atomic<UInt32>& changeTick, SystemPhase phase, Float32 deltaTime)
+		{
+			if (mDirty)
+			{
+				Build();
+			}
+
+			JobSystem& jobs = GetJobSystem();
+
+			if (mNodes.Size() <= 1 || !jobs.IsInitialized() || jobs.GetWorkerCount() == 1)
+			{
+				for (SystemNode& node : mNodes)
+				{
+					RunSystem(node.pSystem, world, changeTick, phase, deltaTime);
+				}
+
+				return;
+			}
+
+			for (UInt32 i = 0; i < mNodes.Size(); i++)
+			{
+				mpRemaining[i].store(mNodes[i].dependencies, std::memory_order_relaxed);
+			}
+
+			JobCounter counter;
+
+			for (UInt32 root : mRoots)
+			{
+				SubmitNode(jobs, root, &world, &changeTick, phase, deltaTime, &counter);
+			}
+
+			jobs.Wait(counter);
+		}
+
+		FORCE_INLINE USize Size() const { return mNodes.Size(); }
+	};
+}
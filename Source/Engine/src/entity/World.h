@@ -1,17 +1,39 @@
 #pragma once
 
-#include "util\Array.h"
-#include "util\Map.h"
-#include "util\TypeId.h"
-#include "util\Buffer.h"
-#include "util\Storage.h"
+#include "util/Array.h"
+#include "util/Map.h"
+#include "util/TypeId.h"
+#include "util/Buffer.h"
+#include "util/Storage.h"
 
 #include "Entity.h"
+#include "Component.h"
+#include "Archetype.h"
 #include "EntityView.h"
+#include "EntityGroup.h"
+#include "EntityQuery.h"
 #include "SystemBase.h"
+#include "SystemScheduler.h"
+#include "EntityCommandBuffer.h"
+#include "Snapshot.h"
+
+#include <atomic>
 
 namespace Quartz
 {
+	/*
+		How an EntityWorld stores components. Sparse worlds keep one sparse
+		set per component type, which makes adding and removing components
+		cheap. Archetype worlds group entities with identical component types
+		into chunks, which makes iterating several components cheap at the
+		cost of moving rows on every structural change.
+	*/
+	enum EntityStorageMode
+	{
+		ENTITY_STORAGE_SPARSE,
+		ENTITY_STORAGE_ARCHETYPE
+	};
+
 	class EntityWorld
 	{
 	public:
@@ -21,7 +43,7 @@ namespace Quartz
 		using EntitySet = SparseSet<Entity, Entity::HandleIntType>;
 
 	private:
-		struct ComponentTypeCounter
+		struct SystemTypeCounter
 		{
 			static USize Next()
 			{
@@ -31,16 +53,16 @@ namespace Quartz
 		};
 
 		template<typename ComponentType>
-		struct ComponentTypeIndex
+		struct SystemTypeIndex
 		{
 			static USize Value()
 			{
-				static USize index = ComponentTypeCounter::Next();
+				static USize index = SystemTypeCounter::Next();
 				return index;
 			}
 		};
 
-		struct SystemTypeCounter
+		struct GroupTypeCounter
 		{
 			static USize Next()
 			{
@@ -49,70 +71,632 @@ namespace Quartz
 			}
 		};
 
-		template<typename ComponentType>
-		struct SystemTypeIndex
+		template<typename GroupType>
+		struct GroupTypeIndex
 		{
 			static USize Value()
 			{
-				static USize index = SystemTypeCounter::Next();
+				static USize index = GroupTypeCounter::Next();
 				return index;
 			}
 		};
 
+		/* Type-erased operations on a sparse component storage */
+		struct StorageOps
+		{
+			void (*pRemove)(EntitySet* pSet, Entity entity);
+			void (*pClear)(EntitySet* pSet);
+			void (*pDelete)(EntitySet* pSet);
+
+			template<typename ComponentType>
+			static const StorageOps* Of()
+			{
+				static const StorageOps ops =
+				{
+					[](EntitySet* pSet, Entity entity)
+					{
+						static_cast<ComponentStorage<ComponentType>*>(pSet)->Remove(entity);
+					},
+
+					[](EntitySet* pSet)
+					{
+						static_cast<ComponentStorage<ComponentType>*>(pSet)->Clear();
+					},
+
+					[](EntitySet* pSet)
+					{
+						delete static_cast<ComponentStorage<ComponentType>*>(pSet);
+					}
+				};
+
+				return &ops;
+			}
+		};
+
+		/* A component type saved in snapshots */
+		struct SnapshotType
+		{
+			TypeId		id;
+			USize		typeIndex;
+			void		(*pSave)(EntitySet* pSet, SnapshotWriter& writer, const SnapshotType& type);
+			Bool8		(*pLoad)(EntityWorld& world, SnapshotReader& reader, const SnapshotType& type, UInt32 tick);
+			void		(*pWrite)();	// Type-erased serializer, nullptr to copy raw bytes
+			void		(*pRead)();
+		};
+
 	private:
-		Array<SystemBase*>	mSystems;
-		Array<EntitySet*>	mStorageSets;
-		Array<Entity>		mEntites;
+		EntityStorageMode			mMode;
+		Array<SystemBase*>			mSystems;
+		SystemScheduler				mScheduler;
+		Array<EntitySet*>			mStorageSets;
+		Array<const StorageOps*>	mStorageOps;
+		Array<EntityGroupBase*>		mGroups;
+		Array<EntityGroupBase*>		mGroupOwners;	// Owning group of each storage, by component type
+		Array<EntityQueryBase*>		mQueries;
+		Array<Array<EntityQueryBase*>>	mQueryWatchers;	// Sparse queries reading each component type
+		ArchetypeStorage			mArchetypes;
+		EntityCommandBuffer			mCommands;
+		Array<SnapshotType>			mSnapshotTypes;
+
+		/*
+			Alive entities hold their own index. Destroyed ones form an
+			implicit free list: their index field links to the next free
+			slot and their version is already bumped for reuse.
+		*/
+		Array<Entity>				mEntites;
+		Entity::HandleIntType		mFreeHead;
+		USize						mAliveCount;
+
+		/* Stamped onto tracked components as they are added or changed */
+		std::atomic<UInt32>			mChangeTick;
 
 	private:
+		Entity AllocateEntity()
+		{
+			mAliveCount++;
+
+			if (mFreeHead == NullEntity.index)
+			{
+				return *mEntites.PushBack(Entity(static_cast<Entity::HandleIntType>(mEntites.Size()), 0));
+			}
+
+			const Entity::HandleIntType index = mFreeHead;
+			Entity& slot = mEntites[index];
+
+			mFreeHead = slot.index;
+			slot.index = index;
+
+			return slot;
+		}
+
+		/* Reuses free slots first, the remaining entities are appended in one go */
+		void AllocateEntities(Entity* pEntities, USize count)
+		{
+			USize i = 0;
+
+			for (; i < count && mFreeHead != NullEntity.index; i++)
+			{
+				pEntities[i] = AllocateEntity();
+			}
+
+			mEntites.Reserve(mEntites.Size() + (count - i));
+
+			for (; i < count; i++)
+			{
+				pEntities[i] = *mEntites.PushBack(Entity(static_cast<Entity::HandleIntType>(mEntites.Size()), 0));
+				mAliveCount++;
+			}
+		}
+
+		void ReleaseEntity(Entity entity)
+		{
+			Entity& slot = mEntites[entity.index];
+
+			slot.index = mFreeHead;
+			slot.version = entity.version + 1;
+
+			mFreeHead = entity.index;
+			mAliveCount--;
+		}
+
+		FORCE_INLINE void NotifyAdd(USize typeIndex, Entity entity)
+		{
+			if (typeIndex < mGroupOwners.Size() && mGroupOwners[typeIndex] != nullptr)
+			{
+				mGroupOwners[typeIndex]->OnAdd(entity);
+			}
+
+			if (typeIndex < mQueryWatchers.Size())
+			{
+				for (EntityQueryBase* pQuery : mQueryWatchers[typeIndex])
+				{
+					pQuery->OnAdd(entity);
+				}
+			}
+		}
+
+		FORCE_INLINE void NotifyRemove(USize typeIndex, Entity entity)
+		{
+			if (typeIndex < mGroupOwners.Size() && mGroupOwners[typeIndex] != nullptr)
+			{
+				mGroupOwners[typeIndex]->OnRemove(entity);
+			}
+
+			if (typeIndex < mQueryWatchers.Size())
+			{
+				for (EntityQueryBase* pQuery : mQueryWatchers[typeIndex])
+				{
+					pQuery->OnRemove(entity);
+				}
+			}
+		}
+
+		void WatchComponent(USize typeIndex, EntityQueryBase* pQuery)
+		{
+			if (typeIndex >= mQueryWatchers.Size())
+			{
+				mQueryWatchers.Resize(typeIndex + 1);
+			}
+
+			mQueryWatchers[typeIndex].PushBack(pQuery);
+		}
+
+		/* Rematches groups and queries after storages changed in bulk, or archetypes were created */
+		void RefreshGroupsAndQueries()
+		{
+			for (EntityGroupBase* pGroup : mGroups)
+			{
+				if (pGroup != nullptr)
+				{
+					pGroup->Refresh();
+				}
+			}
+
+			for (EntityQueryBase* pQuery : mQueries)
+			{
+				if (pQuery != nullptr)
+				{
+					pQuery->Refresh();
+				}
+			}
+		}
+
+		template<typename ComponentType>
+		ComponentStorage<ComponentType>* FindOrCreateStorage()
+		{
+			USize typeIndex = ComponentTypeIndex<ComponentType>::Value();
+
+			if (typeIndex >= mStorageSets.Size())
+			{
+				mStorageSets.Resize(typeIndex + 1, nullptr);
+				mStorageOps.Resize(typeIndex + 1, nullptr);
+			}
+
+			if (mStorageSets[typeIndex] == nullptr)
+			{
+				mStorageSets[typeIndex] = new ComponentStorage<ComponentType>();
+				mStorageOps[typeIndex] = StorageOps::Of<ComponentType>();
+			}
+
+			return static_cast<ComponentStorage<ComponentType>*>(mStorageSets[typeIndex]);
+		}
+
+		void ClaimStorage(USize typeIndex, EntityGroupBase* pGroup)
+		{
+			if (typeIndex >= mGroupOwners.Size())
+			{
+				mGroupOwners.Resize(typeIndex + 1, nullptr);
+			}
+
+			DEBUG_ASSERT(mGroupOwners[typeIndex] == nullptr && "Component is already owned by another group!");
+			mGroupOwners[typeIndex] = pGroup;
+		}
+
+		/* Destroys every entity and component, storages and groups are kept */
+		void ClearEntities()
+		{
+			for (USize i = 0; i < mStorageSets.Size(); i++)
+			{
+				if (mStorageSets[i] != nullptr)
+				{
+					mStorageOps[i]->pClear(mStorageSets[i]);
+				}
+			}
+
+			RefreshGroupsAndQueries();
+
+			mEntites.Clear();
+			mFreeHead = NullEntity.index;
+			mAliveCount = 0;
+		}
+
+		template<typename ComponentType>
+		void AddSnapshotType(void (*pWrite)(), void (*pRead)())
+		{
+			const SnapshotType type = { TypeInfo<ComponentType>::Id(), ComponentTypeIndex<ComponentType>::Value(),
+				&SaveStorage<ComponentType>, &LoadStorage<ComponentType>, pWrite, pRead };
+
+			for (SnapshotType& registered : mSnapshotTypes)
+			{
+				if (registered.id == type.id)
+				{
+					registered = type;
+					return;
+				}
+			}
+
+			mSnapshotTypes.PushBack(type);
+		}
+
+		/* Writes the handles of a storage followed by its values */
+		template<typename ComponentType>
+		static void SaveStorage(EntitySet* pSet, SnapshotWriter& writer, const SnapshotType& type)
+		{
+			ComponentStorage<ComponentType>* pStorage = static_cast<ComponentStorage<ComponentType>*>(pSet);
+			const USize count = pStorage->Size();
+
+			writer.Write(static_cast<UInt64>(count));
+			writer.Align(alignof(Entity));
+			writer.Write(pStorage->Data(), count * sizeof(Entity));
+
+			if constexpr (std::is_trivially_copyable<ComponentType>::value)
+			{
+				if (type.pWrite == nullptr)
+				{
+					// Paged storages are copied a page at a time
+					constexpr USize PAGE_SIZE = ComponentStorage<ComponentType>::PAGE_SIZE;
+					const USize chunk = PAGE_SIZE != 0 ? PAGE_SIZE : count;
+
+					auto&& column = pStorage->GetColumn();
+					writer.Align(alignof(ComponentType));
+
+					for (USize begin = 0; begin < count; begin += chunk)
+					{
+						const USize size = count - begin < chunk ? count - begin : chunk;
+						writer.Write(&column[begin], size * sizeof(ComponentType));
+					}
+
+					return;
+				}
+			}
+
+			auto pWrite = reinterpret_cast<typename SnapshotSerializer<ComponentType>::WriteFunc>(type.pWrite);
+
+			for (USize i = 0; i < count; i++)
+			{
+				pWrite(writer, pStorage->GetDense(static_cast<Entity::HandleIntType>(i)));
+			}
+		}
+
+		/* Reads a storage written by SaveStorage, every handle must already be alive */
+		template<typename ComponentType>
+		static Bool8 LoadStorage(EntityWorld& world, SnapshotReader& reader, const SnapshotType& type, UInt32 tick)
+		{
+			UInt64 count = 0;
+
+			if (!reader.Read(count) || !reader.Align(alignof(Entity)) || count > reader.GetRemaining() / sizeof(Entity))
+			{
+				return false;
+			}
+
+			const Entity* pEntities = reinterpret_cast<const Entity*>(reader.ReadBytes(count * sizeof(Entity)));
+			ComponentStorage<ComponentType>* pStorage = world.FindOrCreateStorage<ComponentType>();
+
+			// One bit per slot catches handles repeated within the storage
+			Array<UInt64> seen;
+			seen.Resize((world.mEntites.Size() + 63) / 64, 0);
+
+			for (USize i = 0; i < count; i++)
+			{
+				const Entity entity = pEntities[i];
+				const UInt64 bit = UInt64(1) << (entity.index & 63);
+
+				if (!world.IsAlive(entity) || pStorage->Contains(entity) || (seen[entity.index / 64] & bit) != 0)
+				{
+					return false;
+				}
+
+				seen[entity.index / 64] |= bit;
+			}
+
+			if constexpr (std::is_trivially_copyable<ComponentType>::value)
+			{
+				if (type.pRead == nullptr)
+				{
+					if (!reader.Align(alignof(ComponentType)) || count > reader.GetRemaining() / sizeof(ComponentType))
+					{
+						return false;
+					}
+
+					const ComponentType* pValues = reinterpret_cast<const ComponentType*>(reader.ReadBytes(count * sizeof(ComponentType)));
+					pStorage->InsertRange(pEntities, pValues, count, tick);
+
+					return true;
+				}
+			}
+
+			auto pRead = reinterpret_cast<typename SnapshotSerializer<ComponentType>::ReadFunc>(type.pRead);
+
+			for (USize i = 0; i < count; i++)
+			{
+				ComponentType component = pRead(reader);
+
+				if (reader.IsFailed())
+				{
+					return false;
+				}
+
+				pStorage->Insert(pEntities[i], Move(component), tick);
+			}
+
+			return true;
+		}
+
+		/*
+			Checks loaded entity slots: aliveCount slots must hold their own
+			index, and the free list must reach every other slot exactly once
+			before ending.
+		*/
+		Bool8 ValidateEntities() const
+		{
+			const USize slotCount = mEntites.Size();
+			USize aliveCount = 0;
+
+			for (USize i = 0; i < slotCount; i++)
+			{
+				aliveCount += static_cast<USize>(mEntites[i].index) == i;
+			}
+
+			if (aliveCount != mAliveCount)
+			{
+				return false;
+			}
+
+			const USize freeCount = slotCount - aliveCount;
+			USize steps = 0;
+
+			for (Entity::HandleIntType index = mFreeHead; index != NullEntity.index; index = mEntites[index].index)
+			{
+				// A free list longer than the free slots has a cycle
+				if (index >= slotCount || static_cast<Entity::HandleIntType>(mEntites[index].index) == index || steps == freeCount)
+				{
+					return false;
+				}
+
+				steps++;
+			}
+
+			return steps == freeCount;
+		}
+
+		/*
+			Picks up new archetypes, or rebuilds stale dense indices of sparse
+			queries, so systems iterating queries concurrently only read them
+		*/
+		void PrepareQueries()
+		{
+			for (EntityQueryBase* pQuery : mQueries)
+			{
+				if (pQuery == nullptr)
+				{
+					continue;
+				}
+
+				if (mMode == ENTITY_STORAGE_ARCHETYPE)
+				{
+					pQuery->Refresh();
+				}
+				else
+				{
+					pQuery->UpdateDenseIndices();
+				}
+			}
+		}
+
+		void RemoveAllComponents(Entity entity)
+		{
+			if (mMode == ENTITY_STORAGE_ARCHETYPE)
+			{
+				mArchetypes.Destroy(entity);
+				return;
+			}
+
+			for (USize i = 0; i < mStorageSets.Size(); i++)
+			{
+				if (mStorageSets[i] != nullptr && mStorageSets[i]->Contains(entity))
+				{
+					NotifyRemove(i, entity);
+					mStorageOps[i]->pRemove(mStorageSets[i], entity);
+				}
+			}
+		}
+
 		template<typename Component>
 		Bool8 HasComponentImpl(Entity entity)
 		{
 			using ComponentType = std::decay_t<Component>;
+
+			// Storages are keyed by index only, a stale handle would see the index's new owner
+			if (!IsAlive(entity))
+			{
+				return false;
+			}
+
+			if (mMode == ENTITY_STORAGE_ARCHETYPE)
+			{
+				return mArchetypes.Has<ComponentType>(entity);
+			}
+
+			if (!ComponentExists<ComponentType>())
+			{
+				return false;
+			}
+
 			USize typeIndex = ComponentTypeIndex<ComponentType>::Value();
-			ComponentStorage<Component>& storage = 
-				*static_cast<ComponentStorage<Component>*>(mStorageSets[typeIndex]);
-			return storage.Contains(entity.index);
+			ComponentStorage<ComponentType>& storage = 
+				*static_cast<ComponentStorage<ComponentType>*>(mStorageSets[typeIndex]);
+			return storage.Contains(entity);
 		}
 
 		template<typename Component>
 		void AddComponentImpl(Entity entity, Component&& component)
 		{
 			using ComponentType = std::decay_t<Component>;
-			USize typeIndex = ComponentTypeIndex<ComponentType>::Value();
 
-			if (typeIndex >= mStorageSets.Size())
+			DEBUG_ASSERT(IsAlive(entity) && "Adding a component to a dead entity!");
+
+			if (mMode == ENTITY_STORAGE_ARCHETYPE)
 			{
-				mStorageSets.Resize(typeIndex + 1, nullptr);
-				mStorageSets[typeIndex] = new ComponentStorage<ComponentType>();
+				mArchetypes.Add(entity, std::forward<Component>(component));
+				return;
 			}
 
-			static_cast<ComponentStorage<ComponentType>*>
-				(mStorageSets[typeIndex])->Insert(entity.index, std::forward<Component>(component));
+			FindOrCreateStorage<ComponentType>()->Insert(entity, std::forward<Component>(component), GetChangeTick());
+			NotifyAdd(ComponentTypeIndex<ComponentType>::Value(), entity);
+		}
+
+		/* Adds pComponents[i], or a copy of *pPrototype, to each of count entities */
+		template<typename ComponentType>
+		void AddComponentsImpl(const Entity* pEntities, USize count, const ComponentType* pComponents, const ComponentType* pPrototype)
+		{
+#ifdef QUARTZ_DEBUG
+			for (USize i = 0; i < count; i++)
+			{
+				DEBUG_ASSERT(IsAlive(pEntities[i]) && "Adding a component to a dead entity!");
+			}
+#endif
+
+			if (mMode == ENTITY_STORAGE_ARCHETYPE)
+			{
+				for (USize i = 0; i < count; i++)
+				{
+					mArchetypes.Add(pEntities[i], pComponents != nullptr ? pComponents[i] : *pPrototype);
+				}
+
+				return;
+			}
+
+			ComponentStorage<ComponentType>* pStorage = FindOrCreateStorage<ComponentType>();
+			const UInt32 tick = GetChangeTick();
+
+			Bool8 anyContained = false;
+
+			for (USize i = 0; i < count && !anyContained; i++)
+			{
+				anyContained = pStorage->Contains(pEntities[i]);
+			}
+
+			if (!anyContained)
+			{
+				if (pComponents != nullptr)
+				{
+					pStorage->InsertRange(pEntities, pComponents, count, tick);
+				}
+				else
+				{
+					pStorage->InsertRange(pEntities, count, *pPrototype, tick);
+				}
+			}
+			else
+			{
+				// Components already held are overwritten, as AddComponent does
+				for (USize i = 0; i < count; i++)
+				{
+					pStorage->Insert(pEntities[i], pComponents != nullptr ? pComponents[i] : *pPrototype, tick);
+				}
+			}
+
+			const USize typeIndex = ComponentTypeIndex<ComponentType>::Value();
+
+			for (USize i = 0; i < count; i++)
+			{
+				NotifyAdd(typeIndex, pEntities[i]);
+			}
 		}
 
 		template<typename Component>
 		void RemoveComponentImpl(Entity entity)
 		{
 			using ComponentType = std::decay_t<Component>;
+
+			DEBUG_ASSERT(IsAlive(entity) && "Removing a component from a dead entity!");
+
+			if (mMode == ENTITY_STORAGE_ARCHETYPE)
+			{
+				mArchetypes.Remove<ComponentType>(entity);
+				return;
+			}
+
 			USize typeIndex = ComponentTypeIndex<ComponentType>::Value();
-			static_cast<ComponentStorage<ComponentType>*>(mStorageSets[typeIndex])->Remove(entity.index);
+			NotifyRemove(typeIndex, entity);
+			static_cast<ComponentStorage<ComponentType>*>(mStorageSets[typeIndex])->Remove(entity);
 		}
 
 	public:
-		FORCE_INLINE void Update(Float32 deltaTime)
+		explicit EntityWorld(EntityStorageMode mode = ENTITY_STORAGE_SPARSE)
+			: mMode(mode), mFreeHead(NullEntity.index), mAliveCount(0), mChangeTick(1) { }
+
+		~EntityWorld()
 		{
-			for (SystemBase* system : mSystems)
+			for (SystemBase* pSystem : mSystems)
 			{
-				system->UpdateAll(*this, deltaTime);
+				if (pSystem != nullptr)
+				{
+					pSystem->OnDestroy(*this);
+					delete pSystem;
+				}
 			}
+
+			for (EntityGroupBase* pGroup : mGroups)
+			{
+				delete pGroup;
+			}
+
+			for (EntityQueryBase* pQuery : mQueries)
+			{
+				delete pQuery;
+			}
+
+			for (USize i = 0; i < mStorageSets.Size(); i++)
+			{
+				if (mStorageSets[i] != nullptr)
+				{
+					mStorageOps[i]->pDelete(mStorageSets[i]);
+				}
+			}
+		}
+
+		EntityWorld(const EntityWorld&) = delete;
+		EntityWorld& operator=(const EntityWorld&) = delete;
+
+		FORCE_INLINE EntityStorageMode GetStorageMode() const { return mMode; }
+
+		/* Runs every system, non-conflicting ones in parallel, then plays back the command buffer */
+		FORCE_INLINE void Update(Float32 deltaTime)
+		{
+			PrepareQueries();
+			mScheduler.Run(*this, mChangeTick, SYSTEM_PHASE_UPDATE, deltaTime);
+			PlaybackCommands();
 		}
 
 		FORCE_INLINE void Tick(Float32 deltaTime)
 		{
-			for (SystemBase* system : mSystems)
+			PrepareQueries();
+			mScheduler.Run(*this, mChangeTick, SYSTEM_PHASE_TICK, deltaTime);
+			PlaybackCommands();
+		}
+
+		/*
+			Structural changes recorded here from systems are applied after
+			all systems of the current Update or Tick have finished.
+		*/
+		FORCE_INLINE EntityCommandBuffer& GetCommandBuffer() { return mCommands; }
+
+		void PlaybackCommands()
+		{
+			if (!mCommands.IsEmpty())
 			{
-				system->TickAll(*this, deltaTime);
+				mCommands.Playback(*this);
 			}
 		}
 
@@ -121,11 +705,16 @@ namespace Quartz
 		{
 			USize typeIndex = SystemTypeIndex<SystemType>::Value();
 
-			if (typeIndex >= mSystems.Size() || mSystems[typeIndex] == nullptr)
+			if (typeIndex >= mSystems.Size())
+			{
+				mSystems.Resize(typeIndex + 1, nullptr);
+			}
+
+			if (mSystems[typeIndex] == nullptr)
 			{
-				mSystems.Resize(typeIndex + 1);
 				mSystems[typeIndex] = static_cast<SystemBase*>(new SystemType());
-				mSystems[typeIndex]->OnInit(*this);
+				mScheduler.Add(mSystems[typeIndex]);
+				mSystems[typeIndex]->InitAll(*this);
 			}
 		}
 
@@ -134,8 +723,9 @@ namespace Quartz
 		{
 			USize typeIndex = SystemTypeIndex<SystemType>::Value();
 			
-			if (typeIndex < mSystems.Size())
+			if (typeIndex < mSystems.Size() && mSystems[typeIndex] != nullptr)
 			{
+				mScheduler.Remove(mSystems[typeIndex]);
 				mSystems[typeIndex]->OnDestroy(*this);
 				delete mSystems[typeIndex];
 				mSystems[typeIndex] = nullptr;
@@ -160,17 +750,157 @@ namespace Quartz
 		template<typename... Component>
 		Entity CreateEntity(Component&&... component)
 		{
-			Entity entity = *mEntites.PushBack(Entity(mEntites.Size(), 0));
-			AddComponent(entity, std::forward<Component>(component)...);
+			Entity entity = AllocateEntity();
+
+			if (mMode == ENTITY_STORAGE_ARCHETYPE)
+			{
+				// Place the entity directly in its final archetype
+				mArchetypes.Insert(entity, std::forward<Component>(component)...);
+			}
+			else
+			{
+				AddComponent(entity, std::forward<Component>(component)...);
+			}
+
 			return entity;
 		}
 
+		/*
+			Creates count entities holding copies of prototype, written to
+			pEntities. Sparse storages grow their dense arrays once and take
+			the batch's missing sparse blocks from one allocation. Archetype
+			worlds allocate the batch's new chunks together and fill them a
+			chunk column at a time.
+		*/
+		template<typename... Component>
+		void CreateEntities(Entity* pEntities, USize count, const Component&... prototype)
+		{
+			AllocateEntities(pEntities, count);
+
+			if (mMode == ENTITY_STORAGE_ARCHETYPE)
+			{
+				mArchetypes.InsertRange(pEntities, count, prototype...);
+				return;
+			}
+
+			AddComponents(pEntities, count, prototype...);
+		}
+
+		template<typename... Component>
+		Array<Entity> CreateEntities(USize count, const Component&... prototype)
+		{
+			Array<Entity> entities(count);
+			CreateEntities(entities.Data(), count, prototype...);
+
+			return entities;
+		}
+
+		/* Removes every component of entity and recycles its index with a new version */
+		void DestroyEntity(Entity entity)
+		{
+			DEBUG_ASSERT(IsAlive(entity) && "Destroying a dead entity!");
+
+			RemoveAllComponents(entity);
+			ReleaseEntity(entity);
+		}
+
+		/* Destroys count entities, sparse worlds sweep one storage at a time */
+		void DestroyEntities(const Entity* pEntities, USize count)
+		{
+			if (mMode == ENTITY_STORAGE_SPARSE)
+			{
+				for (USize i = 0; i < mStorageSets.Size(); i++)
+				{
+					EntitySet* pSet = mStorageSets[i];
+
+					if (pSet == nullptr)
+					{
+						continue;
+					}
+
+					for (USize j = 0; j < count; j++)
+					{
+						if (pSet->Contains(pEntities[j]))
+						{
+							NotifyRemove(i, pEntities[j]);
+							mStorageOps[i]->pRemove(pSet, pEntities[j]);
+						}
+					}
+				}
+			}
+
+			for (USize i = 0; i < count; i++)
+			{
+				DEBUG_ASSERT(IsAlive(pEntities[i]) && "Destroying a dead entity!");
+
+				if (mMode == ENTITY_STORAGE_ARCHETYPE)
+				{
+					mArchetypes.Destroy(pEntities[i]);
+				}
+
+				ReleaseEntity(pEntities[i]);
+			}
+		}
+
+		FORCE_INLINE void DestroyEntities(const Array<Entity>& entities)
+		{
+			DestroyEntities(entities.Data(), entities.Size());
+		}
+
+		/* False once entity is destroyed, even if its index was reused */
+		FORCE_INLINE Bool8 IsAlive(Entity entity) const
+		{
+			return entity.index < mEntites.Size() && mEntites[entity.index].handle == entity.handle;
+		}
+
+		FORCE_INLINE USize GetEntityCount() const { return mAliveCount; }
+
 		template<typename... Component>
 		void AddComponent(Entity entity, Component&&... component)
 		{
+			(void)entity;
 			(AddComponentImpl<Component>(entity, std::forward<Component>(component)), ...);
 		}
 
+		/* Adds a copy of each prototype component to count distinct entities */
+		template<typename... Component>
+		void AddComponents(const Entity* pEntities, USize count, const Component&... prototype)
+		{
+			(AddComponentsImpl<Component>(pEntities, count, nullptr, &prototype), ...);
+		}
+
+		/* Adds pComponents[i] to pEntities[i] for count distinct entities */
+		template<typename Component>
+		void AddComponents(const Entity* pEntities, const Component* pComponents, USize count)
+		{
+			AddComponentsImpl<Component>(pEntities, count, pComponents, nullptr);
+		}
+
+		/*
+			Reserves room for count Components in total, so adding them does
+			not grow the storage. The sparse blocks of entities created past
+			the free slots are reserved too. Archetype worlds grow a chunk at
+			a time and ignore this.
+		*/
+		template<typename Component>
+		void Reserve(USize count)
+		{
+			if (mMode == ENTITY_STORAGE_SPARSE)
+			{
+				ComponentStorage<std::decay_t<Component>>* pStorage = FindOrCreateStorage<std::decay_t<Component>>();
+				const USize added = count > pStorage->Size() ? count - pStorage->Size() : 0;
+				const USize freeCount = mEntites.Size() - mAliveCount;
+
+				pStorage->Reserve(count);
+
+				if (added > freeCount)
+				{
+					pStorage->ReserveSparse(static_cast<Entity::HandleIntType>(mEntites.Size()),
+						static_cast<Entity::HandleIntType>(mEntites.Size() + added - freeCount));
+				}
+			}
+		}
+
 		template<typename... Component>
 		void RemoveComponent(Entity entity)
 		{
@@ -183,32 +913,343 @@ namespace Quartz
 			return (HasComponentImpl<Component>(entity) && ...);
 		}
 
-		/* Assumes entity has component. Undefiened otherwise.*/
+		/* Assumes entity is alive and has component. Undefiened otherwise.*/
 		template<typename Component>
 		Component& GetComponent(Entity entity)
 		{
 			using ComponentType = std::decay_t<Component>;
+
+			DEBUG_ASSERT(IsAlive(entity) && "Getting a component of a dead entity!");
+
+			if (mMode == ENTITY_STORAGE_ARCHETYPE)
+			{
+				return mArchetypes.Get<ComponentType>(entity);
+			}
+
+			USize typeIndex = ComponentTypeIndex<ComponentType>::Value();
+			return static_cast<ComponentStorage<ComponentType>*>(mStorageSets[typeIndex])->Get(entity);
+		}
+
+		/* Same as GetComponent, marking the component changed for Changed view filters */
+		template<typename Component>
+		Component& GetComponentMut(Entity entity)
+		{
+			using ComponentType = std::decay_t<Component>;
+
+			DEBUG_ASSERT(IsAlive(entity) && "Getting a component of a dead entity!");
+
+			if (mMode == ENTITY_STORAGE_ARCHETYPE)
+			{
+				return mArchetypes.Get<ComponentType>(entity);
+			}
+
+			USize typeIndex = ComponentTypeIndex<ComponentType>::Value();
+			return static_cast<ComponentStorage<ComponentType>*>(mStorageSets[typeIndex])->GetMut(entity, GetChangeTick());
+		}
+
+		/*
+			Records the tick Component is added and changed at for every entity,
+			so views can be filtered to Added or Changed since a given tick.
+			Only GetComponentMut and the ForEach and ParallelForEach of views,
+			queries and groups count as changes. Writes through GetComponent,
+			view iterators or group arrays are not seen. Archetype worlds do
+			not track changes, their filters pass everything.
+		*/
+		template<typename Component>
+		void TrackChanges()
+		{
+			if (mMode == ENTITY_STORAGE_SPARSE)
+			{
+				FindOrCreateStorage<Component>()->EnableTracking();
+			}
+		}
+
+		/* True if Component of entity changed after tick since, or if Component is not tracked */
+		template<typename Component>
+		Bool8 HasChanged(Entity entity, UInt32 since)
+		{
+			using ComponentType = std::decay_t<Component>;
+
+			DEBUG_ASSERT(IsAlive(entity) && "Checking a component of a dead entity!");
+
+			if (mMode == ENTITY_STORAGE_ARCHETYPE || !ComponentExists<ComponentType>())
+			{
+				return true;
+			}
+
 			USize typeIndex = ComponentTypeIndex<ComponentType>::Value();
-			return static_cast<ComponentStorage<ComponentType>*>(mStorageSets[typeIndex])->Get(entity.index);
+			ComponentStorage<ComponentType>* pStorage = static_cast<ComponentStorage<ComponentType>*>(mStorageSets[typeIndex]);
+
+			return !pStorage->IsTracked() || pStorage->GetChangedTick(entity) > since;
+		}
+
+		FORCE_INLINE UInt32 GetChangeTick() const
+		{
+			return mChangeTick.load(std::memory_order_relaxed);
+		}
+
+		/* Returns the current tick, changes made after this call are stamped later */
+		FORCE_INLINE UInt32 AdvanceChangeTick()
+		{
+			return mChangeTick.fetch_add(1, std::memory_order_relaxed);
 		}
 
 		template<typename Component>
 		Bool8 ComponentExists()
 		{
-			return ComponentTypeIndex<Component>::Value() < mStorageSets.Size();
+			USize typeIndex = ComponentTypeIndex<Component>::Value();
+			return typeIndex < mStorageSets.Size() && mStorageSets[typeIndex] != nullptr;
 		}
 
 		template<typename... Component>
 		EntityView<Component...> CreateView()
 		{
+			if (mMode == ENTITY_STORAGE_ARCHETYPE)
+			{
+				return EntityView<Component...>(mArchetypes);
+			}
+
 			if ((!ComponentExists<Component>() || ...))
 			{
 				// One or more components does not exist in this world
 				return EntityView<Component...>();
 			}
 
-			return EntityView<Component...>(
+			return EntityView<Component...>(&mChangeTick,
 				static_cast<ComponentStorage<Component>*>(mStorageSets[ComponentTypeIndex<Component>::Value()])...);
 		}
+
+		/*
+			Saves Component in snapshots by copying its dense array as raw
+			bytes. Component must be trivially copyable, other types need a
+			serializer.
+		*/
+		template<typename Component>
+		void RegisterSnapshotType()
+		{
+			static_assert(std::is_trivially_copyable<Component>::value, "Component is not trivially copyable, register a serializer!");
+			static_assert(alignof(Component) <= DEFAULT_ALIGNMENT, "Over-aligned components cannot be copied from snapshots!");
+
+			AddSnapshotType<Component>(nullptr, nullptr);
+		}
+
+		/* Saves Component in snapshots through pWrite and pRead */
+		template<typename Component>
+		void RegisterSnapshotType(typename SnapshotSerializer<Component>::WriteFunc pWrite,
+			typename SnapshotSerializer<Component>::ReadFunc pRead)
+		{
+			AddSnapshotType<Component>(reinterpret_cast<void (*)()>(pWrite), reinterpret_cast<void (*)()>(pRead));
+		}
+
+		/*
+			Appends every entity and the storages of all snapshot types to
+			data as a single versioned blob. Components of types that are not
+			registered are not saved. Only sparse worlds support snapshots.
+		*/
+		void SaveSnapshot(Array<Byte>& data)
+		{
+			DEBUG_ASSERT(mMode == ENTITY_STORAGE_SPARSE && "Snapshots require sparse component storage!");
+
+			UInt32 storageCount = 0;
+
+			for (const SnapshotType& type : mSnapshotTypes)
+			{
+				storageCount += type.typeIndex < mStorageSets.Size() && mStorageSets[type.typeIndex] != nullptr;
+			}
+
+			SnapshotWriter writer(data);
+
+			writer.Write(SNAPSHOT_MAGIC);
+			writer.Write(SNAPSHOT_VERSION);
+			writer.Write(static_cast<UInt64>(mEntites.Size()));
+			writer.Write(static_cast<UInt64>(mAliveCount));
+			writer.Write(static_cast<UInt32>(mFreeHead));
+			writer.Write(storageCount);
+			writer.Write(mEntites.Data(), mEntites.Size() * sizeof(Entity));
+
+			for (const SnapshotType& type : mSnapshotTypes)
+			{
+				if (type.typeIndex >= mStorageSets.Size() || mStorageSets[type.typeIndex] == nullptr)
+				{
+					continue;
+				}
+
+				// Storage sizes let loaders skip types they do not know
+				writer.Write(type.id);
+				const USize sizeOffset = writer.GetOffset();
+				writer.Write(UInt64(0));
+
+				type.pSave(mStorageSets[type.typeIndex], writer, type);
+
+				const UInt64 size = writer.GetOffset() - sizeOffset - sizeof(UInt64);
+				writer.WriteAt(sizeOffset, &size, sizeof(UInt64));
+			}
+		}
+
+		/*
+			Replaces every entity and component with the contents of a blob
+			written by SaveSnapshot. Trivially copyable storages are copied
+			straight from the blob, so pData must be aligned to
+			DEFAULT_ALIGNMENT as Array<Byte> is. Storages of unregistered
+			types are skipped. Loaded components count as added and changed
+			at the current tick.
+
+			Returns false if the blob is not a snapshot of this version,
+			leaving the world untouched, or if it is truncated or corrupt,
+			leaving the world empty.
+		*/
+		Bool8 LoadSnapshot(const Byte* pData, USize size)
+		{
+			DEBUG_ASSERT(mMode == ENTITY_STORAGE_SPARSE && "Snapshots require sparse component storage!");
+			DEBUG_ASSERT((reinterpret_cast<USize>(pData) & (DEFAULT_ALIGNMENT - 1)) == 0 && "Snapshot data is misaligned!");
+
+			SnapshotReader reader(pData, size);
+
+			UInt32 magic = 0;
+			UInt32 version = 0;
+			UInt64 slotCount = 0;
+			UInt64 aliveCount = 0;
+			UInt32 freeHead = 0;
+			UInt32 storageCount = 0;
+
+			reader.Read(magic);
+			reader.Read(version);
+			reader.Read(slotCount);
+			reader.Read(aliveCount);
+			reader.Read(freeHead);
+			reader.Read(storageCount);
+
+			if (reader.IsFailed() || magic != SNAPSHOT_MAGIC || version != SNAPSHOT_VERSION ||
+				slotCount > reader.GetRemaining() / sizeof(Entity) || aliveCount > slotCount ||
+				(freeHead != NullEntity.index && freeHead >= slotCount))
+			{
+				return false;
+			}
+
+			ClearEntities();
+
+			mEntites.Append(reinterpret_cast<const Entity*>(reader.ReadBytes(slotCount * sizeof(Entity))), slotCount);
+			mFreeHead = freeHead;
+			mAliveCount = aliveCount;
+
+			if (!ValidateEntities())
+			{
+				ClearEntities();
+				return false;
+			}
+
+			const UInt32 tick = GetChangeTick();
+
+			for (UInt32 i = 0; i < storageCount; i++)
+			{
+				TypeId id = 0;
+				UInt64 storageSize = 0;
+
+				if (!reader.Read(id) || !reader.Read(storageSize) || storageSize > reader.GetRemaining())
+				{
+					ClearEntities();
+					return false;
+				}
+
+				const USize storageEnd = reader.GetOffset() + storageSize;
+				const SnapshotType* pType = nullptr;
+
+				for (const SnapshotType& type : mSnapshotTypes)
+				{
+					if (type.id == id)
+					{
+						pType = &type;
+						break;
+					}
+				}
+
+				if (pType == nullptr)
+				{
+					reader.ReadBytes(storageSize);
+					continue;
+				}
+
+				if (!pType->pLoad(*this, reader, *pType, tick) || reader.GetOffset() != storageEnd)
+				{
+					ClearEntities();
+					return false;
+				}
+			}
+
+			RefreshGroupsAndQueries();
+
+			return true;
+		}
+
+		FORCE_INLINE Bool8 LoadSnapshot(const Array<Byte>& data)
+		{
+			return LoadSnapshot(data.Data(), data.Size());
+		}
+
+		/*
+			Returns the cached query over Component..., creating it on first
+			use. Sparse queries are updated on every structural change,
+			archetype queries pick up new archetypes whenever they are
+			returned from here and before systems run.
+		*/
+		template<typename... Component>
+		EntityQuery<Component...>& Query()
+		{
+			// Queries share the group type counter
+			USize queryIndex = GroupTypeIndex<EntityQuery<Component...>>::Value();
+
+			if (queryIndex >= mQueries.Size())
+			{
+				mQueries.Resize(queryIndex + 1, nullptr);
+			}
+
+			if (mQueries[queryIndex] == nullptr)
+			{
+				if (mMode == ENTITY_STORAGE_ARCHETYPE)
+				{
+					mQueries[queryIndex] = new EntityQuery<Component...>(mArchetypes);
+				}
+				else
+				{
+					mQueries[queryIndex] = new EntityQuery<Component...>(&mChangeTick, FindOrCreateStorage<Component>()...);
+					(WatchComponent(ComponentTypeIndex<Component>::Value(), mQueries[queryIndex]), ...);
+				}
+			}
+			else if (mMode == ENTITY_STORAGE_ARCHETYPE)
+			{
+				mQueries[queryIndex]->Refresh();
+			}
+
+			return *static_cast<EntityQuery<Component...>*>(mQueries[queryIndex]);
+		}
+
+		/*
+			Returns the owning group of Component..., creating it on first use.
+			Each component type can be owned by a single group. Only sparse
+			worlds support groups, archetype chunks are already packed.
+		*/
+		template<typename... Component>
+		EntityGroup<Component...>& Group()
+		{
+			DEBUG_ASSERT(mMode == ENTITY_STORAGE_SPARSE && "Groups require sparse component storage!");
+
+			USize groupIndex = GroupTypeIndex<EntityGroup<Component...>>::Value();
+
+			if (groupIndex >= mGroups.Size())
+			{
+				mGroups.Resize(groupIndex + 1, nullptr);
+			}
+
+			if (mGroups[groupIndex] == nullptr)
+			{
+				EntityGroup<Component...>* pGroup = new EntityGroup<Component...>(&mChangeTick, FindOrCreateStorage<Component>()...);
+				(ClaimStorage(ComponentTypeIndex<Component>::Value(), pGroup), ...);
+				mGroups[groupIndex] = pGroup;
+			}
+
+			return *static_cast<EntityGroup<Component...>*>(mGroups[groupIndex]);
+		}
 	};
-}
\ No newline at end of file
+}
+
+#include "EntityCommandBufferImpl.h"
\ No newline at end of file
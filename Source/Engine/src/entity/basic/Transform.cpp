@@ -5,17 +5,23 @@ namespace Quartz
     TransformComponent::TransformComponent() :
         position({ 0.0f, 0.0f, 0.0f }),
         rotation(Quaternion().SetEuler({ 0.0f, 0.0f, 0.0f })),
-        scale({ 1.0f, 1.0f, 1.0f })
+        scale({ 1.0f, 1.0f, 1.0f }),
+        parent(NullEntity),
+        depth(0)
     {
-        // Nothing
+        localMatrix = GetMatrix();
+        worldMatrix = localMatrix;
     }
 
     TransformComponent::TransformComponent(const Vector3& position, const Quaternion& rotation, const Vector3& scale) :
         position(position),
         rotation(rotation),
-        scale(scale)
+        scale(scale),
+        parent(NullEntity),
+        depth(0)
     {
-        // Nothing
+        localMatrix = GetMatrix();
+        worldMatrix = localMatrix;
     }
 
     Vector3 TransformComponent::GetForward()
@@ -50,10 +56,7 @@ namespace Quartz
 
     Matrix4 TransformComponent::GetMatrix()
     {
-        return 
-            Matrix4().SetTranslation(position) *
-            Matrix4().SetRotation(rotation) *
-            Matrix4().SetScale(scale);
+        return Matrix4().SetTransform(position, rotation, scale);
     }
 }
 
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "math/Math.h"
+#include "../Entity.h"
 
 namespace Quartz
 {
@@ -10,6 +11,14 @@ namespace Quartz
 		Quaternion	rotation;
 		Vector3		scale;
 
+		/* Set with TransformSystem::SetParent, NullEntity for roots */
+		Entity		parent;
+		UInt32		depth;
+
+		/* Cached by TransformSystem for transforms changed through GetComponentMut */
+		Matrix4		localMatrix;
+		Matrix4		worldMatrix;
+
 		TransformComponent();
 		TransformComponent(const Vector3& position, const Quaternion& rotation, const Vector3& scale);
 
@@ -21,5 +30,7 @@ namespace Quartz
 		Vector3 GetDown();
 
 		Matrix4 GetMatrix();
+
+		FORCE_INLINE const Matrix4& GetWorldMatrix() const { return worldMatrix; }
 	};
 }
\ No newline at end of file
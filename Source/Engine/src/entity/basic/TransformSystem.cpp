@@ -0,0 +1,189 @@
+#include "TransformSystem.h"
+
+namespace Quartz
+{
+    TransformSystem::TransformSystem() :
+        mDirty(true)
+    {
+        // Nothing
+    }
+
+    Bool8 TransformSystem::IsValidParent(EntityWorld& world, Entity parent)
+    {
+        return world.IsAlive(parent) && world.HasComponent<TransformComponent>(parent);
+    }
+
+    Bool8 TransformSystem::NeedsRebuild(EntityWorld& world)
+    {
+        if (mDirty)
+        {
+            return true;
+        }
+
+        EntityView<TransformComponent> view = world.CreateView<TransformComponent>();
+
+        USize count = 0;
+        for (const EntitySpan& span : view.GetSpans())
+        {
+            count += span.count;
+        }
+
+        if (count != mOrder.Size())
+        {
+            return true;
+        }
+
+        // Same count, but transforms may have been both added and removed
+        view.Added<TransformComponent>(GetLastRunTick());
+        return view.begin() != view.end();
+    }
+
+    void TransformSystem::Rebuild(EntityWorld& world)
+    {
+        Array<Entity> entities;
+        Array<UInt32> depths;
+        Array<USize> levelCounts;
+        USize maxIndex = 0;
+
+        for (Entity entity : world.CreateView<TransformComponent>())
+        {
+            UInt32 depth = 0;
+
+            for (Entity parent = world.GetComponent<TransformComponent>(entity).parent;
+                IsValidParent(world, parent); parent = world.GetComponent<TransformComponent>(parent).parent)
+            {
+                depth++;
+            }
+
+            if (depth >= levelCounts.Size())
+            {
+                levelCounts.Resize(depth + 1, 0);
+            }
+
+            levelCounts[depth]++;
+            maxIndex = entity.index > maxIndex ? entity.index : maxIndex;
+
+            entities.PushBack(entity);
+            depths.PushBack(depth);
+        }
+
+        // Counting sort by depth
+        mLevels.Clear();
+        mLevels.PushBack(0);
+
+        for (USize count : levelCounts)
+        {
+            const USize levelEnd = mLevels[mLevels.Size() - 1] + count;
+            mLevels.PushBack(levelEnd);
+        }
+
+        Array<USize> cursors;
+        cursors.Resize(levelCounts.Size());
+
+        for (USize level = 0; level < levelCounts.Size(); level++)
+        {
+            cursors[level] = mLevels[level];
+        }
+
+        Array<UInt32> indices;
+        indices.Resize(maxIndex + 1, NO_PARENT);
+
+        mOrder.Resize(entities.Size());
+
+        for (USize i = 0; i < entities.Size(); i++)
+        {
+            const USize index = cursors[depths[i]]++;
+
+            mOrder[index] = entities[i];
+            indices[entities[i].index] = static_cast<UInt32>(index);
+
+            world.GetComponent<TransformComponent>(entities[i]).depth = depths[i];
+        }
+
+        mParents.Resize(mOrder.Size());
+
+        for (USize i = 0; i < mOrder.Size(); i++)
+        {
+            const Entity parent = world.GetComponent<TransformComponent>(mOrder[i]).parent;
+            mParents[i] = IsValidParent(world, parent) ? indices[parent.index] : NO_PARENT;
+        }
+
+        mWorld.Resize(mOrder.Size());
+        mUpdated.Resize(mOrder.Size(), 0);
+
+        mDirty = false;
+    }
+
+    void TransformSystem::UpdateTransform(EntityWorld& world, USize index, UInt32 since, Bool8 force)
+    {
+        const Entity entity = mOrder[index];
+        const UInt32 parent = mParents[index];
+
+        // Plain GetComponent, writing the cache must not mark the transform changed
+        TransformComponent& transform = world.GetComponent<TransformComponent>(entity);
+
+        const Bool8 localChanged = force || world.HasChanged<TransformComponent>(entity, since);
+
+        if (localChanged)
+        {
+            transform.localMatrix = transform.GetMatrix();
+        }
+
+        const Bool8 updated = localChanged || (parent != NO_PARENT && mUpdated[parent]);
+        mUpdated[index] = updated;
+
+        if (updated)
+        {
+            mWorld[index] = parent != NO_PARENT ? transform.localMatrix * mWorld[parent] : transform.localMatrix;
+            transform.worldMatrix = mWorld[index];
+        }
+    }
+
+    void TransformSystem::OnInit(EntityWorld& world)
+    {
+        world.TrackChanges<TransformComponent>();
+    }
+
+    void TransformSystem::OnUpdate(EntityWorld& world, Float32 deltaTime)
+    {
+        const Bool8 force = NeedsRebuild(world);
+
+        if (force)
+        {
+            Rebuild(world);
+        }
+
+        const UInt32 since = GetLastRunTick();
+
+        for (USize level = 0; level + 1 < mLevels.Size(); level++)
+        {
+            const USize levelStart = mLevels[level];
+            const USize levelSize = mLevels[level + 1] - levelStart;
+
+            GetJobSystem().ParallelFor(levelSize, [this, &world, levelStart, since, force](USize begin, USize end)
+            {
+                for (USize i = levelStart + begin; i < levelStart + end; i++)
+                {
+                    UpdateTransform(world, i, since, force);
+                }
+            },
+            64);
+        }
+    }
+
+    void TransformSystem::SetParent(EntityWorld& world, Entity child, Entity parent)
+    {
+        for (Entity ancestor = parent; IsValidParent(world, ancestor);
+            ancestor = world.GetComponent<TransformComponent>(ancestor).parent)
+        {
+            if (ancestor.handle == child.handle)
+            {
+                DEBUG_ASSERT(false && "Parenting would create a cycle!");
+                return;
+            }
+        }
+
+        world.GetComponentMut<TransformComponent>(child).parent = parent;
+        mDirty = true;
+    }
+}
@@ -0,0 +1,44 @@
+#pragma once
+
+#include "Transform.h"
+#include "../System.h"
+#include "util/Array.h"
+
+namespace Quartz
+{
+	/*
+		Keeps the cached local and world matrices of every TransformComponent
+		up to date. Transforms are kept in breadth order, one depth level
+		after another, so a level only reads world matrices of levels already
+		finished and is split across the job system. Only transforms changed
+		through GetComponentMut, and their descendants, are recomputed.
+	*/
+	class TransformSystem : public SingletonSystem
+	{
+	private:
+		constexpr static UInt32 NO_PARENT = UInt32(-1);
+
+		Array<Entity>	mOrder;		// Transforms sorted by depth
+		Array<UInt32>	mParents;	// Index of each parent in mOrder
+		Array<USize>	mLevels;	// Start of each depth level in mOrder, followed by the end
+		Array<Matrix4>	mWorld;		// World matrices, parallel to mOrder
+		Array<UInt8>	mUpdated;	// Set when a world matrix was recomputed this run
+		Bool8			mDirty;
+
+	private:
+		static Bool8 IsValidParent(EntityWorld& world, Entity parent);
+
+		Bool8 NeedsRebuild(EntityWorld& world);
+		void Rebuild(EntityWorld& world);
+		void UpdateTransform(EntityWorld& world, USize index, UInt32 since, Bool8 force);
+
+	public:
+		TransformSystem();
+
+		void OnInit(EntityWorld& world) override;
+		void OnUpdate(EntityWorld& world, Float32 deltaTime) override;
+
+		/* Parents child to parent, NullEntity makes child a root */
+		void SetParent(EntityWorld& world, Entity child, Entity parent);
+	};
+}
@@ -2,6 +2,7 @@
 
 #include "Common.h"
 #include "util\Array.h"
+#include "memory\LinearAllocator.h"
 
 namespace Quartz
 {
@@ -16,9 +17,16 @@ namespace Quartz
 	class EventBuffer : public EventBufferBase
 	{
 	private:
-		Array<EventType> mEvents;
+		Array<EventType, FrameAllocator> mEvents;
 
 	public:
+		/**
+			Events are stored in frame memory, they must be
+			cleared before the frame arena wraps around
+		*/
+		EventBuffer(const FrameAllocator& allocator)
+			: mEvents(allocator) { }
+
 		/** 
 			Store an event in the Queue
 			Returns an index to the stored event
@@ -36,6 +44,7 @@ namespace Quartz
 		void Clear() override
 		{
 			mEvents.Clear();
+			mEvents.Reserve(0);
 		}
 
 		EventType* GetEvent(UInt32 index) override
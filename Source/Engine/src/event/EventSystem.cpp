@@ -3,7 +3,7 @@
 namespace Quartz
 {
 	EventSystem::EventSystem()
-		: Module({ L"Event System" })
+		: Module({ L"Event System" }), mEventQueue(GetFrameAllocator())
 	{
 		// Nothing
 	}
@@ -33,6 +33,7 @@ namespace Quartz
 			}
 
 			mEventQueue.Clear();
+			mEventQueue.Reserve(0);
 
 			// Clear Event Buffers:
 
@@ -36,7 +36,7 @@ namespace Quartz
 		Map<EventTypeId, EventDispatcherBase*>	mDispatchers;
 		Map<EventTypeId, EventBufferBase*>		mEventBuffers;
 		Array<EventBufferBase*>					mEventBufferList;
-		Array<EventBucket>						mEventQueue;
+		Array<EventBucket, FrameAllocator>		mEventQueue;
 
 	public:
 		EventSystem();
@@ -69,7 +69,7 @@ namespace Quartz
 
 				if (ppEventBufferBase == nullptr)
 				{
-					pEventBufferBase = new EventBuffer<EventType>(); //TODO: delete pEventBufferBase!!
+					pEventBufferBase = new EventBuffer<EventType>(GetFrameAllocator()); //TODO: delete pEventBufferBase!!
 					mEventBuffers.Put(typeId, pEventBufferBase);
 					mEventBufferList.PushBack(pEventBufferBase);
 				}
@@ -7,6 +7,7 @@
 #include "Uniform.h"
 
 #include "util/Array.h"
+#include "util/InlineArray.h"
 
 namespace Quartz
 {
@@ -33,7 +34,7 @@ namespace Quartz
 
 		virtual void SetPipeline(Pipeline* pPipeline) = 0;
 
-		virtual void SetVertexBuffers(const Array<Buffer*>& buffers) = 0;
+		virtual void SetVertexBuffers(const InlineArray<Buffer*, 4>& buffers) = 0;
 		virtual void SetIndexBuffer(Buffer* pBuffer) = 0;
 
 		virtual void BindUniform(UInt32 set, UInt32 binding, Uniform* pUniform, UInt32 element) = 0;
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "util/Array.h"
+#include "util/InlineArray.h"
 
 #include "Shader.h"
 #include "RenderPass.h"
@@ -122,7 +123,7 @@ namespace Quartz
 
 	struct GraphicsPipelineInfo
 	{
-		Array<Shader*>			shaders;
+		InlineArray<Shader*, 4>	shaders;
 		Array<BufferAttachent>	bufferAttachments;
 		Array<VertexAttribute>	vertexAttributes;
 		//Array<GFXDescriptorAttachment> descriptorAttachents;
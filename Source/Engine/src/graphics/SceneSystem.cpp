@@ -1,11 +1,17 @@
 #include "SceneSystem.h"
 
+#include "../entity/basic/TransformSystem.h"
+#include "component/Camera.h"
+
 namespace Quartz
 {
 	Scene::Scene(const String& name)
 		: mName(name)
 	{
-		// Nothing
+		mWorld.RegisterSystem<TransformSystem>();
+
+		mWorld.RegisterSnapshotType<TransformComponent>();
+		mWorld.RegisterSnapshotType<CameraComponent>();
 	}
 
 	void Scene::SetCamera(Entity entity)
@@ -181,7 +181,14 @@ namespace Quartz
 		Graphics* pGraphics = Engine::GetInstance()->GetGraphics();
 		EntityWorld& world = pScene->GetWorld();
 
-		EntityView renderables = world.CreateView<TransformComponent, MeshComponent, MaterialComponent>();
+		// Renderables are packed at the front of each storage, indexed in step
+		EntityGroup<TransformComponent, MeshComponent, MaterialComponent>& group =
+			world.Group<TransformComponent, MeshComponent, MaterialComponent>();
+
+		const USize renderableCount = group.Size();
+		TransformComponent* pTransforms = group.GetComponents<TransformComponent>();
+		MeshComponent* pMeshes = group.GetComponents<MeshComponent>();
+		MaterialComponent* pMaterials = group.GetComponents<MaterialComponent>();
 
 		TransformComponent& cameraTransform = pScene->GetWorld().GetComponent<TransformComponent>(pScene->GetCamera());
 		CameraComponent&	cameraCamera	= pScene->GetWorld().GetComponent<CameraComponent>(pScene->GetCamera());
@@ -194,12 +201,10 @@ namespace Quartz
 
 			mpPerFrame->SetElement(pViewport, 0, &perFrameUbo);
 
-			UInt32 i = 0;
-			for (Entity entity : renderables)
+			for (UInt32 i = 0; i < renderableCount; i++)
 			{
-				TransformComponent& transform = pScene->GetWorld().GetComponent<TransformComponent>(entity);
-				perObjectUbo.model = transform.GetMatrix();
-				mpPerObject->SetElement(pViewport, i++, &perObjectUbo);
+				perObjectUbo.model = pTransforms[i].GetWorldMatrix();
+				mpPerObject->SetElement(pViewport, i, &perObjectUbo);
 			}
 		}
 
@@ -210,11 +215,10 @@ namespace Quartz
 			mpCommandBuffer->SetPipeline(mpGraphicsPipeline);
 			mpCommandBuffer->BindUniform(0, 0, mpPerFrame, 0);
 
-			UInt32 i = 0;
-			for (Entity entity : renderables)
+			for (UInt32 i = 0; i < renderableCount; i++)
 			{
-				MeshComponent& mesh = pScene->GetWorld().GetComponent<MeshComponent>(entity);
-				MaterialComponent& material = pScene->GetWorld().GetComponent<MaterialComponent>(entity);
+				MeshComponent& mesh = pMeshes[i];
+				MaterialComponent& material = pMaterials[i];
 
 				mpDiffuse->Set(material.pDiffuse);
 				mpNormal->Set(material.pNormal);
@@ -230,7 +234,7 @@ namespace Quartz
 
 				mpCommandBuffer->SetVertexBuffers({ mesh.pVertexBuffer });
 				mpCommandBuffer->SetIndexBuffer(mesh.pIndexBuffer);
-				mpCommandBuffer->BindUniform(1, 0, mpPerObject, i++);
+				mpCommandBuffer->BindUniform(1, 0, mpPerObject, i);
 				mpCommandBuffer->DrawIndexed(mesh.pIndexBuffer->GetSize() / sizeof(UInt32), 0);
 			}
 
@@ -4,7 +4,7 @@
 #include "Peripherals.h"
 #include "InputAction.h"
 #include "math/Math.h"
-#include "util/String.h"
+#include "util/Name.h"
 
 namespace Quartz
 {
@@ -31,7 +31,7 @@ namespace Quartz
 
 	struct InputActionEvent : public Event<InputActionEvent>
 	{
-		String	name;
+		Name	name;
 		Vector3 axis;
 		Float32 value;
 	};
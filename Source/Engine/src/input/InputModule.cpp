@@ -65,7 +65,7 @@ namespace Quartz
 		}
 	}
 
-	void InputSystem::BindKeyboardInputAction(const String& name, Keyboard* pKeyboard, UInt32 key, 
+	void InputSystem::BindKeyboardInputAction(Name name, Keyboard* pKeyboard, UInt32 key, 
 		InputActions actions, const Vector3& axis, Float32 value)
 	{
 		InputKey inputKey;
@@ -82,7 +82,7 @@ namespace Quartz
 		mBindings[inputKey].PushBack(inputBinding);
 	}
 
-	void InputSystem::BindMouseButtonInputAction(const String& name, Mouse* pMouse, UInt32 button, 
+	void InputSystem::BindMouseButtonInputAction(Name name, Mouse* pMouse, UInt32 button, 
 		InputActions actions, const Vector3& axis, Float32 value)
 	{
 		InputKey inputKey;
@@ -99,7 +99,7 @@ namespace Quartz
 		mBindings[inputKey].PushBack(inputBinding);
 	}
 
-	void InputSystem::BindMouseMoveInputAction(const String& name, Mouse* pMouse)
+	void InputSystem::BindMouseMoveInputAction(Name name, Mouse* pMouse)
 	{
 		InputKey inputKey;
 		inputKey.pPeripheral	= pMouse;
@@ -115,7 +115,7 @@ namespace Quartz
 		mBindings[inputKey].PushBack(inputBinding);
 	}
 
-	void InputSystem::BindMouseScrollInputAction(const String& name, Mouse* pMouse, MouseWheelActions actions, Float32 value)
+	void InputSystem::BindMouseScrollInputAction(Name name, Mouse* pMouse, MouseWheelActions actions, Float32 value)
 	{
 		InputKey inputKey;
 		inputKey.pPeripheral	= pMouse;
@@ -276,7 +276,7 @@ namespace Quartz
 
 	}
 
-	void InputSystem::TriggerInputAction(const String& name, const Vector3& axis, Float32 value)
+	void InputSystem::TriggerInputAction(Name name, const Vector3& axis, Float32 value)
 	{
 		InputActionEvent event;
 		event.name		= name;
@@ -286,7 +286,7 @@ namespace Quartz
 		Engine::GetInstance()->GetEventSystem()->Publish<InputActionEvent>(event);
 	}
 
-	Bool8 InputSystem::IsInputActionDown(const String& name)
+	Bool8 InputSystem::IsInputActionDown(Name name)
 	{
 		const ActionState* pState = mActionStates.Get(name);
 
@@ -301,7 +301,7 @@ namespace Quartz
 		return false;
 	}
 
-	Bool8 InputSystem::IsInputActionUp(const String& name)
+	Bool8 InputSystem::IsInputActionUp(Name name)
 	{
 		const ActionState* pState = mActionStates.Get(name);
 
@@ -316,7 +316,7 @@ namespace Quartz
 		return false;
 	}
 
-	Bool8 InputSystem::IsInputActionPressed(const String& name)
+	Bool8 InputSystem::IsInputActionPressed(Name name)
 	{
 		const ActionState* pState = mActionStates.Get(name);
 
@@ -331,7 +331,7 @@ namespace Quartz
 		return false;
 	}
 
-	Bool8 InputSystem::IsInputActionReleased(const String& name)
+	Bool8 InputSystem::IsInputActionReleased(Name name)
 	{
 		const ActionState* pState = mActionStates.Get(name);
 
@@ -346,7 +346,7 @@ namespace Quartz
 		return false;
 	}
 
-	Bool8 InputSystem::IsInputActionAxisActive(const String& name)
+	Bool8 InputSystem::IsInputActionAxisActive(Name name)
 	{
 		const ActionState* pState = mActionStates.Get(name);
 
@@ -361,7 +361,7 @@ namespace Quartz
 		return false;
 	}
 
-	Vector3 InputSystem::GetInputActionAxis(const String& name)
+	Vector3 InputSystem::GetInputActionAxis(Name name)
 	{
 		const ActionState* pState = mActionStates.Get(name);
 
@@ -373,7 +373,7 @@ namespace Quartz
 		return { 0.0f, 0.0f, 0.0f };
 	}
 
-	Float32 InputSystem::GetInputActionValue(const String& name)
+	Float32 InputSystem::GetInputActionValue(Name name)
 	{
 		const ActionState* pState = mActionStates.Get(name);
 
@@ -385,7 +385,7 @@ namespace Quartz
 		return 0.0f;
 	}
 
-	ActionState InputSystem::GetInputAction(const String& name)
+	ActionState InputSystem::GetInputAction(Name name)
 	{
 		const ActionState* pState = mActionStates.Get(name);
 
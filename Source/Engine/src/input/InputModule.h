@@ -6,6 +6,7 @@
 
 #include "util/Array.h"
 #include "util/Map.h"
+#include "util/Name.h"
 
 namespace Quartz
 {
@@ -56,7 +57,7 @@ namespace Quartz
 
 		struct InputBinding
 		{
-			String	name;
+			Name	name;
 			Vector3 axis;
 			Float32 value;
 		};
@@ -72,19 +73,19 @@ namespace Quartz
 	private:
 		Map<InputKey, Array<InputBinding>>		mBindings;
 		Map<PeripheralHandle, PeripheralState>	mStates;
-		Map<String, ActionState>				mActionStates;
+		Map<Name, ActionState>					mActionStates;
 
 	public:
 		InputSystem();
 
 		void PreUpdate(Float32 delta) override;
 
-		void BindKeyboardInputAction(const String& name, Keyboard* pKeyboard, UInt32 key, 
+		void BindKeyboardInputAction(Name name, Keyboard* pKeyboard, UInt32 key, 
 			InputActions actions, const Vector3& axis, Float32 value);
-		void BindMouseButtonInputAction(const String& name, Mouse* pMouse, UInt32 button, 
+		void BindMouseButtonInputAction(Name name, Mouse* pMouse, UInt32 button, 
 			InputActions actions, const Vector3& axis, Float32 value);
-		void BindMouseMoveInputAction(const String& name, Mouse* pMouse);
-		void BindMouseScrollInputAction(const String& name, Mouse* pMouse, 
+		void BindMouseMoveInputAction(Name name, Mouse* pMouse);
+		void BindMouseScrollInputAction(Name name, Mouse* pMouse, 
 			MouseWheelActions actions, Float32 value);
 
 		void TriggerKeyboardInputAction(Keyboard* pKeyboard, UInt32 key, InputActions actions);
@@ -92,17 +93,17 @@ namespace Quartz
 		void TriggerMouseMoveInputAction(Mouse* pMouse, const Vector2& relative);
 		void TriggerMouseScrollInputAction(Mouse* pMouse, Float32 value, MouseWheelActions actions);
 
-		void TriggerInputAction(const String& name, const Vector3& axis, Float32 value);
+		void TriggerInputAction(Name name, const Vector3& axis, Float32 value);
 
-		Bool8 IsInputActionDown(const String& name);
-		Bool8 IsInputActionUp(const String& name);
-		Bool8 IsInputActionPressed(const String& name);
-		Bool8 IsInputActionReleased(const String& name);
+		Bool8 IsInputActionDown(Name name);
+		Bool8 IsInputActionUp(Name name);
+		Bool8 IsInputActionPressed(Name name);
+		Bool8 IsInputActionReleased(Name name);
 
-		Bool8 IsInputActionAxisActive(const String& name);
-		Vector3 GetInputActionAxis(const String& name);
-		Float32 GetInputActionValue(const String& name);
+		Bool8 IsInputActionAxisActive(Name name);
+		Vector3 GetInputActionAxis(Name name);
+		Float32 GetInputActionValue(Name name);
 
-		ActionState GetInputAction(const String& name);
+		ActionState GetInputAction(Name name);
 	};
 }
\ No newline at end of file
@@ -68,7 +68,7 @@ namespace Quartz
 				continue;
 			}
 
-			SubString token = parser.ReadToChar(' ');
+			StringView token = parser.ReadToChar(' ');
 
 			// Comment
 			if (token == "#")
@@ -93,7 +93,7 @@ namespace Quartz
 				Float32 y = parser.ReadFloat();
 				Float32 z = parser.ReadFloat();
 
-				objModel.positions.PushBack({ x, y, z });
+				objModel.positions.EmplaceBack(x, y, z);
 
 				parser.ReadLine();
 			}
@@ -107,7 +107,7 @@ namespace Quartz
 				Float32 y = parser.ReadFloat();
 				Float32 z = parser.ReadFloat();
 
-				objModel.normals.PushBack({ x, y, z });
+				objModel.normals.EmplaceBack(x, y, z);
 
 				parser.ReadLine();
 			}
@@ -120,7 +120,7 @@ namespace Quartz
 				Float32 x = parser.ReadFloat();
 				Float32 y = parser.ReadFloat();
 
-				objModel.texCoords.PushBack({ x, y });
+				objModel.texCoords.EmplaceBack(x, y);
 
 				parser.ReadLine();
 			}
@@ -132,21 +132,12 @@ namespace Quartz
 
 				StringParser faceLine(parser.ReadLine());
 
-				OBJIndex index{};
-				UInt32 indexCount = 0;
-
-				Array<OBJIndex>& indices = objModel.indices;
+				// Faces are rarely more than quads
+				InlineArray<OBJIndex, 8> faceIndices;
 
 				while (!faceLine.IsEnd())
 				{
-					if (indexCount > 2)
-					{
-						OBJIndex index0 = indices[indices.Size() - 3];
-						OBJIndex index1 = indices[indices.Size() - 1];
-						indices.PushBack(Move(index0));
-						indices.PushBack(Move(index1));
-						indexCount += 2;
-					}
+					OBJIndex index{};
 
 					faceLine.AdvanceWhitespace();
 
@@ -172,12 +163,21 @@ namespace Quartz
 							faceLine.AdvanceChar();
 							index.normalIdx = faceLine.ReadInt();
 						}
+					}
 
-						indices.PushBack(index);
-						++indexCount;
+					faceIndices.PushBack(index);
 
-						faceLine.AdvanceWhitespace();
-					}
+					faceLine.AdvanceWhitespace();
+				}
+
+				// Fan triangulation
+				Array<OBJIndex>& indices = objModel.indices;
+
+				for (UInt32 i = 1; i + 1 < faceIndices.Size(); i++)
+				{
+					indices.PushBack(faceIndices[0]);
+					indices.PushBack(faceIndices[i]);
+					indices.PushBack(faceIndices[i + 1]);
 				}
 			}
 
@@ -214,6 +214,11 @@ namespace Quartz
 		IndexData indexData{};
 		indexData.format = INDEX_FORMAT_INT32;
 
+		// Every unique position needs at least one vertex
+		constexpr USize vertexSize = 4 * sizeof(Vector3) + sizeof(Vector2);
+		vertexData.buffer.Reserve(objModel.positions.Size() * vertexSize);
+		indexData.buffer.Reserve(objModel.indices.Size() * sizeof(UInt32));
+
 		UInt32 currentIndex = 0;
 		Map<OBJIndex, UInt32> indexMap{};
 		indexMap.Reserve(objModel.indices.Size());
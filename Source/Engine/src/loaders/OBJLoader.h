@@ -4,6 +4,7 @@
 #include "util\String.h"
 #include "util\StringParser.h"
 #include "util\Array.h"
+#include "util\InlineArray.h"
 #include "util\Map.h"
 #include "math\Math.h"
 
@@ -1,5 +1,7 @@
 #include "JSON.h"
 
+#include "util/StringParser.h"
+
 namespace Quartz
 {
 	JSONValue::JSONValue()
@@ -112,36 +114,6 @@ namespace Quartz
 		return false;
 	}
 
-	Double64 ParseInt(const Char** pStr)
-	{
-		Double64 value = 0;
-
-		while (**pStr != 0 && **pStr >= '0' && **pStr <= '9')
-		{
-			UInt8 digit = **pStr - '0';
-			value = value * 10 + digit;
-			(*pStr)++;
-		}
-
-		return value;
-	}
-
-	Double64 ParseDecimal(const Char** pStr)
-	{
-		Double64 value = 0.0;
-		Double64 factor = 0.1;
-
-		while (**pStr != 0 && **pStr >= '0' && **pStr <= '9')
-		{
-			UInt8 digit = **pStr - '0';
-			value = value + (digit * factor);
-			factor *= 0.1;
-			(*pStr)++;
-		}
-
-		return value;
-	}
-
 	Bool8 SkipWhitespace(const Char** pStr)
 	{
 		while (**pStr != 0 && (**pStr == ' ' || **pStr == '\t' || **pStr == '\r' || **pStr == '\n'))
@@ -190,62 +162,19 @@ namespace Quartz
 		// Number
 		if (**pStr == '-' || (**pStr >= '0' && **pStr <= '9'))
 		{
-			Double64 number;
-
-			// Negative
-			Bool8 negative = **pStr == '-';
-			if (negative) (*pStr)++;
+			// Bound the token so ParseDouble does not need the string length
+			const Char* pNumberEnd = *pStr + 1;
+			while (IsDigit(*pNumberEnd) || *pNumberEnd == '.' || *pNumberEnd == 'e' ||
+				*pNumberEnd == 'E' || *pNumberEnd == '-' || *pNumberEnd == '+')
+				pNumberEnd++;
 
-			// Zero
-			if (**pStr == '0')
-				pStr++;
+			const Char* pRead = nullptr;
+			Double64 number = ParseDouble(*pStr, pNumberEnd, &pRead);
 
-			else if (**pStr >= '0' && **pStr <= '9')
-				number = ParseInt(pStr);
-
-			else 
+			if (pRead != pNumberEnd)
 				return NULL;
 
-			// Decimal
-			if (**pStr == '.')
-			{
-				(*pStr)++;
-
-				if (!(**pStr >= '0' && **pStr <= '9'))
-					return NULL;
-
-				number += ParseDecimal(pStr);
-			}
-
-			// Exponent
-			if (**pStr == 'E' || **pStr == 'e')
-			{
-				(*pStr)++;
-
-				// Negative exponent
-				Bool8 negativeExp = **pStr == '-';
-				if (negativeExp) (*pStr)++;
-
-				// Posative exponent
-				if (**pStr == '+') (*pStr)++;
-
-				Double64 exponent = ParseInt(pStr);
-
-				if (negativeExp)
-				{
-					for (Double64 i = 0.0; i < exponent; i++)
-						number /= 10.0;
-				}
-
-				else
-				{
-					for (Double64 i = 0.0; i < exponent; i++)
-						number *= 10.0;
-				}
-			}
-
-			if (negative)
-				number *= -1;
+			*pStr = pNumberEnd;
 
 			return new JSONValue(number);
 		}
@@ -3,6 +3,7 @@
 #include "../util/Array.h"
 #include "../util/Map.h"
 #include "../util/String.h"
+#include "../util/Name.h"
 
 namespace Quartz
 {
@@ -19,7 +20,7 @@ namespace Quartz
 	struct JSONValue;
 
 	typedef Array<JSONValue> JSONArray;
-	typedef Map<String, JSONValue> JSONObject;
+	typedef Map<Name, JSONValue> JSONObject;
 
 	struct JSONValue
 	{
@@ -55,8 +56,7 @@ namespace Quartz
 		operator JSONArray&() const { return *mpArray; }
 		operator JSONObject&() const { return *mpObject; }
 
-		JSONValue& operator[](const Char* name) { return *mpObject->Get(name); }
-		JSONValue& operator[](const String& name) { return *mpObject->Get(name); }
+		JSONValue& operator[](Name name) { return *mpObject->Get(name); }
 
 		FORCE_INLINE Int64 AsInt() const { return (Int64)mNumber; }
 		FORCE_INLINE Double64 AsNumber() const { return mNumber; }
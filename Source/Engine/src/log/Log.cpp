@@ -2,9 +2,11 @@
 
 #include <cstdio>
 #include <cstdarg>
+#include <cstring>
+#include <cwchar>
 #include <time.h>
 
-#include "util/String.h"
+#include "util/Array.h"
 #include "../platform/DebugConsole.h"
 
 #define USE_MESSAGE_LOOP 0
@@ -13,32 +15,81 @@ namespace Quartz
 {
 	DebugConsole* DebugLogger::pDebugConsole = nullptr;
 
-	String FormatMessage(const char* format, va_list args)
-	{
-		va_list largs;
-		va_copy(largs, args);
+	/*
+		Log lines are formatted into a per-thread scratch buffer that only
+		grows. Lines are printed immediately, so the next line logged on
+		the same thread can reuse it. Logging may happen from job workers
+		while the frame arena resets, so frame memory is not used here.
+	*/
 
-		Int32 length = vsnprintf(NULL, 0, format, largs);
-
-		String message;
-		message.Resize(length);
+	template<typename CharType>
+	static CharType* AllocateLine(USize length)
+	{
+		thread_local Array<CharType> buffer;
 
-		vsnprintf(message.Data(), length + 1, format, args);
+		if (buffer.Size() < length + 1)
+		{
+			buffer.ResizeNoInit(length + 1);
+		}
 
-		return message;
+		return buffer.Data();
 	}
 
-	String FormatTime()
+	static void FormatTime(char* pBuffer, USize size)
 	{
-		char currentTime[26] = {};
-
 		time_t timer;
 		tm timeInfo;
 		time(&timer);
 		localtime_s(&timeInfo, &timer);
-		strftime(currentTime, 26, "%H:%M:%S", &timeInfo);
+		strftime(pBuffer, size, "[%H:%M:%S]", &timeInfo);
+	}
+
+	/* Formats "[time]<tag><message>\n", or just the message if tag is null */
+	static const wchar_t* FormatLine(const char* tag, const char* format, va_list args)
+	{
+		char timeStamp[16] = {};
+		USize timeLength = 0;
+		USize prefixLength = 0;
+
+		if (tag != nullptr)
+		{
+			FormatTime(timeStamp, sizeof(timeStamp));
+			timeLength = strlen(timeStamp);
+			prefixLength = timeLength + strlen(tag);
+		}
+
+		va_list largs;
+		va_copy(largs, args);
+		const Int32 length = vsnprintf(NULL, 0, format, largs);
+		va_end(largs);
+
+		const USize lineLength = prefixLength + length + (tag != nullptr ? 1 : 0);
+		char* pLine = AllocateLine<char>(lineLength);
+
+		if (tag != nullptr)
+		{
+			memcpy(pLine, timeStamp, timeLength);
+			memcpy(pLine + timeLength, tag, prefixLength - timeLength);
+		}
+
+		vsnprintf(pLine + prefixLength, length + 1, format, args);
+
+		if (tag != nullptr)
+		{
+			// Replaces the terminator written by vsnprintf
+			pLine[lineLength - 1] = '\n';
+		}
+
+		pLine[lineLength] = '\0';
+
+		wchar_t* pWideLine = AllocateLine<wchar_t>(lineLength);
 
-		return "[" + String(currentTime) + "]";
+		for (USize i = 0; i <= lineLength; i++)
+		{
+			pWideLine[i] = (wchar_t)pLine[i];
+		}
+
+		return pWideLine;
 	}
 
 	void DebugLogger::SetDebugConsole(DebugConsole* console)
@@ -50,221 +101,245 @@ namespace Quartz
 	{
 		va_list args;
 		va_start(args, format);
-		StringW message = StringAToStringW(FormatMessage(format, args));
+		const wchar_t* pMessage = FormatLine(nullptr, format, args);
 		va_end(args);
 
 		pDebugConsole->SetColor(TEXT_COLOR_LIGHT_GRAY, TEXT_COLOR_DEFAULT);
-		pDebugConsole->Print(message.Str());
+		pDebugConsole->Print(pMessage);
 
-		//wprintf_s(message.Str());
+		//wprintf_s(pMessage);
 	}
 
 	void DebugLogger::Debug(const char* format, ...)
 	{
 		va_list args;
 		va_start(args, format);
-		StringW message = StringAToStringW(FormatTime() + "[DEBUG] " + FormatMessage(format, args) + "\n");
+		const wchar_t* pMessage = FormatLine("[DEBUG] ", format, args);
 		va_end(args);
 
 		pDebugConsole->SetColor(TEXT_COLOR_LIGHT_GRAY, TEXT_COLOR_DEFAULT);
-		pDebugConsole->Print(message.Str());
+		pDebugConsole->Print(pMessage);
 		pDebugConsole->SetColor(TEXT_COLOR_LIGHT_GRAY, TEXT_COLOR_DEFAULT);
 
-		//wprintf_s(message.Str());
+		//wprintf_s(pMessage);
 	}
 
 	void DebugLogger::Info(const char* format, ...)
 	{
 		va_list args;
 		va_start(args, format);
-		StringW message = StringAToStringW(FormatTime() + "[INFO] " + FormatMessage(format, args) + "\n");
+		const wchar_t* pMessage = FormatLine("[INFO] ", format, args);
 		va_end(args);
 
 		pDebugConsole->SetColor(TEXT_COLOR_LIGHT_BLUE, TEXT_COLOR_DEFAULT);
-		pDebugConsole->Print(message.Str());
+		pDebugConsole->Print(pMessage);
 		pDebugConsole->SetColor(TEXT_COLOR_LIGHT_GRAY, TEXT_COLOR_DEFAULT);
 
-		//wprintf_s(message.Str());
+		//wprintf_s(pMessage);
 	}
 
 	void DebugLogger::General(const char* format, ...)
 	{
 		va_list args;
 		va_start(args, format);
-		StringW message = StringAToStringW(FormatTime() + "[GENERAL] " + FormatMessage(format, args) + "\n");
+		const wchar_t* pMessage = FormatLine("[GENERAL] ", format, args);
 		va_end(args);
 
 		pDebugConsole->SetColor(TEXT_COLOR_WHITE, TEXT_COLOR_DEFAULT);
-		pDebugConsole->Print(message.Str());
+		pDebugConsole->Print(pMessage);
 		pDebugConsole->SetColor(TEXT_COLOR_LIGHT_GRAY, TEXT_COLOR_DEFAULT);
 
-		//wprintf_s(message.Str());
+		//wprintf_s(pMessage);
 	}
 
 	void DebugLogger::Warning(const char* format, ...)
 	{
 		va_list args;
 		va_start(args, format);
-		StringW message = StringAToStringW(FormatTime() + "[WARNING] " + FormatMessage(format, args) + "\n");
+		const wchar_t* pMessage = FormatLine("[WARNING] ", format, args);
 		va_end(args);
 
 		pDebugConsole->SetColor(TEXT_COLOR_YELLOW, TEXT_COLOR_DEFAULT);
-		pDebugConsole->Print(message.Str());
+		pDebugConsole->Print(pMessage);
 		pDebugConsole->SetColor(TEXT_COLOR_LIGHT_GRAY, TEXT_COLOR_DEFAULT);
 
-		//wprintf_s(message.Str());
+		//wprintf_s(pMessage);
 	}
 
 	void DebugLogger::Error(const char* format, ...)
 	{
 		va_list args;
 		va_start(args, format);
-		StringW message = StringAToStringW(FormatTime() + "[ERROR] " + FormatMessage(format, args) + "\n");
+		const wchar_t* pMessage = FormatLine("[ERROR] ", format, args);
 		va_end(args);
 
 		pDebugConsole->SetColor(TEXT_COLOR_RED, TEXT_COLOR_DEFAULT);
-		pDebugConsole->Print(message.Str());
+		pDebugConsole->Print(pMessage);
 		pDebugConsole->SetColor(TEXT_COLOR_LIGHT_GRAY, TEXT_COLOR_DEFAULT);
 
-		//wprintf_s(message.Str());
+		//wprintf_s(pMessage);
 	}
 
 	void DebugLogger::Critical(const char* format, ...)
 	{
 		va_list args;
 		va_start(args, format);
-		StringW message = StringAToStringW(FormatTime() + "[CRITICAL] " + FormatMessage(format, args) + "\n");
+		const wchar_t* pMessage = FormatLine("[CRITICAL] ", format, args);
 		va_end(args);
 
 		pDebugConsole->SetColor(TEXT_COLOR_WHITE, TEXT_COLOR_RED);
-		pDebugConsole->Print(message.Str());
+		pDebugConsole->Print(pMessage);
 		pDebugConsole->SetColor(TEXT_COLOR_LIGHT_GRAY, TEXT_COLOR_DEFAULT);
 
-		//wprintf_s(message.Str());
+		//wprintf_s(pMessage);
 	}
 
 	/* WIDE */
 
-	StringW FormatMessageW(const wchar_t* format, va_list args)
+	static void FormatTimeW(wchar_t* pBuffer, USize size)
 	{
-		Int32 length = vswprintf(NULL, 0, format, args);
+		time_t timer;
+		tm timeInfo;
+		time(&timer);
+		localtime_s(&timeInfo, &timer);
+		wcsftime(pBuffer, size, L"[%H:%M:%S]", &timeInfo);
+	}
 
-		StringW message;
-		message.Resize(length);
+	static const wchar_t* FormatLineW(const wchar_t* tag, const wchar_t* format, va_list args)
+	{
+		wchar_t timeStamp[16] = {};
+		USize timeLength = 0;
+		USize prefixLength = 0;
 
-		vswprintf(message.Data(), length + 1, format, args);
+		if (tag != nullptr)
+		{
+			FormatTimeW(timeStamp, 16);
+			timeLength = wcslen(timeStamp);
+			prefixLength = timeLength + wcslen(tag);
+		}
 
-		return message;
-	}
+		va_list largs;
+		va_copy(largs, args);
+		const Int32 length = vswprintf(NULL, 0, format, largs);
+		va_end(largs);
 
-	StringW FormatTimeW()
-	{
-		wchar_t currentTime[26] = {};
+		const USize lineLength = prefixLength + length + (tag != nullptr ? 1 : 0);
+		wchar_t* pLine = AllocateLine<wchar_t>(lineLength);
 
-		time_t timer;
-		tm timeInfo;
-		time(&timer);
-		localtime_s(&timeInfo, &timer);
-		wcsftime(currentTime, 26, L"%H:%M:%S", &timeInfo);
+		if (tag != nullptr)
+		{
+			wmemcpy(pLine, timeStamp, timeLength);
+			wmemcpy(pLine + timeLength, tag, prefixLength - timeLength);
+		}
+
+		vswprintf(pLine + prefixLength, length + 1, format, args);
+
+		if (tag != nullptr)
+		{
+			// Replaces the terminator written by vswprintf
+			pLine[lineLength - 1] = L'\n';
+		}
+
+		pLine[lineLength] = L'\0';
 
-		return L"[" + StringW(currentTime) + L"]";
+		return pLine;
 	}
 
 	void DebugLogger::Print(const wchar_t* format, ...)
 	{
 		va_list args;
 		va_start(args, format);
-		StringW message = FormatMessageW(format, args);
+		const wchar_t* pMessage = FormatLineW(nullptr, format, args);
 		va_end(args);
 
 		pDebugConsole->SetColor(TEXT_COLOR_DEFAULT, TEXT_COLOR_DEFAULT);
-		pDebugConsole->Print(message.Str());
+		pDebugConsole->Print(pMessage);
 
-		//wprintf_s(message.Str());
+		//wprintf_s(pMessage);
 	}
 
 	void DebugLogger::Debug(const wchar_t* format, ...)
 	{
 		va_list args;
 		va_start(args, format);
-		StringW message = FormatTimeW() + L"[DEBUG] " + FormatMessageW(format, args) + L"\n";
+		const wchar_t* pMessage = FormatLineW(L"[DEBUG] ", format, args);
 		va_end(args);
 
 		pDebugConsole->SetColor(TEXT_COLOR_LIGHT_GRAY, TEXT_COLOR_DEFAULT);
-		pDebugConsole->Print(message.Str());
+		pDebugConsole->Print(pMessage);
 		pDebugConsole->SetColor(TEXT_COLOR_LIGHT_GRAY, TEXT_COLOR_DEFAULT);
 
-		//wprintf_s(message.Str());
+		//wprintf_s(pMessage);
 	}
 
 	void DebugLogger::Info(const wchar_t* format, ...)
 	{
 		va_list args;
 		va_start(args, format);
-		StringW message = FormatTimeW() + L"[INFO] " + FormatMessageW(format, args) + L"\n";
+		const wchar_t* pMessage = FormatLineW(L"[INFO] ", format, args);
 		va_end(args);
 
 		pDebugConsole->SetColor(TEXT_COLOR_LIGHT_BLUE, TEXT_COLOR_DEFAULT);
-		pDebugConsole->Print(message.Str());
+		pDebugConsole->Print(pMessage);
 		pDebugConsole->SetColor(TEXT_COLOR_LIGHT_GRAY, TEXT_COLOR_DEFAULT);
 
-		//wprintf_s(message.Str());
+		//wprintf_s(pMessage);
 	}
 
 	void DebugLogger::General(const wchar_t* format, ...)
 	{
 		va_list args;
 		va_start(args, format);
-		StringW message = FormatTimeW() + L"[GENERAL] " + FormatMessageW(format, args) + L"\n";
+		const wchar_t* pMessage = FormatLineW(L"[GENERAL] ", format, args);
 		va_end(args);
 
 		pDebugConsole->SetColor(TEXT_COLOR_WHITE, TEXT_COLOR_DEFAULT);
-		pDebugConsole->Print(message.Str());
+		pDebugConsole->Print(pMessage);
 		pDebugConsole->SetColor(TEXT_COLOR_LIGHT_GRAY, TEXT_COLOR_DEFAULT);
 
-		//wprintf_s(message.Str());
+		//wprintf_s(pMessage);
 	}
 
 	void DebugLogger::Warning(const wchar_t* format, ...)
 	{
 		va_list args;
 		va_start(args, format);
-		StringW message = FormatTimeW() + L"[WARNING] " + FormatMessageW(format, args) + L"\n";
+		const wchar_t* pMessage = FormatLineW(L"[WARNING] ", format, args);
 		va_end(args);
 
 		pDebugConsole->SetColor(TEXT_COLOR_YELLOW, TEXT_COLOR_DEFAULT);
-		pDebugConsole->Print(message.Str());
+		pDebugConsole->Print(pMessage);
 		pDebugConsole->SetColor(TEXT_COLOR_LIGHT_GRAY, TEXT_COLOR_DEFAULT);
 
-		//wprintf_s(message.Str());
+		//wprintf_s(pMessage);
 	}
 
 	void DebugLogger::Error(const wchar_t* format, ...)
 	{
 		va_list args;
 		va_start(args, format);
-		StringW message = FormatTimeW() + L"[ERROR] " + FormatMessageW(format, args) + L"\n";
+		const wchar_t* pMessage = FormatLineW(L"[ERROR] ", format, args);
 		va_end(args);
 
 		pDebugConsole->SetColor(TEXT_COLOR_RED, TEXT_COLOR_DEFAULT);
-		pDebugConsole->Print(message.Str());
+		pDebugConsole->Print(pMessage);
 		pDebugConsole->SetColor(TEXT_COLOR_LIGHT_GRAY, TEXT_COLOR_DEFAULT);
 
-		//wprintf_s(message.Str());
+		//wprintf_s(pMessage);
 	}
 
 	void DebugLogger::Critical(const wchar_t* format, ...)
 	{
 		va_list args;
 		va_start(args, format);
-		StringW message = FormatTimeW() + L"[CRITICAL] " + FormatMessageW(format, args) + L"\n";
+		const wchar_t* pMessage = FormatLineW(L"[CRITICAL] ", format, args);
 		va_end(args);
 
 		pDebugConsole->SetColor(TEXT_COLOR_WHITE, TEXT_COLOR_RED);
-		pDebugConsole->Print(message.Str());
+		pDebugConsole->Print(pMessage);
 		pDebugConsole->SetColor(TEXT_COLOR_LIGHT_GRAY, TEXT_COLOR_DEFAULT);
 
-		//wprintf_s(message.Str());
+		//wprintf_s(pMessage);
 	}
 }
 
@@ -4,7 +4,7 @@
 
 namespace Quartz
 {
-	void UniformBlockData::AddFloat(const String& name, Float32 defaultValue)
+	void UniformBlockData::AddFloat(Name name, Float32 defaultValue)
 	{
 		UniformInfo uniformInfo;
 		uniformInfo.name = name;
@@ -17,7 +17,7 @@ namespace Quartz
 		mUniformTable.Put(name, uniformInfo);
 	}
 
-	void UniformBlockData::AddFloat2(const String& name, Vector2 defaultValue)
+	void UniformBlockData::AddFloat2(Name name, Vector2 defaultValue)
 	{
 		UniformInfo uniformInfo;
 		uniformInfo.name = name;
@@ -30,7 +30,7 @@ namespace Quartz
 		mUniformTable.Put(name, uniformInfo);
 	}
 
-	void UniformBlockData::AddFloat3(const String& name, Vector3 defaultValue)
+	void UniformBlockData::AddFloat3(Name name, Vector3 defaultValue)
 	{
 		UniformInfo uniformInfo;
 		uniformInfo.name = name;
@@ -43,7 +43,7 @@ namespace Quartz
 		mUniformTable.Put(name, uniformInfo);
 	}
 
-	void UniformBlockData::AddFloat4(const String& name, Vector4 defaultValue)
+	void UniformBlockData::AddFloat4(Name name, Vector4 defaultValue)
 	{
 		UniformInfo uniformInfo;
 		uniformInfo.name = name;
@@ -56,7 +56,7 @@ namespace Quartz
 		mUniformTable.Put(name, uniformInfo);
 	}
 
-	void UniformBlockData::AddMatrix4(const String& name, Matrix4 defaultValue)
+	void UniformBlockData::AddMatrix4(Name name, Matrix4 defaultValue)
 	{
 		UniformInfo uniformInfo;
 		uniformInfo.name = name;
@@ -69,7 +69,7 @@ namespace Quartz
 		mUniformTable.Put(name, uniformInfo);
 	}
 
-	void UniformBlockData::SetFloat(const String& name, Float32 value)
+	void UniformBlockData::SetFloat(Name name, Float32 value)
 	{
 		UniformInfo* pInfo = mUniformTable.Get(name);
 
@@ -82,7 +82,7 @@ namespace Quartz
 		mUniformBuffer.Get<Float32>(pInfo->index) = value;
 	}
 
-	void UniformBlockData::SetFloat2(const String& name, Vector2 value)
+	void UniformBlockData::SetFloat2(Name name, Vector2 value)
 	{
 		UniformInfo* pInfo = mUniformTable.Get(name);
 
@@ -95,7 +95,7 @@ namespace Quartz
 		mUniformBuffer.Get<Vector2>(pInfo->index) = value;
 	}
 
-	void UniformBlockData::SetFloat3(const String& name, Vector3 value)
+	void UniformBlockData::SetFloat3(Name name, Vector3 value)
 	{
 		UniformInfo* pInfo = mUniformTable.Get(name);
 
@@ -108,11 +108,11 @@ namespace Quartz
 		mUniformBuffer.Get<Vector3>(pInfo->index) = value;
 	}
 
-	void UniformBlockData::SetFloat4(const String& name, Vector4 value)
+	void UniformBlockData::SetFloat4(Name name, Vector4 value)
 	{
 		UniformInfo* pInfo = mUniformTable.Get(name);
 
-		if (pInfo == nullptr || pInfo->type != UNIFORM_TYPE_FLOAT3)
+		if (pInfo == nullptr || pInfo->type != UNIFORM_TYPE_FLOAT4)
 		{
 			// Do something?
 			return;
@@ -121,7 +121,7 @@ namespace Quartz
 		mUniformBuffer.Get<Vector4>(pInfo->index) = value;
 	}
 
-	void UniformBlockData::SetMatrix4(const String& name, Matrix4 value)
+	void UniformBlockData::SetMatrix4(Name name, Matrix4 value)
 	{
 		UniformInfo* pInfo = mUniformTable.Get(name);
 
@@ -1,7 +1,7 @@
 #pragma once
 
 #include "Common.h"
-#include "util\String.h"
+#include "util\Name.h"
 #include "util\Map.h"
 #include "util\Buffer.h"
 #include "math\Math.h"
@@ -25,26 +25,26 @@ namespace Quartz
 		struct UniformInfo
 		{
 			UInt32 index;
-			String name;
+			Name name;
 			UniformType type;
 			UInt32 sizeBytes;
 		};
 
-		Map<String, UniformInfo> mUniformTable;
+		Map<Name, UniformInfo> mUniformTable;
 		FloatBuffer mUniformBuffer;
 
 	public:
-		void AddFloat(const String& name, Float32 defaultValue = 0.0f);
-		void AddFloat2(const String& name, Vector2 defaultValue = {});
-		void AddFloat3(const String& name, Vector3 defaultValue = {});
-		void AddFloat4(const String& name, Vector4 defaultValue = {});
-		void AddMatrix4(const String& name, Matrix4 defaultValue = {});
+		void AddFloat(Name name, Float32 defaultValue = 0.0f);
+		void AddFloat2(Name name, Vector2 defaultValue = {});
+		void AddFloat3(Name name, Vector3 defaultValue = {});
+		void AddFloat4(Name name, Vector4 defaultValue = {});
+		void AddMatrix4(Name name, Matrix4 defaultValue = {});
 
-		void SetFloat(const String& name, Float32 value);
-		void SetFloat2(const String& name, Vector2 value);
-		void SetFloat3(const String& name, Vector3 value);
-		void SetFloat4(const String& name, Vector4 value);
-		void SetMatrix4(const String& name, Matrix4 value);
+		void SetFloat(Name name, Float32 value);
+		void SetFloat2(Name name, Vector2 value);
+		void SetFloat3(Name name, Vector3 value);
+		void SetFloat4(Name name, Vector4 value);
+		void SetMatrix4(Name name, Matrix4 value);
 
 		FloatBuffer& GetBuffer() { return mUniformBuffer; }
 	};
@@ -41,13 +41,12 @@ namespace Quartz
 		return 0;
 	}
 
-	String AssetManager::GetExtension(const String& path)
+	StringView AssetManager::GetExtension(StringView path)
 	{
 		StringParser parser(path);
 		parser.ReadToChar('.');
 		parser.AdvanceChar();
-		SubString extension = parser.ReadLine();
-		return String(extension);
+		return parser.ReadLine();
 	}
 
 	void AssetManager::MarkForUnload(AssetReference* pAssetReference)
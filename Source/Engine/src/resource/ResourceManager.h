@@ -3,6 +3,7 @@
 #include "Common.h"
 #include "util/Singleton.h"
 #include "util/String.h"
+#include "util/Name.h"
 #include "util/Map.h"
 #include "util/Stack.h"
 
@@ -81,11 +82,11 @@ namespace Quartz
 
 	private:
 		String mRoot;
-		Map<String, ExtLoaderBase*> mExtLoaders;
-		Map<String, AssetReference> mAssetReferences;
+		Map<Name, ExtLoaderBase*> mExtLoaders;
+		Map<Name, AssetReference> mAssetReferences;
 		Stack<AssetReference*> mMarkedForUnload;
 
-		String GetExtension(const String& path);
+		StringView GetExtension(StringView path);
 
 		void MarkForUnload(AssetReference* pAssetReference);
 
@@ -93,7 +94,7 @@ namespace Quartz
 		void SetAssetRoot(const String& root);
 
 		template<typename AssetType>
-		void RegisterAssetLoaders(const String& ext, LoadAssetFunc<AssetType> loadFunc, UnloadAssetFunc<AssetType> unloadFunc)
+		void RegisterAssetLoaders(Name ext, LoadAssetFunc<AssetType> loadFunc, UnloadAssetFunc<AssetType> unloadFunc)
 		{
 			ExtLoaderBase*& pLoaderBase = mExtLoaders[ext];
 
@@ -109,7 +110,7 @@ namespace Quartz
 		}
 
 		template<typename AssetType>
-		Asset<AssetType> GetAsset(const String& path)
+		Asset<AssetType> GetAsset(Name path)
 		{
 			AssetReference& reference = mAssetReferences[path];
 
@@ -119,14 +120,17 @@ namespace Quartz
 			}
 			else
 			{
-				String ext = GetExtension(path);
-				ExtLoader<AssetType>* pLoader = static_cast<ExtLoader<AssetType>*>(mExtLoaders[ext]);
+				// Extensions without loaders are never interned
+				StringView ext = GetExtension(path.View());
+				ExtLoaderBase** ppLoaderBase = mExtLoaders.Get(Name::Find(ext));
+				ExtLoader<AssetType>* pLoader = ppLoaderBase != nullptr ?
+					static_cast<ExtLoader<AssetType>*>(*ppLoaderBase) : nullptr;
 
 				if (pLoader != nullptr)
 				{
 					Log::General("Loading asset ['%s']", path.Str());
 
-					AssetType* pAsset = pLoader->Load(path);
+					AssetType* pAsset = pLoader->Load(String(path.View()));
 
 					reference.count = 0;
 					reference.pAsset = pAsset;
@@ -141,7 +145,7 @@ namespace Quartz
 				else
 				{
 					Log::Error("Error loading asset ['%s']: \
-						No loaders registered for extension '%s'!", path.Str(), ext.Str());
+						No loaders registered for extension '%.*s'!", path.Str(), (int)ext.Length(), ext.Str());
 				}
 
 				return Asset<AssetType>(nullptr);
@@ -67,10 +67,14 @@ namespace Quartz
 		}
 	}
 
-	void VulkanCommandBuffer::SetVertexBuffers(const Array<Buffer*>& buffers)
+	void VulkanCommandBuffer::SetVertexBuffers(const InlineArray<Buffer*, 4>& buffers)
 	{
 		VulkanCommandSetVertexBuffers* pCommand = new VulkanCommandSetVertexBuffers();
-		pCommand->buffers = reinterpret_cast<const Array<VulkanBuffer*>&>(buffers); // @NOTE: possibly dangerous conversion?
+
+		for (Buffer* pBuffer : buffers)
+		{
+			pCommand->buffers.PushBack(static_cast<VulkanBuffer*>(pBuffer));
+		}
 
 		mCommandList.PushBack(pCommand);
 	}
@@ -262,12 +266,12 @@ namespace Quartz
 				{
 					VulkanCommandSetVertexBuffers* pSetVertexBuffers = static_cast<VulkanCommandSetVertexBuffers*>(pCommand);
 
-					Array<VkBuffer>		vkBuffers(pSetVertexBuffers->buffers.Size());
-					Array<VkDeviceSize> vkOffsetSizes(pSetVertexBuffers->buffers.Size());
+					InlineArray<VkBuffer, 4>		vkBuffers(pSetVertexBuffers->buffers.Size());
+					InlineArray<VkDeviceSize, 4>	vkOffsetSizes(pSetVertexBuffers->buffers.Size());
 
 					for (UInt32 i = 0; i < pSetVertexBuffers->buffers.Size(); i++)
 					{
-						vkBuffers[i]		= static_cast<VulkanBuffer*>(pSetVertexBuffers->buffers[i])->GetVkBuffer();
+						vkBuffers[i]		= pSetVertexBuffers->buffers[i]->GetVkBuffer();
 						vkOffsetSizes[i]	= 0;
 					}
 
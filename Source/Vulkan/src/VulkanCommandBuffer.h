@@ -75,7 +75,7 @@ namespace Quartz
 		struct VulkanCommandSetVertexBuffers 
 			: public VulkanCommandBase<VULKAN_COMMAND_SET_VERTEX_BUFFERS>
 		{
-			Array<VulkanBuffer*> buffers;
+			InlineArray<VulkanBuffer*, 4> buffers;
 		};
 
 		struct VulkanCommandSetIndexBuffer 
@@ -151,7 +151,7 @@ namespace Quartz
 
 		void SetPipeline(Pipeline* pPipeline) override;
 
-		void SetVertexBuffers(const Array<Buffer*>& buffers) override;
+		void SetVertexBuffers(const InlineArray<Buffer*, 4>& buffers) override;
 		void SetIndexBuffer(Buffer* pBuffer) override;
 
 		void BindUniform(UInt32 set, UInt32 binding, Uniform* pUniform, UInt32 element) override;